@@ -0,0 +1,521 @@
+/**
+ * @file bench/bench_common.h
+ * Copyright 2025, aplcexenicesetrl project
+ * MIT License
+ *
+ * Shared harness for the cnt benchmarks: command line options, timing loops,
+ * latency percentiles, dataset generators and the JSON result file.
+ *
+ * Every benchmark executable accepts
+ *   --quick          small datasets and few repetitions (smoke run)
+ *   --json <file>    write machine-readable results to <file>
+ *   --filter <text>  only run cases whose name contains <text>
+ *   --seed <n>       seed for the dataset generators (default 42)
+ *
+ * JSON layout (one document per executable):
+ *   { "suite": "config", "timestamp": ..., "environment": {...},
+ *     "results": [ { "name": "lookup.hit", "params": {...}, "iterations": n,
+ *                    "ns_per_op": x, "ops_per_sec": x, "bytes_per_sec": x,
+ *                    "p50_ns": x, "p90_ns": x, "p99_ns": x, "max_ns": x,
+ *                    "metrics": {...} }, ... ] }
+ * Fields that do not apply to a case are omitted.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cnt/instrument.h>
+#include <cnt/simd.h>
+
+namespace cnt_bench
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        bool quick = false;
+        std::string jsonPath;
+        std::string filter;
+        uint64_t seed = 42;
+    };
+
+    inline Options parseOptions(int argc, char** argv)
+    {
+        Options options;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--quick") options.quick = true;
+            else if (arg == "--json") options.jsonPath = value();
+            else if (arg == "--filter") options.filter = value();
+            else if (arg == "--seed") options.seed = std::strtoull(value().c_str(), nullptr, 10);
+            else throw std::invalid_argument("unknown option: " + arg);
+        }
+        return options;
+    }
+
+    // Keeps the optimizer from discarding a computed value.
+    template <typename T>
+    inline void doNotOptimize(const T& value)
+    {
+#if defined(__GNUC__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const T* sink;
+        sink = &value;
+#endif
+    }
+
+    // ------------------------------------------------------------------
+    // Dataset generators
+    // ------------------------------------------------------------------
+
+    // splitmix64: fast, seedable and identical on every platform.
+    class Rng
+    {
+    public:
+        explicit Rng(uint64_t seed) : state_(seed) {}
+
+        uint64_t next()
+        {
+            uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        uint64_t below(uint64_t n) { return n ? next() % n : 0; }
+
+    private:
+        uint64_t state_;
+    };
+
+    inline std::vector<uint8_t> randomPayload(size_t size, uint64_t seed)
+    {
+        Rng rng(seed);
+        std::vector<uint8_t> data(size);
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t v = rng.next();
+            std::memcpy(&data[i], &v, 8);
+        }
+        for (uint64_t v = rng.next(); i < size; ++i, v >>= 8) data[i] = static_cast<uint8_t>(v);
+        return data;
+    }
+
+    inline std::string randomWord(Rng& rng, size_t length)
+    {
+        static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+        std::string word(length, 'a');
+        for (auto& c : word) c = alphabet[rng.below(sizeof(alphabet) - 1)];
+        return word;
+    }
+
+    // Hierarchical key names such as "net.http3.timeout_17"; index i always yields the same key.
+    inline std::string configKey(size_t i)
+    {
+        static const char* sections[] = {"app", "net", "db", "ui", "log", "cache", "auth", "io"};
+        return std::string(sections[i % 8]) + ".group" + std::to_string((i / 8) % 64) + ".key_" + std::to_string(i);
+    }
+
+    inline std::vector<std::pair<std::string, std::string>> configEntries(size_t keys, size_t valueSize, uint64_t seed)
+    {
+        Rng rng(seed);
+        std::vector<std::pair<std::string, std::string>> entries;
+        entries.reserve(keys);
+        for (size_t i = 0; i < keys; ++i) entries.emplace_back(configKey(i), randomWord(rng, valueSize));
+        return entries;
+    }
+
+    // Writes an N-key .cntconfig text file.
+    inline void writeConfigFile(const std::string& path, size_t keys, size_t valueSize, uint64_t seed)
+    {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) throw std::runtime_error("cannot write " + path);
+        out << "# generated by cnt bench: " << keys << " keys\n";
+        for (const auto& entry : configEntries(keys, valueSize, seed)) out << entry.first << " = " << entry.second << "\n";
+    }
+
+    inline void writePayloadFile(const std::string& path, size_t size, uint64_t seed)
+    {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) throw std::runtime_error("cannot write " + path);
+        auto data = randomPayload(size, seed);
+        out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    // Private scratch directory, removed when the suite finishes.
+    class TempDir
+    {
+    public:
+        explicit TempDir(const std::string& tag)
+        {
+            path_ = std::filesystem::temp_directory_path() /
+                    ("cnt_bench_" + tag + "_" + std::to_string(Clock::now().time_since_epoch().count()));
+            std::filesystem::create_directories(path_);
+        }
+
+        ~TempDir()
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(path_, ec);
+        }
+
+        std::string file(const std::string& name) const { return (path_ / name).string(); }
+
+    private:
+        std::filesystem::path path_;
+    };
+
+    // Resident memory from /proc/self/status (Linux); 0 where unavailable.
+    inline uint64_t procStatusBytes(const char* field)
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        const size_t length = std::strlen(field);
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, length, field) == 0 && line.size() > length && line[length] == ':')
+            {
+                return std::strtoull(line.c_str() + length + 1, nullptr, 10) * 1024;
+            }
+        }
+        return 0;
+    }
+
+    // A field of /proc/self/smaps_rollup (e.g. "Private_Dirty") in bytes, 0 where unavailable.
+    inline uint64_t procSmapsBytes(const char* field)
+    {
+        std::ifstream rollup("/proc/self/smaps_rollup");
+        std::string line;
+        const size_t length = std::strlen(field);
+        while (std::getline(rollup, line))
+        {
+            if (line.compare(0, length, field) == 0 && line.size() > length && line[length] == ':')
+            {
+                return std::strtoull(line.c_str() + length + 1, nullptr, 10) * 1024;
+            }
+        }
+        return 0;
+    }
+
+    // Minor page faults taken by the process so far (/proc/self/stat), 0 where unavailable.
+    inline uint64_t minorPageFaults()
+    {
+        std::ifstream stat("/proc/self/stat");
+        std::string line;
+        if (!std::getline(stat, line)) return 0;
+        const size_t comm = line.rfind(')');
+        if (comm == std::string::npos) return 0;
+        const char* p = line.c_str() + comm + 1;
+        // state ppid pgrp session tty_nr tpgid flags minflt
+        for (int field = 0; field < 7 && p; ++field) p = std::strchr(p + 1, ' ');
+        return p ? std::strtoull(p, nullptr, 10) : 0;
+    }
+
+    // How far fn() pushes the peak RSS above the current RSS. The kernel's
+    // high-water mark is reset first (clear_refs 5), so earlier cases do not mask it.
+    template <typename Fn>
+    inline uint64_t peakRssGrowth(Fn&& fn)
+    {
+        {
+            std::ofstream clear("/proc/self/clear_refs");
+            if (clear) clear << "5";
+        }
+        const uint64_t before = procStatusBytes("VmRSS");
+        fn();
+        const uint64_t peak = procStatusBytes("VmHWM");
+        return peak > before ? peak - before : 0;
+    }
+
+    // ------------------------------------------------------------------
+    // Measurement
+    // ------------------------------------------------------------------
+
+    struct Result
+    {
+        std::string name;
+        std::vector<std::pair<std::string, std::string>> params;   // values are JSON literals
+        uint64_t iterations = 0;
+        double nsPerOp = 0;
+        double bytesPerOp = 0;
+        bool hasLatency = false;
+        double p50 = 0, p90 = 0, p99 = 0, max = 0;
+        std::vector<std::pair<std::string, double>> metrics;
+
+        Result& param(const std::string& key, uint64_t value)
+        {
+            params.emplace_back(key, std::to_string(value));
+            return *this;
+        }
+
+        Result& param(const std::string& key, const std::string& value)
+        {
+            params.emplace_back(key, "\"" + value + "\"");
+            return *this;
+        }
+
+        Result& metric(const std::string& key, double value)
+        {
+            metrics.emplace_back(key, value);
+            return *this;
+        }
+    };
+
+    inline double percentile(std::vector<double>& sorted, double q)
+    {
+        if (sorted.empty()) return 0;
+        size_t index = static_cast<size_t>(q * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    class Suite
+    {
+    public:
+        Suite(const std::string& name, const Options& options) : name_(name), options_(options) {}
+
+        const Options& options() const { return options_; }
+        bool quick() const { return options_.quick; }
+        bool enabled(const std::string& caseName) const
+        {
+            return options_.filter.empty() || caseName.find(options_.filter) != std::string::npos;
+        }
+
+        /*
+         * Throughput: fn() performs `opsPerRun` operations. It is repeated until
+         * `minTime` has elapsed (at least three times) and the fastest run is
+         * reported, which filters out scheduler noise. Filtered-out cases are not
+         * run and return a result that is discarded.
+         */
+        Result& throughput(const std::string& caseName, uint64_t opsPerRun, double bytesPerOp,
+                           const std::function<void()>& fn)
+        {
+            printPending();
+            if (!enabled(caseName)) return skipped_ = Result();
+            const auto minTime = std::chrono::milliseconds(options_.quick ? 20 : 300);
+            fn();   // warm-up
+            double best = 1e300;
+            uint64_t runs = 0;
+            const auto start = Clock::now();
+            do
+            {
+                const auto t0 = Clock::now();
+                fn();
+                const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+                best = std::min(best, ns);
+                ++runs;
+            } while (runs < 3 || Clock::now() - start < minTime);
+
+            Result result;
+            result.name = caseName;
+            result.iterations = runs * opsPerRun;
+            result.nsPerOp = best / static_cast<double>(opsPerRun);
+            result.bytesPerOp = bytesPerOp;
+            return add(std::move(result));
+        }
+
+        // Latency: times each of `samples` calls to fn(i) individually.
+        Result& latency(const std::string& caseName, size_t samples, const std::function<void(size_t)>& fn,
+                        double bytesPerOp = 0)
+        {
+            printPending();
+            if (!enabled(caseName)) return skipped_ = Result();
+            std::vector<double> ns(samples);
+            const auto start = Clock::now();
+            for (size_t i = 0; i < samples; ++i)
+            {
+                const auto t0 = Clock::now();
+                fn(i);
+                ns[i] = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+            }
+            const double total = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            std::sort(ns.begin(), ns.end());
+
+            Result result;
+            result.name = caseName;
+            result.iterations = samples;
+            result.nsPerOp = samples ? total / static_cast<double>(samples) : 0;
+            result.bytesPerOp = bytesPerOp;
+            result.hasLatency = true;
+            result.p50 = percentile(ns, 0.50);
+            result.p90 = percentile(ns, 0.90);
+            result.p99 = percentile(ns, 0.99);
+            result.max = ns.empty() ? 0 : ns.back();
+            return add(std::move(result));
+        }
+
+        // The returned result may still receive params and metrics; it is printed
+        // when the next case starts or the suite finishes.
+        Result& add(Result result)
+        {
+            printPending();
+            results_.push_back(std::move(result));
+            return results_.back();
+        }
+
+        // Prints the footer and writes the JSON file; returns the process exit code.
+        int finish()
+        {
+            printPending();
+            if (cnt::instrument::snapshot().enabled)
+            {
+                std::printf("\ninstrumentation:\n%s", cnt::instrument::snapshot().toText().c_str());
+            }
+            if (options_.jsonPath.empty()) return 0;
+            std::ofstream out(options_.jsonPath, std::ios::binary);
+            if (!out)
+            {
+                std::fprintf(stderr, "cannot write %s\n", options_.jsonPath.c_str());
+                return 1;
+            }
+            out << toJson() << "\n";
+            std::printf("results written to %s\n", options_.jsonPath.c_str());
+            return 0;
+        }
+
+        std::string toJson() const
+        {
+            std::string out = "{\"suite\":\"" + name_ + "\",\"timestamp\":" + std::to_string(std::time(nullptr));
+            out += ",\"environment\":{\"compiler\":\"" + escape(compiler()) + "\"";
+            out += ",\"optimized\":";
+#if defined(NDEBUG)
+            out += "true";
+#else
+            out += "false";
+#endif
+            out += ",\"simd\":\"" + std::string(cnt::simd::level_name(cnt::simd::detected_level())) + "\"";
+            out += ",\"instrumentation\":";
+            out += cnt::instrument::snapshot().enabled ? "true" : "false";
+            out += ",\"quick\":";
+            out += options_.quick ? "true" : "false";
+            out += ",\"seed\":" + std::to_string(options_.seed) + "},\"results\":[";
+            for (size_t i = 0; i < results_.size(); ++i)
+            {
+                const Result& r = results_[i];
+                if (i) out += ',';
+                out += "{\"name\":\"" + escape(r.name) + "\",\"params\":{";
+                for (size_t p = 0; p < r.params.size(); ++p)
+                {
+                    if (p) out += ',';
+                    out += "\"" + escape(r.params[p].first) + "\":" + r.params[p].second;
+                }
+                out += "},\"iterations\":" + std::to_string(r.iterations);
+                out += ",\"ns_per_op\":" + number(r.nsPerOp);
+                out += ",\"ops_per_sec\":" + number(r.nsPerOp > 0 ? 1e9 / r.nsPerOp : 0);
+                if (r.bytesPerOp > 0) out += ",\"bytes_per_sec\":" + number(r.bytesPerOp * 1e9 / r.nsPerOp);
+                if (r.hasLatency)
+                {
+                    out += ",\"p50_ns\":" + number(r.p50) + ",\"p90_ns\":" + number(r.p90) +
+                           ",\"p99_ns\":" + number(r.p99) + ",\"max_ns\":" + number(r.max);
+                }
+                if (!r.metrics.empty())
+                {
+                    out += ",\"metrics\":{";
+                    for (size_t m = 0; m < r.metrics.size(); ++m)
+                    {
+                        if (m) out += ',';
+                        out += "\"" + escape(r.metrics[m].first) + "\":" + number(r.metrics[m].second);
+                    }
+                    out += '}';
+                }
+                out += '}';
+            }
+            out += "]}";
+            return out;
+        }
+
+    private:
+        static std::string compiler()
+        {
+#if defined(__clang__)
+            return "clang " __clang_version__;
+#elif defined(__GNUC__)
+            return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+            return "msvc " + std::to_string(_MSC_VER);
+#else
+            return "unknown";
+#endif
+        }
+
+        static std::string escape(const std::string& s)
+        {
+            std::string out;
+            for (char c : s)
+            {
+                if (c == '"' || c == '\\') out += '\\';
+                if (static_cast<unsigned char>(c) < 0x20) continue;
+                out += c;
+            }
+            return out;
+        }
+
+        static std::string number(double v)
+        {
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), "%.6g", v);
+            return buffer;
+        }
+
+        void printPending()
+        {
+            for (; printed_ < results_.size(); ++printed_) print(results_[printed_]);
+        }
+
+        void print(const Result& r) const
+        {
+            std::string label = r.name;
+            for (const auto& p : r.params) label += " " + p.first + "=" + p.second;
+            std::printf("%-52s %12.2f ns/op", label.c_str(), r.nsPerOp);
+            if (r.bytesPerOp > 0) std::printf(" %10.3f GB/s", r.bytesPerOp / r.nsPerOp);
+            if (r.hasLatency) std::printf("  p50=%.0f p99=%.0f max=%.0f", r.p50, r.p99, r.max);
+            for (const auto& m : r.metrics) std::printf("  %s=%g", m.first.c_str(), m.second);
+            std::printf("\n");
+            std::fflush(stdout);
+        }
+
+        std::string name_;
+        Options options_;
+        std::deque<Result> results_;
+        size_t printed_ = 0;
+        Result skipped_;   // target for filtered-out cases
+    };
+
+    // Wraps main() so that option errors and exceptions become a non-zero exit.
+    inline int runMain(int argc, char** argv, const char* suite, const std::function<void(Suite&)>& body)
+    {
+        try
+        {
+            Suite s(suite, parseOptions(argc, argv));
+            std::printf("== %s%s\n", suite, s.quick() ? " (quick)" : "");
+            body(s);
+            return s.finish();
+        }
+        catch (const std::exception& e)
+        {
+            std::fprintf(stderr, "%s: %s\n", suite, e.what());
+            return 1;
+        }
+    }
+} // namespace cnt_bench
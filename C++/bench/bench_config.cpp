@@ -0,0 +1,455 @@
+/**
+ * @file bench/bench_config.cpp
+ * Copyright 2025, aplcexenicesetrl project
+ * MIT License
+ *
+ * cnt::ConfigManager: text/binary load and save (peak RSS growth in bytes,
+ * the cost of fsync, loading the original unchecked binary format), lookups by name (hit and miss, directly and through a
+ * LayeredConfig of 1-8 layers, and through a compile-time schema against
+ * the same names as strings), prefix queries against
+ * a linear scan, lookups by value with and without the reverse index,
+ * inserts and removals, syncing a full set of changes through a batch (one
+ * journal record) against one call per change, persisting small updates by full rewrite
+ * against the append-only journal, and pre-forked workers each parsing the
+ * file against attaching to one shared-memory snapshot (time to ready and
+ * private RSS per worker), over generated N-key configurations.
+ */
+
+#include "bench_common.h"
+
+#include <cnt/config.h>
+#include <cnt/configlayers.h>
+#include <cnt/configschema.h>
+#if !defined(_WIN32)
+#include <cnt/configshm.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace cnt_bench;
+
+namespace
+{
+    // The first eight generated names (see configKey()).
+    struct Keys
+    {
+        CNT_CONFIG_KEY(K0, "app.group0.key_0", std::string, "");
+        CNT_CONFIG_KEY(K1, "net.group0.key_1", std::string, "");
+        CNT_CONFIG_KEY(K2, "db.group0.key_2", std::string, "");
+        CNT_CONFIG_KEY(K3, "ui.group0.key_3", std::string, "");
+        CNT_CONFIG_KEY(K4, "log.group0.key_4", std::string, "");
+        CNT_CONFIG_KEY(K5, "cache.group0.key_5", std::string, "");
+        CNT_CONFIG_KEY(K6, "auth.group0.key_6", std::string, "");
+        CNT_CONFIG_KEY(K7, "io.group0.key_7", std::string, "");
+    };
+    using BenchSchema = cnt::ConfigSchema<Keys::K0, Keys::K1, Keys::K2, Keys::K3, Keys::K4, Keys::K5, Keys::K6, Keys::K7>;
+
+    // Writes cm the way saveBinary() did before the checksummed format: the
+    // bare records ([u32 length][name][u32 length][value]) XOR 0xBB.
+    void writeLegacyBinary(const std::string& path, const cnt::ConfigManager& cm)
+    {
+        std::string image;
+        const auto put = [&](const std::string& field) {
+            const uint32_t length = static_cast<uint32_t>(field.size());
+            image.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            image += field;
+        };
+        for (const auto& obj : cm)
+        {
+            put(obj.name);
+            put(obj.value);
+        }
+        for (auto& c : image) c = static_cast<char>(c ^ 0xBB);
+        std::ofstream(path, std::ios::binary).write(image.data(), static_cast<std::streamsize>(image.size()));
+    }
+
+#if !defined(_WIN32)
+    // Forks `workers` processes that each run ready() and report the private
+    // memory it dirtied (pages shared copy-on-write with the parent do not
+    // count); returns the average. ready() returning false in any worker
+    // fails the case.
+    double forkWorkers(size_t workers, const std::function<bool()>& ready)
+    {
+        int fds[2];
+        if (::pipe(fds) != 0) throw std::runtime_error("pipe() failed");
+        std::vector<pid_t> children;
+        for (size_t w = 0; w < workers; ++w)
+        {
+            pid_t pid = ::fork();
+            if (pid < 0) throw std::runtime_error("fork() failed");
+            if (pid == 0)
+            {
+                ::close(fds[0]);
+                const uint64_t before = procSmapsBytes("Private_Dirty");
+                bool ok = false;
+                try
+                {
+                    ok = ready();
+                }
+                catch (const std::exception&)
+                {
+                }
+                const uint64_t after = procSmapsBytes("Private_Dirty");
+                const uint64_t growth = ok ? (after > before ? after - before : 0) : UINT64_MAX;
+                _exit(::write(fds[1], &growth, sizeof(growth)) == sizeof(growth) ? 0 : 1);
+            }
+            children.push_back(pid);
+        }
+        ::close(fds[1]);
+        uint64_t total = 0, growth = 0;
+        bool failed = false;
+        while (::read(fds[0], &growth, sizeof(growth)) == sizeof(growth))
+        {
+            failed |= growth == UINT64_MAX;
+            total += growth;
+        }
+        ::close(fds[0]);
+        for (pid_t pid : children)
+        {
+            int status = 0;
+            ::waitpid(pid, &status, 0);
+            failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+        }
+        if (failed) throw std::runtime_error("a config worker failed");
+        return static_cast<double>(total) / static_cast<double>(workers);
+    }
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    return runMain(argc, argv, "config", [](Suite& s) {
+        TempDir dir("config");
+        const std::vector<size_t> sizes = s.quick() ? std::vector<size_t>{1000} : std::vector<size_t>{1000, 10000, 100000};
+        const size_t valueSize = 24;
+
+        for (size_t keys : sizes)
+        {
+            const std::string text = dir.file("bench_" + std::to_string(keys) + ".cntconfig");
+            const std::string binary = dir.file("bench_" + std::to_string(keys) + ".cntconfigbin");
+            writeConfigFile(text, keys, valueSize, s.options().seed);
+            const double fileBytes = static_cast<double>(std::filesystem::file_size(text));
+
+            s.throughput("load.text", 1, fileBytes, [&] {
+                cnt::ConfigManager cm;
+                cm.loadText(text);
+                doNotOptimize(cm.size());
+            }).param("keys", keys);
+
+            cnt::ConfigManager cm;
+            cm.loadText(text);
+
+            // Saves stream through a fixed buffer into a temp file that is renamed
+            // into place; peak_rss_growth shows the buffer, not a copy of the image.
+            cnt::SaveOptions synced;
+            synced.sync = true;
+            cnt::SaveOptions inPlace;
+            inPlace.atomic = false;
+            s.throughput("save.text", 1, fileBytes, [&] { cm.saveText(text); })
+                .param("keys", keys)
+                .metric("peak_rss_growth", static_cast<double>(peakRssGrowth([&] { cm.saveText(text); })));
+            s.throughput("save.text", 1, fileBytes, [&] { cm.saveText(text, synced); })
+                .param("keys", keys).param("mode", "fsync");
+            s.throughput("save.binary", 1, fileBytes, [&] { cm.saveBinary(binary); })
+                .param("keys", keys)
+                .metric("peak_rss_growth", static_cast<double>(peakRssGrowth([&] { cm.saveBinary(binary); })));
+            s.throughput("save.binary", 1, fileBytes, [&] { cm.saveBinary(binary, synced); })
+                .param("keys", keys).param("mode", "fsync");
+            s.throughput("save.binary", 1, fileBytes, [&] { cm.saveBinary(binary, inPlace); })
+                .param("keys", keys).param("mode", "inplace");
+            s.throughput("load.binary", 1, fileBytes, [&] {
+                cnt::ConfigManager loaded;
+                loaded.loadBinary(binary);
+                doNotOptimize(loaded.size());
+            }).param("keys", keys);
+
+            // Files saved before the checksummed format must still load.
+            const std::string legacy = dir.file("legacy_" + std::to_string(keys) + ".cntconfigbin");
+            writeLegacyBinary(legacy, cm);
+            s.throughput("load.binary", 1, fileBytes, [&] {
+                cnt::ConfigManager loaded;
+                loaded.loadBinary(legacy);
+                doNotOptimize(loaded.size());
+            }).param("keys", keys).param("format", "legacy");
+            {
+                cnt::ConfigManager loaded;
+                if (!loaded.loadBinary(legacy) || loaded.size() != cm.size())
+                {
+                    throw std::runtime_error("a config saved in the original binary format did not load");
+                }
+                for (const auto& obj : cm)
+                {
+                    if (loaded.getValue(obj.name) != obj.value) throw std::runtime_error("a legacy binary config loaded different values");
+                }
+            }
+
+            // Lookups: a fixed random sample of existing names, and names that are absent.
+            const size_t lookups = s.quick() ? 1000 : std::max<size_t>(1000, 2000000 / keys);
+            Rng rng(s.options().seed);
+            std::vector<std::string> hits, misses;
+            for (size_t i = 0; i < lookups; ++i)
+            {
+                hits.push_back(configKey(rng.below(keys)));
+                misses.push_back(configKey(keys + rng.below(keys)));
+            }
+            const cnt::ConfigManager& view = cm;
+
+            s.throughput("lookup.hit", lookups, 0, [&] {
+                for (const auto& name : hits) doNotOptimize(view[name].size());
+            }).param("keys", keys);
+            s.throughput("lookup.getValue", lookups, 0, [&] {
+                for (const auto& name : hits) doNotOptimize(cm.getValue(name).size());
+            }).param("keys", keys);
+            // The same lookups through an overlay: all names in the bottom layer,
+            // empty layers above it and a top layer shadowing a quarter of the
+            // names. The cost should not grow with the depth.
+            for (size_t depth : {1, 4, 8})
+            {
+                cnt::LayeredConfig layered;
+                layered.addLayer("defaults", std::make_shared<cnt::ConfigManager>(cm));
+                for (size_t l = 2; l < depth; ++l) layered.addLayer("empty" + std::to_string(l), std::make_shared<cnt::ConfigManager>());
+                if (depth > 1)
+                {
+                    auto top = std::make_shared<cnt::ConfigManager>();
+                    for (size_t i = 0; i < keys; i += 4) top->add(configKey(i), "override");
+                    layered.addLayer("top", top);
+                }
+                for (const auto& name : hits) doNotOptimize(layered.find(name));   // warm the resolution cache
+                s.throughput("layers.lookup", lookups, 0, [&] {
+                    for (const auto& name : hits) doNotOptimize(layered[name].size());
+                }).param("keys", keys).param("layers", depth);
+            }
+            // Eight known names: typed slots against string lookups of the
+            // same names, and the cost of classifying every entry on refresh.
+            {
+                cnt::SchemaConfig<BenchSchema> schema(std::make_shared<cnt::ConfigManager>(cm));
+                const size_t rounds = lookups / 8;
+                s.throughput("schema.get", rounds * 8, 0, [&] {
+                    for (size_t r = 0; r < rounds; ++r)
+                    {
+                        doNotOptimize(schema.get<Keys::K0>().size() + schema.get<Keys::K1>().size() +
+                                      schema.get<Keys::K2>().size() + schema.get<Keys::K3>().size() +
+                                      schema.get<Keys::K4>().size() + schema.get<Keys::K5>().size() +
+                                      schema.get<Keys::K6>().size() + schema.get<Keys::K7>().size());
+                    }
+                }).param("keys", keys);
+                std::vector<std::string> known;
+                for (size_t i = 0; i < 8; ++i) known.push_back(configKey(i));
+                s.throughput("schema.byName", rounds * 8, 0, [&] {
+                    for (size_t r = 0; r < rounds; ++r)
+                    {
+                        size_t n = 0;
+                        for (const auto& name : known) n += view[name].size();
+                        doNotOptimize(n);
+                    }
+                }).param("keys", keys);
+                s.throughput("schema.refresh", keys, 0, [&] { schema.refresh(); }).param("keys", keys);
+            }
+            s.throughput("lookup.miss", lookups, 0, [&] {
+                for (const auto& name : misses) doNotOptimize(cm.contains(name));
+            }).param("keys", keys);
+            s.latency("lookup.hit.latency", lookups, [&](size_t i) { doNotOptimize(view[hits[i]].size()); })
+                .param("keys", keys);
+
+            // Prefix queries: a narrow namespace ("db.group3", ~1/512 of the keys) and a
+            // wide one ("db", 1/8), through the sorted index and by hand over all entries.
+            for (const std::string prefix : {"db.group3", "db"})
+            {
+                const std::string dotted = prefix + ".";
+                s.throughput("subtree.index", 1, 0, [&] {
+                    size_t n = 0;
+                    for (const auto& obj : view.subtree(prefix)) n += obj.value.size();
+                    doNotOptimize(n);
+                }).param("keys", keys).param("prefix", prefix);
+                s.throughput("subtree.linear", 1, 0, [&] {
+                    size_t n = 0;
+                    for (const auto& obj : view)
+                    {
+                        if (obj.name.compare(0, dotted.size(), dotted) == 0) n += obj.value.size();
+                    }
+                    doNotOptimize(n);
+                }).param("keys", keys).param("prefix", prefix);
+            }
+            s.throughput("subtree.firstAfterLoad", 1, 0, [&] {
+                cnt::ConfigManager fresh;
+                fresh.loadText(text);
+                doNotOptimize(fresh.subtree("db.group3").size());
+            }).param("keys", keys);
+
+            const auto entries = configEntries(keys, valueSize, s.options().seed);
+            const size_t reverse = std::min<size_t>(lookups, 1000);
+            s.throughput("lookup.byValue", reverse, 0, [&] {
+                for (size_t i = 0; i < reverse; ++i) doNotOptimize(cm.getName(entries[(i * 7919) % keys].second).size());
+            }).param("keys", keys).param("index", "none");
+            cnt::ConfigManager indexed = cm;
+            indexed.enableValueIndex();
+            s.throughput("lookup.byValue", reverse, 0, [&] {
+                for (size_t i = 0; i < reverse; ++i) doNotOptimize(indexed.getName(entries[(i * 7919) % keys].second).size());
+            }).param("keys", keys).param("index", "value");
+
+            // Removing every key in random order, including building the manager
+            // (compare with "insert" for the removal share).
+            std::vector<size_t> order(keys);
+            for (size_t i = 0; i < keys; ++i) order[i] = i;
+            for (size_t i = keys; i > 1; --i) std::swap(order[i - 1], order[rng.below(i)]);
+            s.throughput("remove.byName", keys, 0, [&] {
+                cnt::ConfigManager fresh;
+                for (const auto& entry : entries) fresh.add(entry.first, entry.second);
+                for (size_t i : order) fresh.removeByName(entries[i].first);
+                doNotOptimize(fresh.size());
+            }).param("keys", keys);
+            s.throughput("remove.byValue", keys, 0, [&] {
+                cnt::ConfigManager fresh;
+                fresh.enableValueIndex();
+                for (const auto& entry : entries) fresh.add(entry.first, entry.second);
+                for (size_t i : order) fresh.removeByValue(entries[i].second);
+                doNotOptimize(fresh.size());
+            }).param("keys", keys).param("index", "value");
+
+            // Syncing one change per key (80% updated, 10% removed, 10% new)
+            // onto a copy of the configuration: one batch against one call each.
+            // The batch must leave the same entries as the calls in order.
+            {
+                std::vector<std::pair<std::string, std::string>> changes(keys);
+                for (size_t i = 0; i < keys; ++i)
+                {
+                    const size_t pick = rng.below(10);
+                    if (pick == 0) changes[i] = {entries[i].first, std::string()};
+                    else if (pick == 1) changes[i] = {"new." + entries[i].first, "added"};
+                    else changes[i] = {entries[i].first, "synced"};
+                }
+                size_t changeBytes = 0;
+                for (const auto& change : changes) changeBytes += change.first.size() + change.second.size();
+                const auto syncBatch = [&](cnt::ConfigManager& target) {
+                    cnt::ConfigBatch batch = target.batch();
+                    batch.reserve(changes.size(), changeBytes);
+                    for (const auto& change : changes)
+                    {
+                        if (change.second.empty()) batch.remove(change.first);
+                        else batch.set(change.first, change.second);
+                    }
+                    batch.commit();
+                };
+                const auto syncPerCall = [&](cnt::ConfigManager& target) {
+                    for (const auto& change : changes)
+                    {
+                        if (change.second.empty()) target.removeByName(change.first);
+                        else target.set(change.first, change.second);
+                    }
+                };
+                cnt::ConfigManager batched;
+                cnt::ConfigManager perCall;
+                s.throughput("sync.batch", keys, 0, [&] {
+                    batched = cm;
+                    syncBatch(batched);
+                    doNotOptimize(batched.size());
+                }).param("keys", keys);
+                s.throughput("sync.perCall", keys, 0, [&] {
+                    perCall = cm;
+                    syncPerCall(perCall);
+                    doNotOptimize(perCall.size());
+                }).param("keys", keys);
+
+                // In journal mode, from a fresh snapshot each time: one record
+                // for the batch against one per call.
+                const std::string journaled = dir.file("sync_" + std::to_string(keys) + ".cntconfigbin");
+                const auto syncJournaled = [&](const std::function<void(cnt::ConfigManager&)>& sync) {
+                    std::filesystem::remove(journaled + ".journal");
+                    cm.saveBinary(journaled);
+                    cnt::ConfigManager live;
+                    live.openJournal(journaled);
+                    sync(live);
+                    live.closeJournal();
+                };
+                s.throughput("sync.batch", keys, 0, [&] { syncJournaled(syncBatch); })
+                    .param("keys", keys).param("mode", "journal");
+                s.throughput("sync.perCall", keys, 0, [&] { syncJournaled(syncPerCall); })
+                    .param("keys", keys).param("mode", "journal");
+                const cnt::ConfigManager& lhs = batched;
+                const cnt::ConfigManager& rhs = perCall;
+                if (lhs.size() != 0 && rhs.size() != 0 && !std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()))
+                {
+                    throw std::runtime_error("batched and per-call sync disagree");
+                }
+            }
+
+            // Changing a few keys and persisting: a full rewrite against one
+            // journal append per change.
+            const size_t updates = s.quick() ? 100 : 1000;
+            s.throughput("update.saveBinary", updates, 0, [&] {
+                for (size_t i = 0; i < updates; ++i)
+                {
+                    cm.set(entries[(i * 7919) % keys].first, "changed");
+                    cm.saveBinary(binary);
+                }
+            }).param("keys", keys);
+            {
+                const std::string journaled = dir.file("journal_" + std::to_string(keys) + ".cntconfigbin");
+                cm.saveBinary(journaled);
+                cnt::ConfigManager live;
+                live.openJournal(journaled);
+                s.throughput("update.journal", updates, 0, [&] {
+                    for (size_t i = 0; i < updates; ++i) live.set(entries[(i * 7919) % keys].first, "changed");
+                }).param("keys", keys);
+                // One manager per journal: a fold still running in `live` would
+                // race the reopened manager's own fold for the snapshot.
+                live.closeJournal();
+                s.throughput("journal.open", 1, 0, [&] {
+                    cnt::ConfigManager reopened;
+                    reopened.openJournal(journaled);
+                    doNotOptimize(reopened.size());
+                }).param("keys", keys);
+            }
+
+#if !defined(_WIN32)
+            // Pre-forked workers: each parses the file into its own heap, or
+            // attaches to the published snapshot; either way it then checks
+            // every key, so both pay for touching all of the data.
+            {
+                const size_t workers = s.quick() ? 4 : 32;
+                const std::string shmName = "/cnt-bench-" + std::to_string(::getpid());
+                cnt::ConfigManager original;   // cm has been through the update cases
+                original.loadText(text);
+                cnt::ConfigPublisher publisher(shmName);
+                s.throughput("shm.publish", 1, fileBytes, [&] { doNotOptimize(publisher.publish(original)); })
+                    .param("keys", keys);
+                publisher.publish(original);   // in case --filter skipped the case above
+                const auto checkAll = [&](const auto& config) {
+                    for (const auto& entry : entries)
+                    {
+                        if (config[entry.first] != entry.second) return false;
+                    }
+                    return true;
+                };
+                double privateBytes = 0;
+                Result& parsed = s.throughput("workers.ready", workers, 0, [&] {
+                    privateBytes = forkWorkers(workers, [&] {
+                        cnt::ConfigManager own;
+                        return own.loadText(text) && checkAll(static_cast<const cnt::ConfigManager&>(own));
+                    });
+                });
+                parsed.param("keys", keys).param("mode", "parse").metric("private_rss_per_worker", privateBytes);
+                Result& shared = s.throughput("workers.ready", workers, 0, [&] {
+                    privateBytes = forkWorkers(workers, [&] {
+                        cnt::SharedConfig snapshot(shmName);
+                        return checkAll(snapshot);
+                    });
+                });
+                shared.param("keys", keys).param("mode", "shm").metric("private_rss_per_worker", privateBytes);
+
+                cnt::SharedConfig snapshot(shmName);
+                s.throughput("shm.lookup.hit", lookups, 0, [&] {
+                    for (const auto& name : hits) doNotOptimize(snapshot[name].size());
+                }).param("keys", keys);
+                publisher.unlink();
+            }
+#endif
+
+            s.throughput("insert", keys, 0, [&] {
+                cnt::ConfigManager fresh;
+                for (const auto& entry : entries) fresh.add(entry.first, entry.second);
+                doNotOptimize(fresh.size());
+            }).param("keys", keys);
+        }
+    });
+}
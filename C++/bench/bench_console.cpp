@@ -0,0 +1,156 @@
+/**
+ * @file bench/bench_console.cpp
+ * Copyright 2025, aplcexenicesetrl project
+ * MIT License
+ *
+ * cnt::TerminalRenderer frame time and output size against a pipe, at 80x24
+ * and 200x60: frames that change every cell, frames that only update a
+ * status line, and unchanged frames (which must write nothing). Every byte
+ * present() reports is checked against what the reading end received, and C0
+ * and C1 control characters must never reach it.
+ */
+
+#include "bench_common.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <cnt/terminal.h>
+#if !defined(_WIN32)
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+using namespace cnt_bench;
+
+namespace
+{
+#if !defined(_WIN32)
+    // A pipe drained on its own thread, standing in for a fast terminal.
+    class PipeTerminal
+    {
+    public:
+        PipeTerminal()
+        {
+            if (::pipe(fds_) != 0) throw std::runtime_error("pipe() failed");
+            reader_ = std::thread([this] {
+                char buffer[65536];
+                for (;;)
+                {
+                    const ssize_t n = ::read(fds_[0], buffer, sizeof(buffer));
+                    if (n > 0) received_ += static_cast<size_t>(n);
+                    else if (n == 0 || errno != EINTR) break;
+                }
+            });
+        }
+        ~PipeTerminal() { close(); }
+
+        int fd() const { return fds_[1]; }
+
+        // Closes the writing end and returns the number of bytes the reader saw.
+        size_t close()
+        {
+            if (fds_[1] >= 0)
+            {
+                ::close(fds_[1]);
+                fds_[1] = -1;
+                reader_.join();
+                ::close(fds_[0]);
+            }
+            return received_;
+        }
+
+    private:
+        int fds_[2];
+        std::thread reader_;
+        size_t received_ = 0;   // only read after the join
+    };
+
+    // Fills the screen so that every cell differs from the previous frame:
+    // ASCII with a Greek letter every eighth column, colours cycling per row.
+    void drawDashboard(cnt::TerminalRenderer& r, unsigned frame)
+    {
+        for (int y = 0; y < r.height(); ++y)
+        {
+            const auto fg = static_cast<uint8_t>((y + frame) % 16);
+            for (int x = 0; x < r.width(); ++x)
+            {
+                const char32_t base = x % 8 == 0 ? U'\u03B1' : U'a';
+                r.put(x, y, base + static_cast<char32_t>((x + y + frame) % 26), fg);
+            }
+        }
+    }
+
+    // Rewrites the bottom line only: a counter that changes a few cells.
+    void drawStatus(cnt::TerminalRenderer& r, unsigned frame)
+    {
+        char status[64];
+        std::snprintf(status, sizeof(status), " frame %u  requests %u ", frame, frame * 7);
+        r.print(0, r.height() - 1, status, 0, 2);
+    }
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    return runMain(argc, argv, "console", [](Suite& s) {
+#if !defined(_WIN32)
+        std::string controls;
+        for (char32_t ch : {U'\x1B', U'\x7F', U'\x9B', U'\x9C'}) cnt::TerminalRenderer::appendUtf8(controls, ch);
+        if (controls != "????") throw std::runtime_error("a control character reached the terminal output");
+
+        const struct
+        {
+            int width;
+            int height;
+        } sizes[] = {{80, 24}, {200, 60}};
+        for (const auto& size : sizes)
+        {
+            const std::string param = std::to_string(size.width) + "x" + std::to_string(size.height);
+            PipeTerminal terminal;
+            cnt::TerminalRenderer renderer(terminal.fd(), size.width, size.height);
+            unsigned frame = 0;
+            drawDashboard(renderer, frame);
+            size_t written = renderer.present().bytesWritten;
+
+            const auto frames = [&](const char* name, void (*draw)(cnt::TerminalRenderer&, unsigned)) {
+                size_t runs = 0, bytes = 0, cells = 0;
+                Result& r = s.throughput(name, 1, 0, [&] {
+                    draw(renderer, ++frame);
+                    const auto stats = renderer.present();
+                    bytes += stats.bytesWritten;
+                    cells += stats.cellsChanged;
+                    ++runs;
+                }).param("size", param);
+                written += bytes;
+                const double perFrame = runs ? static_cast<double>(bytes) / runs : 0;
+                r.metric("bytes_per_frame", perFrame)
+                    .metric("cells_per_frame", runs ? static_cast<double>(cells) / runs : 0);
+                return perFrame;
+            };
+
+            const double full = frames("present.full", drawDashboard);
+            const double partial = frames("present.partial", drawStatus);
+            if (full > 0 && partial > 0 && partial >= full)
+            {
+                throw std::runtime_error("a status-line update wrote as much as a full-screen one");
+            }
+
+            size_t unchangedBytes = 0;
+            s.throughput("present.unchanged", 1, 0, [&] {
+                unchangedBytes += renderer.present().bytesWritten;
+            }).param("size", param);
+            if (unchangedBytes != 0) throw std::runtime_error("present() wrote output for an unchanged frame");
+
+            if (terminal.close() != written)
+            {
+                throw std::runtime_error("the pipe received a different byte count than present() reported");
+            }
+        }
+#else
+        (void)s;
+#endif
+    });
+}
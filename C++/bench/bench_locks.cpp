@@ -0,0 +1,177 @@
+/**
+ * @file bench/bench_locks.cpp
+ * Copyright 2025, aplcexenicesetrl project
+ * MIT License
+ *
+ * cnt::locks: encrypt throughput (GB/s) over random payloads, with a fresh
+ * result buffer per call (and the OS mappings it costs) and with a reused
+ * one, secure_pool allocate/free against malloc/free, the checked (CRC-32C per
+ * block) payload format against raw, CRC-32C itself on the hardware and
+ * table paths, and key vault open/lookup cost for N stored keys; a vault
+ * key must unseal to its bytes and a wrong master key must be refused.
+ */
+
+#include "bench_common.h"
+
+#include <cnt/lockskey.h>
+
+using namespace cnt_bench;
+
+int main(int argc, char** argv)
+{
+    return runMain(argc, argv, "locks", [](Suite& s) {
+        TempDir dir("locks");
+        const uint64_t seed = s.options().seed;
+
+        cnt::locks locks;
+        locks.create_key("bench", "bench", "MIT", "1", randomPayload(64, seed));
+
+        const std::vector<size_t> sizes = s.quick() ? std::vector<size_t>{64, 4096, 1 << 20}
+                                                    : std::vector<size_t>{64, 1024, 4096, 65536, 1 << 20, 16 << 20};
+        for (size_t size : sizes)
+        {
+            const auto payload = randomPayload(size, seed + size);
+            const uint64_t calls = std::max<uint64_t>(1, (s.quick() ? (4u << 20) : (64u << 20)) / size);
+
+            const auto before = cnt::secure_pool::instance().get_stats();
+            uint64_t runs = 0;
+            Result& fresh = s.throughput("encrypt", calls, static_cast<double>(size), [&] {
+                for (uint64_t i = 0; i < calls; ++i) doNotOptimize(locks.encrypt("bench", payload).data());
+                runs += calls;
+            });
+            const auto after = cnt::secure_pool::instance().get_stats();
+            fresh.param("bytes", size)
+                .metric("system_maps_per_call", static_cast<double>(after.system_maps - before.system_maps) /
+                                                    static_cast<double>(std::max<uint64_t>(runs, 1)));
+
+            cnt::secure_bytes out;
+            s.throughput("encrypt.reuse", calls, static_cast<double>(size), [&] {
+                for (uint64_t i = 0; i < calls; ++i)
+                {
+                    locks.encrypt("bench", payload.data(), payload.size(), out);
+                    doNotOptimize(out.data());
+                }
+            }).param("bytes", size);
+
+            cnt::secure_bytes sealed;
+            s.throughput("encrypt.checked", calls, static_cast<double>(size), [&] {
+                for (uint64_t i = 0; i < calls; ++i)
+                {
+                    locks.encrypt("bench", payload.data(), payload.size(), sealed, cnt::locks::payload_format::checked);
+                    doNotOptimize(sealed.data());
+                }
+            }).param("bytes", size);
+
+            s.throughput("decrypt.checked", calls, static_cast<double>(size), [&] {
+                for (uint64_t i = 0; i < calls; ++i)
+                {
+                    locks.decrypt("bench", sealed.data(), sealed.size(), out, cnt::locks::payload_format::checked);
+                    doNotOptimize(out.data());
+                }
+            }).param("bytes", size);
+        }
+
+        // Allocation rate of the pool itself, against the general heap.
+        {
+            const uint64_t calls = s.quick() ? 10000 : 200000;
+            for (size_t size : {size_t(64), size_t(4096), size_t(65536), size_t(1) << 20})
+            {
+                cnt::secure_pool& pool = cnt::secure_pool::instance();
+                const auto before = pool.get_stats();
+                uint64_t runs = 0;
+                Result& r = s.throughput("secure_pool.alloc", calls, 0, [&] {
+                    for (uint64_t i = 0; i < calls; ++i)
+                    {
+                        void* p = pool.allocate(size);
+                        static_cast<char*>(p)[0] = 1;
+                        doNotOptimize(p);
+                        pool.deallocate(p, size);
+                    }
+                    runs += calls;
+                });
+                const auto after = pool.get_stats();
+                r.param("bytes", size)
+                    .metric("system_maps_per_call", static_cast<double>(after.system_maps - before.system_maps) /
+                                                        static_cast<double>(std::max<uint64_t>(runs, 1)))
+                    .metric("mapped_bytes", static_cast<double>(after.mapped_bytes));
+                s.throughput("malloc", calls, 0, [&] {
+                    for (uint64_t i = 0; i < calls; ++i)
+                    {
+                        void* p = std::malloc(size);
+                        static_cast<char*>(p)[0] = 1;
+                        doNotOptimize(p);
+                        std::free(p);
+                    }
+                }).param("bytes", size);
+            }
+        }
+
+        {
+            const size_t size = 1 << 20;
+            const auto payload = randomPayload(size, seed);
+            const uint64_t calls = s.quick() ? 16 : 256;
+            const bool hardware = cnt::crc32c::hardware();
+            for (bool useHardware : {true, false})
+            {
+                if (useHardware && !cnt::crc32c::hardware_available()) continue;
+                cnt::crc32c::set_hardware(useHardware);
+                s.throughput("crc32c", calls, static_cast<double>(size), [&] {
+                    for (uint64_t i = 0; i < calls; ++i) doNotOptimize(cnt::crc32c::value(payload.data(), size));
+                }).param("impl", cnt::crc32c::implementation());
+            }
+            cnt::crc32c::set_hardware(hardware);
+        }
+
+        const std::vector<size_t> vaultSizes = s.quick() ? std::vector<size_t>{1000} : std::vector<size_t>{1000, 100000};
+        const std::vector<uint8_t> master = randomPayload(32, seed ^ 0x5A5A);
+        for (size_t keys : vaultSizes)
+        {
+            const std::string path = dir.file("bench_" + std::to_string(keys) + ".vault");
+            const auto key = randomPayload(32, seed);
+            {
+                cnt::lock_vault vault(path, master);
+                for (size_t i = 0; i < keys; ++i)
+                {
+                    vault.put("key_" + std::to_string(i), "bench", "MIT", "1", key.data(), key.size(), 0);
+                }
+                vault.compact();
+            }
+
+            s.throughput("vault.open", 1, 0, [&] {
+                cnt::lock_vault vault(path, master);
+                doNotOptimize(vault.size());
+            }).param("keys", keys);
+
+            cnt::lock_vault vault(path, master);
+            const size_t lookups = 10000;
+            Rng rng(seed);
+            std::vector<std::string> ids;
+            for (size_t i = 0; i < lookups; ++i) ids.push_back("key_" + std::to_string(rng.below(keys)));
+            s.throughput("vault.find", lookups, 0, [&] {
+                cnt::lock_vault::record r;
+                for (const auto& id : ids) doNotOptimize(vault.find(id, r));
+            }).param("keys", keys);
+
+            cnt::lock_vault::record r;
+            std::vector<uint8_t> unsealed(key.size());
+            if (!vault.find("key_0", r) || r.key_size != key.size()) throw std::runtime_error("vault lost a key");
+            vault.unseal(r, unsealed.data());
+            if (unsealed != key || std::equal(key.begin(), key.end(), r.sealed_key))
+            {
+                throw std::runtime_error("vault key did not round-trip through sealing");
+            }
+            std::vector<uint8_t> wrongMaster = master;
+            wrongMaster[0] ^= 1;
+            bool rejected = false;
+            try
+            {
+                cnt::lock_vault other(path, wrongMaster);
+            }
+            catch (const std::invalid_argument&)
+            {
+                rejected = true;
+            }
+            if (!rejected) throw std::runtime_error("vault opened with the wrong master key");
+        }
+    });
+}
@@ -0,0 +1,304 @@
+/**
+ * @file bench/bench_logging.cpp
+ * Copyright 2025, aplcexenicesetrl project
+ * MIT License
+ *
+ * cnt::Logging throughput and per-call latency for every output mode:
+ * synchronous file output, records filtered by level (also while another
+ * thread keeps changing the level), DEBUG records sampled 1 in 100 and with
+ * 1% probability, the asynchronous
+ * console sink (against /dev/null and against a deliberately slow pipe
+ * reader, which fails the run if a caller blocks or an ERROR line is lost),
+ * the memory-mapped log ring, and the io_uring file sink (also with
+ * O_DIRECT, and on its pwritev fallback) against a blocking write() per line.
+ */
+
+#include "bench_common.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <cnt/loggings.h>
+#include <cnt/logring.h>
+#if !defined(_WIN32)
+#include <cnt/asyncconsole.h>
+#include <cnt/uringsink.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace cnt_bench;
+
+namespace
+{
+    // Counts the records that got through.
+    class CountingSink : public cnt::LogSink
+    {
+    public:
+        void write(cnt::LogLevel, const std::string& message) override
+        {
+            ++count_;
+            doNotOptimize(message.size());
+        }
+
+        size_t count() const { return count_; }
+
+    private:
+        size_t count_ = 0;
+    };
+
+    // A logger that writes nowhere except what the case attaches.
+    cnt::Logger quietLogger(const char* name)
+    {
+        cnt::Logger logger(name);
+        logger.enableConsoleOutput(false);
+        logger.enableColor(false);
+        return logger;
+    }
+
+#if !defined(_WIN32)
+    // One write() per line, in the caller: the baseline for the file sinks.
+    class BlockingWriteSink : public cnt::LogSink
+    {
+    public:
+        explicit BlockingWriteSink(const std::string& path)
+            : fd_(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644))
+        {
+            if (fd_ < 0) throw std::runtime_error("open() failed: " + path);
+        }
+        ~BlockingWriteSink() override { ::close(fd_); }
+
+        void write(cnt::LogLevel, const std::string& message) override
+        {
+            doNotOptimize(::write(fd_, message.data(), message.size()));
+        }
+
+    private:
+        int fd_;
+    };
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    return runMain(argc, argv, "logging", [](Suite& s) {
+        TempDir dir("logging");
+        const size_t messages = s.quick() ? 2000 : 200000;
+
+        {
+            cnt::Logger logger = quietLogger("file");
+            logger.setOutputFile(dir.file("bench.log"));
+            cnt::Logging logging(&logger);
+            s.throughput("sync.file", messages, 0, [&] {
+                for (size_t i = 0; i < messages; ++i) logging.info("request %zu served in %d us", i, 42);
+            });
+            s.latency("sync.file.latency", messages, [&](size_t i) { logging.info("request %zu served in %d us", i, 42); });
+        }
+
+        {
+            cnt::Logger logger = quietLogger("filtered");
+            logger.setLevel(cnt::LogLevel::WARNING);
+            cnt::Logging logging(&logger);
+            s.throughput("filtered", messages, 0, [&] {
+                for (size_t i = 0; i < messages; ++i) logging.debug("request %zu served in %d us", i, 42);
+            });
+
+            // The level check is a relaxed load; a writer changing the level
+            // must not slow the readers down.
+            std::atomic<bool> stop{false};
+            size_t changes = 0;
+            std::thread toggler([&] {
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    logger.setLevel(changes++ % 2 ? cnt::LogLevel::WARNING : cnt::LogLevel::ERROR);
+                    std::this_thread::yield();
+                }
+            });
+            Result& r = s.throughput("filtered.level_changes", messages, 0, [&] {
+                for (size_t i = 0; i < messages; ++i) logging.debug("request %zu served in %d us", i, 42);
+            });
+            stop = true;
+            toggler.join();
+            r.metric("level_changes", static_cast<double>(changes));
+        }
+
+        {
+            auto sink = std::make_shared<CountingSink>();
+            cnt::Logger logger = quietLogger("sampled");
+            logger.setLevel(cnt::LogLevel::DEBUG);
+            logger.addSink(sink);
+            cnt::Logging logging(&logger);
+            const struct
+            {
+                const char* name;
+                cnt::LogSampling sampling;
+            } cases[] = {
+                {"sampled.1in100", cnt::LogSampling::everyNth(100)},
+                {"sampled.1pct", cnt::LogSampling::withProbability(0.01)},
+            };
+            for (const auto& c : cases)
+            {
+                logger.setSampling(c.sampling);
+                const size_t before = sink->count();
+                size_t logged = 0;
+                Result& r = s.throughput(c.name, messages, 0, [&] {
+                    for (size_t i = 0; i < messages; ++i) logging.debug("request %zu served in %d us", i, 42);
+                    logged += messages;
+                });
+                r.metric("kept_per_mille", 1000.0 * static_cast<double>(sink->count() - before) / static_cast<double>(logged));
+            }
+        }
+
+        {
+            auto ring = std::make_shared<cnt::MappedLogRing>(dir.file("bench.ring"), 16u << 20);
+            cnt::Logger logger = quietLogger("ring");
+            logger.setLevel(cnt::LogLevel::WARNING);
+            logger.addSink(ring);
+            cnt::Logging logging(&logger);
+            s.throughput("ring.debug", messages, 0, [&] {
+                for (size_t i = 0; i < messages; ++i) logging.debug("request %zu served in %d us", i, 42);
+            });
+            s.latency("ring.debug.latency", messages, [&](size_t i) { logging.debug("request %zu served in %d us", i, 42); });
+
+            const std::string line = "[2025-01-01 00:00:00] - ring - DEBUG - request 123456 served in 42 us\n";
+            s.throughput("ring.append", messages, static_cast<double>(line.size()), [&] {
+                for (size_t i = 0; i < messages; ++i) ring->write(cnt::LogLevel::DEBUG, line);
+            });
+        }
+
+#if !defined(_WIN32)
+        {
+            int devnull = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+            cnt::AsyncConsoleSink::Options options;
+            options.fd = devnull;
+            auto sink = std::make_shared<cnt::AsyncConsoleSink>(options);
+            cnt::Logger logger = quietLogger("async");
+            logger.addSink(sink);
+            cnt::Logging logging(&logger);
+            Result& r = s.latency("async.devnull.latency", messages,
+                                  [&](size_t i) { logging.info("request %zu served in %d us", i, 42); });
+            sink->flush();
+            auto stats = sink->getStats();
+            r.metric("dropped_info", static_cast<double>(stats.dropped[1]))
+                .metric("writev_calls", static_cast<double>(stats.writeCalls));
+            logger.clearSinks();
+            sink.reset();
+            ::close(devnull);
+        }
+
+        if (s.enabled("async.slowpipe.latency"))
+        {
+            // A terminal that reads nothing until the producer is done (or a
+            // 10 s watchdog fires) and then drains ~1 MB/s. A producer call
+            // that waited on the pipe could only return after the watchdog,
+            // and every ERROR line must reach the reader.
+            int fds[2];
+            if (::pipe(fds) != 0) throw std::runtime_error("pipe() failed");
+#if defined(F_SETPIPE_SZ)
+            fcntl(fds[1], F_SETPIPE_SZ, 4096);
+#endif
+            std::atomic<bool> produced{false};
+            std::atomic<bool> watchdogFired{false};
+            std::string received;
+            std::thread reader([&] {
+                const auto watchdog = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+                while (!produced.load())
+                {
+                    if (std::chrono::steady_clock::now() >= watchdog)
+                    {
+                        watchdogFired = true;
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                char buffer[1024];
+                ssize_t n;
+                while ((n = ::read(fds[0], buffer, sizeof(buffer))) > 0)
+                {
+                    received.append(buffer, static_cast<size_t>(n));
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+
+            {
+                cnt::AsyncConsoleSink::Options options;
+                options.fd = fds[1];
+                options.queueCapacity = 1024;
+                options.color = false;
+                // Long enough to drain every queued ERROR line at the reader's pace.
+                options.shutdownTimeout = std::chrono::seconds(30);
+                auto sink = std::make_shared<cnt::AsyncConsoleSink>(options);
+                cnt::Logger logger = quietLogger("slow");
+                logger.setLevel(cnt::LogLevel::DEBUG);
+                logger.addSink(sink);
+                cnt::Logging logging(&logger);
+
+                Result& r = s.latency("async.slowpipe.latency", messages, [&](size_t i) {
+                    if (i % 100 == 0) logging.error("request %zu failed", i);
+                    else logging.debug("request %zu served in %d us", i, 42);
+                });
+                auto stats = sink->getStats();
+                r.metric("queued", static_cast<double>(stats.queued))
+                    .metric("dropped_debug", static_cast<double>(stats.dropped[0]))
+                    .metric("dropped_error", static_cast<double>(stats.dropped[3]))
+                    .metric("writev_calls", static_cast<double>(stats.writeCalls));
+                produced = true;
+            }
+            ::close(fds[1]);
+            reader.join();
+            ::close(fds[0]);
+
+            if (watchdogFired) throw std::runtime_error("a producer call blocked on the slow pipe");
+            std::vector<bool> seen(messages, false);
+            for (size_t at = received.find("request "); at != std::string::npos; at = received.find("request ", at + 1))
+            {
+                char* end = nullptr;
+                const unsigned long long i = std::strtoull(received.c_str() + at + 8, &end, 10);
+                if (i < messages && std::strncmp(end, " failed", 7) == 0) seen[i] = true;
+            }
+            for (size_t i = 0; i < messages; i += 100)
+            {
+                if (!seen[i]) throw std::runtime_error("ERROR line for request " + std::to_string(i) + " never reached the pipe");
+            }
+        }
+
+        {
+            // Sustained file output straight into each sink, flush included,
+            // and the cost of a single call. writtenBytes / submissions is the
+            // average request size the writer thread achieved.
+            const std::string line = "[2025-01-01 00:00:00] - file - INFO - request 123456 served in 42 us\n";
+            const size_t lines = s.quick() ? 20000 : 1000000;
+            const std::string path = dir.file("sink.log");
+            const auto sinkCases = [&](const std::string& impl, cnt::LogSink& sink) -> Result& {
+                s.throughput("file.sink", lines, static_cast<double>(line.size()), [&] {
+                    for (size_t i = 0; i < lines; ++i) sink.write(cnt::LogLevel::INFO, line);
+                    sink.flush();
+                }).param("impl", impl);
+                Result& r = s.latency("file.sink.latency", lines, [&](size_t) { sink.write(cnt::LogLevel::INFO, line); })
+                    .param("impl", impl);
+                sink.flush();
+                return r;
+            };
+
+            {
+                BlockingWriteSink sink(path);
+                sinkCases("write", sink);
+            }
+            for (const std::string impl : {"uring", "uring.direct", "pwritev"})
+            {
+                cnt::UringFileSink::Options options;
+                options.truncate = true;
+                options.useUring = impl != "pwritev";
+                options.direct = impl == "uring.direct";
+                cnt::UringFileSink sink(path, options);
+                Result& r = sinkCases(impl, sink);
+                auto stats = sink.getStats();
+                r.param("backend", sink.backend())
+                    .metric("stalls", static_cast<double>(stats.stalls))
+                    .metric("avg_request_bytes", stats.submissions ? static_cast<double>(stats.writtenBytes) / stats.submissions : 0);
+            }
+        }
+#endif
+    });
+}
@@ -0,0 +1,361 @@
+/**
+ * @file bench/bench_vector.cpp
+ * Copyright 2025, aplcexenicesetrl project
+ * MIT License
+ *
+ * cnt::Vector against std::vector: growth by push_back, iteration, copies,
+ * small-buffer use at small, medium and large inline capacities (and past
+ * them), insert/erase in the middle, every SIMD bulk kernel at every
+ * instruction-set level the CPU supports, the cnt/parallel.h algorithms
+ * across thread counts (reduce is checked to be bit-identical on every pool),
+ * and the cnt/mmapalloc.h storage options for large vectors: growth time and
+ * minor page faults against the default heap path, random gathers (TLB
+ * reach) and reopening a file-backed vector against reading it back.
+ */
+
+#include "bench_common.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cnt/Vector.h>
+#include <cnt/mmapalloc.h>
+#include <cnt/parallel.h>
+
+using namespace cnt_bench;
+
+namespace
+{
+    // Builds short-lived vectors of `count` ints, enough of them to push about
+    // `elements` in total. cnt::Vector<int, N> keeps up to N of them inline.
+    template <size_t N>
+    void inlineVectors(Suite& s, const char* name, size_t count, size_t elements)
+    {
+        const size_t runs = std::max<size_t>(1, elements / count);
+        s.throughput(name, runs, 0, [&] {
+            for (size_t r = 0; r < runs; ++r)
+            {
+                cnt::Vector<int, N> v;
+                for (size_t i = 0; i < count; ++i) v.push_back(static_cast<int>(i));
+                doNotOptimize(v.data());
+            }
+        }).param("impl", "cnt.inline").param("inline", N).param("n", count);
+        s.throughput(name, runs, 0, [&] {
+            for (size_t r = 0; r < runs; ++r)
+            {
+                cnt::Vector<int> v;
+                for (size_t i = 0; i < count; ++i) v.push_back(static_cast<int>(i));
+                doNotOptimize(v.data());
+            }
+        }).param("impl", "cnt.heap").param("n", count);
+        s.throughput(name, runs, 0, [&] {
+            for (size_t r = 0; r < runs; ++r)
+            {
+                std::vector<int> v;
+                for (size_t i = 0; i < count; ++i) v.push_back(static_cast<int>(i));
+                doNotOptimize(v.data());
+            }
+        }).param("impl", "std").param("n", count);
+    }
+
+    template <typename T>
+    void bulkKernels(Suite& s, const char* type, size_t n, uint64_t seed)
+    {
+        cnt::Vector<T> a, b;
+        Rng rng(seed);
+        for (size_t i = 0; i < n; ++i)
+        {
+            a.push_back(static_cast<T>(rng.below(100)));
+            b.push_back(static_cast<T>(rng.below(100)));
+        }
+        const double bytes = sizeof(T);   // per element
+        const T missing = static_cast<T>(1000);
+        // add/mul run in place over and over: the identity operands keep the
+        // values bounded (no signed overflow) without changing the work done.
+        cnt::Vector<T> c(a), zeros(n, static_cast<T>(0)), ones(n, static_cast<T>(1));
+
+        const cnt::simd::level saved = cnt::simd::active_level();
+        for (int l = 0; l <= static_cast<int>(cnt::simd::detected_level()); ++l)
+        {
+            const auto level = static_cast<cnt::simd::level>(l);
+            cnt::simd::set_level(level);
+            const std::string name = cnt::simd::level_name(level);
+
+            s.throughput("fill", n, bytes, [&] { a.fill(static_cast<T>(3)); doNotOptimize(a.data()); })
+                .param("type", type).param("n", n).param("simd", name);
+            s.throughput("sum", n, bytes, [&] { doNotOptimize(a.sum()); })
+                .param("type", type).param("n", n).param("simd", name);
+            s.throughput("dot", n, 2 * bytes, [&] { doNotOptimize(a.dot(b)); })
+                .param("type", type).param("n", n).param("simd", name);
+            s.throughput("max", n, bytes, [&] { doNotOptimize(a.max()); })
+                .param("type", type).param("n", n).param("simd", name);
+            s.throughput("find.miss", n, bytes, [&] { doNotOptimize(a.find(missing)); })
+                .param("type", type).param("n", n).param("simd", name);
+            s.throughput("copy", n, 2 * bytes, [&] { c = a; doNotOptimize(c.data()); })
+                .param("type", type).param("n", n).param("simd", name);
+            s.throughput("min", n, bytes, [&] { doNotOptimize(a.min()); })
+                .param("type", type).param("n", n).param("simd", name);
+            s.throughput("add", n, 3 * bytes, [&] { c.add(zeros); doNotOptimize(c.data()); })
+                .param("type", type).param("n", n).param("simd", name);
+            s.throughput("mul", n, 3 * bytes, [&] { c.mul(ones); doNotOptimize(c.data()); })
+                .param("type", type).param("n", n).param("simd", name);
+            s.throughput("count", n, bytes, [&] { doNotOptimize(a.count(static_cast<T>(7))); })
+                .param("type", type).param("n", n).param("simd", name);
+        }
+        cnt::simd::set_level(saved);
+    }
+
+    // Grows a Vector to n elements with push_back, then gathers at random
+    // indices. Growth reports the minor page faults of one run.
+    template <typename V>
+    void largeStorage(Suite& s, const char* impl, size_t n, const std::vector<uint32_t>& indices)
+    {
+        uint64_t faults = 0, runs = 0;
+        s.throughput("large.push_back", n, sizeof(uint64_t), [&] {
+            const uint64_t before = minorPageFaults();
+            V v;
+            for (size_t i = 0; i < n; ++i) v.push_back(i);
+            doNotOptimize(v.data());
+            faults += minorPageFaults() - before;
+            ++runs;
+        }).param("impl", impl).param("n", n).metric("minor_faults", runs ? static_cast<double>(faults / runs) : 0.0);
+
+        V v;
+        v.resize(n);
+        for (size_t i = 0; i < n; ++i) v[i] = i;
+        s.throughput("large.gather", indices.size(), sizeof(uint64_t), [&] {
+            uint64_t sum = 0;
+            for (uint32_t index : indices) sum += v[index];
+            doNotOptimize(sum);
+        }).param("impl", impl).param("n", n);
+    }
+
+    void largeVectors(Suite& s, size_t n, uint64_t seed)
+    {
+        std::vector<uint32_t> indices(1 << 20);
+        Rng rng(seed);
+        for (auto& index : indices) index = static_cast<uint32_t>(rng.below(n));
+
+        largeStorage<std::vector<uint64_t>>(s, "std", n, indices);
+        largeStorage<cnt::Vector<uint64_t>>(s, "cnt.heap", n, indices);
+        largeStorage<cnt::Vector<uint64_t, 0, cnt::mmap_allocator<uint64_t, cnt::page_mode::normal>>>(s, "mmap", n, indices);
+        largeStorage<cnt::Vector<uint64_t, 0, cnt::mmap_allocator<uint64_t, cnt::page_mode::transparent_huge>>>(s, "mmap.thp", n, indices);
+        const uint64_t fallbacks = cnt::mapped_memory_stats().hugetlb_fallbacks;
+        largeStorage<cnt::Vector<uint64_t, 0, cnt::mmap_allocator<uint64_t, cnt::page_mode::hugetlb>>>(s, "mmap.hugetlb", n, indices);
+        if (cnt::mapped_memory_stats().hugetlb_fallbacks != fallbacks)
+        {
+            std::fprintf(stderr, "note: no hugetlbfs pages (vm.nr_hugepages), mmap.hugetlb ran on transparent huge pages\n");
+        }
+
+        // Reopening: map the stored elements vs read them into a heap Vector.
+        TempDir dir("vector");
+        const std::string mapped = dir.file("large.vec");
+        const std::string plain = dir.file("large.bin");
+        {
+            cnt::file_vector<uint64_t> v{cnt::file_allocator<uint64_t>(mapped, true)};
+            v.resize(n);
+            for (size_t i = 0; i < n; ++i) v[i] = i;
+            std::FILE* f = std::fopen(plain.c_str(), "wb");
+            if (!f) throw std::runtime_error("fopen() failed: " + plain);
+            const bool ok = std::fwrite(v.data(), sizeof(uint64_t), n, f) == n;
+            std::fclose(f);
+            if (!ok) throw std::runtime_error("fwrite() failed: " + plain);
+
+            // The file still belongs to the vector moved into, so a moved-from
+            // file_vector must refuse new storage.
+            cnt::file_vector<uint64_t> moved(std::move(v));
+            bool refused = false;
+            try
+            {
+                v.push_back(0);
+            }
+            catch (const std::logic_error&)
+            {
+                refused = true;
+            }
+            if (!refused || moved.size() != n) throw std::runtime_error("a moved-from file_vector reused its file");
+        }
+        s.throughput("large.reopen", 1, static_cast<double>(n * sizeof(uint64_t)), [&] {
+            cnt::file_vector<uint64_t> v{cnt::file_allocator<uint64_t>(mapped)};
+            if (v.size() != n) throw std::runtime_error("file_vector lost its elements");
+            doNotOptimize(v[n / 2]);
+        }).param("impl", "file_vector").param("n", n);
+        s.throughput("large.reopen", 1, static_cast<double>(n * sizeof(uint64_t)), [&] {
+            std::FILE* f = std::fopen(plain.c_str(), "rb");
+            if (!f) throw std::runtime_error("fopen() failed: " + plain);
+            cnt::Vector<uint64_t> v(n);
+            const size_t read = std::fread(v.data(), sizeof(uint64_t), n, f);
+            std::fclose(f);
+            if (read != n) throw std::runtime_error("short read: " + plain);
+            doNotOptimize(v[n / 2]);
+        }).param("impl", "read").param("n", n);
+    }
+
+    void parallelAlgorithms(Suite& s, size_t n, uint64_t seed)
+    {
+        cnt::Vector<double> values;
+        cnt::Vector<uint32_t> keys;
+        Rng rng(seed);
+        for (size_t i = 0; i < n; ++i)
+        {
+            values.push_back(static_cast<double>(rng.below(1000000)) / 7.0 - 70000.0);
+            keys.push_back(static_cast<uint32_t>(rng.next()));
+        }
+
+        std::vector<size_t> threadCounts;
+        const size_t hardware = std::max<size_t>(2, std::thread::hardware_concurrency());
+        for (size_t t = 1; t <= hardware; t *= 2) threadCounts.push_back(t);
+        if (threadCounts.back() != hardware) threadCounts.push_back(hardware);
+
+        cnt::Vector<uint32_t> work;
+        s.throughput("parallel.sort", n, sizeof(uint32_t), [&] {
+            work = keys;
+            std::sort(work.begin(), work.end());
+            doNotOptimize(work.data());
+        }).param("impl", "std.serial").param("n", n);
+
+        double serialSum = 0;
+        bool haveSerialSum = false;
+        for (size_t threads : threadCounts)
+        {
+            cnt::parallel::thread_pool pool(threads);
+            const cnt::parallel::options opt{0, &pool};
+
+            s.throughput("parallel.sort", n, sizeof(uint32_t), [&] {
+                work = keys;
+                cnt::parallel::sort(work, std::less<>(), opt);
+                doNotOptimize(work.data());
+            }).param("impl", "cnt").param("n", n).param("threads", threads);
+            if (!std::is_sorted(work.begin(), work.end())) throw std::runtime_error("parallel::sort left the input unsorted");
+
+            double sum = 0;
+            s.throughput("parallel.reduce", n, sizeof(double), [&] {
+                sum = cnt::parallel::reduce(values, 0.0, std::plus<>(), opt);
+                doNotOptimize(sum);
+            }).param("n", n).param("threads", threads);
+            // Fixed chunking: the same bits on every pool.
+            if (!haveSerialSum)
+            {
+                serialSum = sum;
+                haveSerialSum = true;
+            }
+            else if (std::memcmp(&sum, &serialSum, sizeof(sum)) != 0)
+            {
+                throw std::runtime_error("parallel::reduce differs between thread counts");
+            }
+
+            cnt::Vector<double> out;
+            s.throughput("parallel.transform", n, 2 * sizeof(double), [&] {
+                cnt::parallel::transform(values, out, [](double x) { return x * 1.5 + 2.0; }, opt);
+                doNotOptimize(out.data());
+            }).param("n", n).param("threads", threads);
+
+            s.throughput("parallel.for_each", n, sizeof(double), [&] {
+                cnt::parallel::for_each(out, [](double& x) { x = x * 0.5 - 1.0; }, opt);
+                doNotOptimize(out.data());
+            }).param("n", n).param("threads", threads);
+
+            s.throughput("parallel.find_if.miss", n, sizeof(double), [&] {
+                doNotOptimize(cnt::parallel::find_if(values, [](double x) { return x > 1e12; }, opt));
+            }).param("n", n).param("threads", threads);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    return runMain(argc, argv, "vector", [](Suite& s) {
+        const size_t n = s.quick() ? 100000 : 10000000;
+
+        s.throughput("push_back", n, sizeof(int), [&] {
+            cnt::Vector<int> v;
+            for (size_t i = 0; i < n; ++i) v.push_back(static_cast<int>(i));
+            doNotOptimize(v.data());
+        }).param("impl", "cnt").param("n", n);
+        s.throughput("push_back", n, sizeof(int), [&] {
+            std::vector<int> v;
+            for (size_t i = 0; i < n; ++i) v.push_back(static_cast<int>(i));
+            doNotOptimize(v.data());
+        }).param("impl", "std").param("n", n);
+
+        s.throughput("push_back.string", n / 10, 0, [&] {
+            cnt::Vector<std::string> v;
+            for (size_t i = 0; i < n / 10; ++i) v.emplace_back("value");
+            doNotOptimize(v.data());
+        }).param("impl", "cnt").param("n", n / 10);
+        s.throughput("push_back.string", n / 10, 0, [&] {
+            std::vector<std::string> v;
+            for (size_t i = 0; i < n / 10; ++i) v.emplace_back("value");
+            doNotOptimize(v.data());
+        }).param("impl", "std").param("n", n / 10);
+
+        // Element access through iterators, and copies: cnt::Vector copies go through simd::copy.
+        {
+            cnt::Vector<int> cv;
+            std::vector<int> sv;
+            for (size_t i = 0; i < n; ++i)
+            {
+                cv.push_back(static_cast<int>(i));
+                sv.push_back(static_cast<int>(i));
+            }
+
+            s.throughput("iterate", n, sizeof(int), [&] {
+                int64_t sum = 0;
+                for (int x : cv) sum += x;
+                doNotOptimize(sum);
+            }).param("impl", "cnt").param("n", n);
+            s.throughput("iterate", n, sizeof(int), [&] {
+                int64_t sum = 0;
+                for (int x : sv) sum += x;
+                doNotOptimize(sum);
+            }).param("impl", "std").param("n", n);
+
+            s.throughput("copy", n, sizeof(int), [&] {
+                cnt::Vector<int> copy(cv);
+                doNotOptimize(copy.data());
+            }).param("impl", "cnt").param("n", n);
+            s.throughput("copy", n, sizeof(int), [&] {
+                std::vector<int> copy(sv);
+                doNotOptimize(copy.data());
+            }).param("impl", "std").param("n", n);
+        }
+
+        // Many short-lived vectors: the inline buffer avoids the heap entirely
+        // until the elements spill past it.
+        inlineVectors<8>(s, "small.8", 8, n);
+        inlineVectors<64>(s, "medium.64", 64, n);
+        inlineVectors<512>(s, "large.512", 512, n);
+        inlineVectors<8>(s, "small.8.spill", 32, n);
+        inlineVectors<64>(s, "medium.64.spill", 256, n);
+
+        const size_t middle = s.quick() ? 10000 : 100000;
+        cnt::Vector<int> v(middle, 1);
+        s.throughput("insert_erase.middle", 1000, 0, [&] {
+            for (int i = 0; i < 1000; ++i)
+            {
+                v.insert(v.begin() + v.size() / 2, i);
+                v.erase(v.begin() + v.size() / 2);
+            }
+        }).param("impl", "cnt").param("n", middle);
+        std::vector<int> sv(middle, 1);
+        s.throughput("insert_erase.middle", 1000, 0, [&] {
+            for (int i = 0; i < 1000; ++i)
+            {
+                sv.insert(sv.begin() + sv.size() / 2, i);
+                sv.erase(sv.begin() + sv.size() / 2);
+            }
+        }).param("impl", "std").param("n", middle);
+
+        const size_t bulk = s.quick() ? 1 << 16 : 1 << 22;
+        bulkKernels<float>(s, "float", bulk, s.options().seed);
+        bulkKernels<int32_t>(s, "int32", bulk, s.options().seed);
+        bulkKernels<double>(s, "double", bulk, s.options().seed);
+
+        parallelAlgorithms(s, s.quick() ? 1 << 18 : 1 << 23, s.options().seed);
+
+        largeVectors(s, s.quick() ? 1 << 21 : 1 << 25, s.options().seed);
+    });
+}
@@ -0,0 +1,61 @@
+/**
+ * @file bench/gen_dataset.cpp
+ * Copyright 2025, aplcexenicesetrl project
+ * MIT License
+ *
+ * Writes the benchmark datasets to disk so they can be reused outside the
+ * suite (profilers, other tools, comparing releases on identical input).
+ *
+ *   cnt_gen_dataset config  <path.cntconfig> <keys> [--value-size N] [--seed N]
+ *   cnt_gen_dataset payload <path> <bytes> [--seed N]
+ */
+
+#include "bench_common.h"
+
+using namespace cnt_bench;
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        std::fprintf(stderr,
+                     "usage: %s config <path.cntconfig> <keys> [--value-size N] [--seed N]\n"
+                     "       %s payload <path> <bytes> [--seed N]\n",
+                     argv[0], argv[0]);
+        return 2;
+    }
+
+    const std::string kind = argv[1];
+    const std::string path = argv[2];
+    const uint64_t count = std::strtoull(argv[3], nullptr, 10);
+    uint64_t seed = 42;
+    size_t valueSize = 24;
+    for (int i = 4; i + 1 < argc; i += 2)
+    {
+        const std::string option = argv[i];
+        if (option == "--seed") seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (option == "--value-size") valueSize = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        else
+        {
+            std::fprintf(stderr, "unknown option: %s\n", option.c_str());
+            return 2;
+        }
+    }
+
+    try
+    {
+        if (kind == "config") writeConfigFile(path, count, valueSize, seed);
+        else if (kind == "payload") writePayloadFile(path, count, seed);
+        else
+        {
+            std::fprintf(stderr, "unknown dataset kind: %s\n", kind.c_str());
+            return 2;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
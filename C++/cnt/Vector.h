@@ -1,5 +1,5 @@
 /**
- * @file cnt/console.h
+ * @file cnt/Vector.h
  * Copyright 2025, aplcexenicesetrl project
  * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio),
  * and according to the project license (MIT license) agreement,
@@ -18,29 +18,580 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include <initializer_list>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#include "simd.h"
+
 namespace cnt {
-	template<int _VECTOR_BIN>
+	// Types whose objects may be moved to a new address with a plain byte copy.
+	// Specialize for types that are not trivially copyable but still relocatable.
+	template<typename T>
+	struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+	// Allocator returning storage aligned to _ALIGN bytes (a cache line by default,
+	// which also satisfies 256/512-bit SIMD loads).
+	template<typename T, size_t _ALIGN = 64>
+	struct aligned_allocator {
+		using value_type = T;
+		static constexpr size_t alignment = _ALIGN < alignof(T) ? alignof(T) : _ALIGN;
+
+		template<typename U>
+		struct rebind { using other = aligned_allocator<U, _ALIGN>; };
+
+		aligned_allocator() noexcept = default;
+		template<typename U>
+		aligned_allocator(const aligned_allocator<U, _ALIGN>&) noexcept {}
+
+		T* allocate(size_t n) {
+			if (n > static_cast<size_t>(-1) / sizeof(T)) throw std::bad_alloc();
+			void* p = raw_allocate(n * sizeof(T));
+			if (!p) throw std::bad_alloc();
+			return static_cast<T*>(p);
+		}
+
+		void deallocate(T* p, size_t) noexcept {
+#if defined(_WIN32)
+			_aligned_free(p);
+#else
+			// GCC 12 cannot see that a failed realloc() in reallocate() leaves p owned by
+			// the container, and flags this free() once both are inlined together.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuse-after-free"
+#endif
+			std::free(p);
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic pop
+#endif
+#endif
+		}
+
+		// realloc-style resize for trivially relocatable contents. The C runtime may
+		// extend the block in place or move it with page remapping; only when it hands
+		// back a block with weaker alignment do we fall back to an explicit copy.
+		T* reallocate(T* p, size_t old_n, size_t new_n) {
+			if (new_n > static_cast<size_t>(-1) / sizeof(T)) throw std::bad_alloc();
+#if defined(_WIN32)
+			void* q = _aligned_realloc(p, new_n * sizeof(T), alignment);
+			if (!q) throw std::bad_alloc();
+			return static_cast<T*>(q);
+#else
+			void* q = std::realloc(p, new_n * sizeof(T));
+			if (!q) throw std::bad_alloc();
+			if (reinterpret_cast<uintptr_t>(q) % alignment == 0) return static_cast<T*>(q);
+			void* aligned = raw_allocate(new_n * sizeof(T));
+			if (!aligned) {
+				std::free(q);
+				throw std::bad_alloc();
+			}
+			std::memcpy(aligned, q, std::min(old_n, new_n) * sizeof(T));
+			std::free(q);
+			return static_cast<T*>(aligned);
+#endif
+		}
+
+		template<typename U>
+		bool operator==(const aligned_allocator<U, _ALIGN>&) const noexcept { return true; }
+		template<typename U>
+		bool operator!=(const aligned_allocator<U, _ALIGN>&) const noexcept { return false; }
+
+	private:
+		static void* raw_allocate(size_t bytes) {
+			if (bytes == 0) bytes = alignment;
+#if defined(_WIN32)
+			return _aligned_malloc(bytes, alignment);
+#else
+			void* p = nullptr;
+			return posix_memalign(&p, alignment, bytes) == 0 ? p : nullptr;
+#endif
+		}
+	};
+
+	// Geometric growth: 1.5x, starting from one cache line worth of elements.
+	struct vector_growth {
+		static size_t next_capacity(size_t capacity, size_t required, size_t elem_size) {
+			size_t initial = elem_size < 64 ? 64 / elem_size : 1;
+			size_t grown = capacity + capacity / 2;
+			return std::max(required, std::max(grown, initial));
+		}
+	};
+
+	namespace detail {
+		template<typename A, typename = void>
+		struct has_reallocate : std::false_type {};
+		template<typename A>
+		struct has_reallocate<A, std::void_t<decltype(std::declval<A&>().reallocate(
+			std::declval<typename A::value_type*>(), size_t(), size_t()))>> : std::true_type {};
+
+		// Allocators over persistent storage (file_allocator) hand existing elements
+		// to a new Vector through adopt() and learn the final size through retain().
+		template<typename A, typename = void>
+		struct has_adopt : std::false_type {};
+		template<typename A>
+		struct has_adopt<A, std::void_t<decltype(std::declval<A&>().adopt(
+			std::declval<size_t&>(), std::declval<size_t&>()))>> : std::true_type {};
+
+		template<typename A, typename = void>
+		struct has_retain : std::false_type {};
+		template<typename A>
+		struct has_retain<A, std::void_t<decltype(std::declval<A&>().retain(
+			std::declval<const typename A::value_type*>(), size_t()))>> : std::true_type {};
+
+		template<typename T, size_t N>
+		struct vector_inline_storage {
+			T* inline_data() noexcept { return reinterpret_cast<T*>(_buffer); }
+			alignas(T) unsigned char _buffer[N * sizeof(T)];
+		};
+
+		template<typename T>
+		struct vector_inline_storage<T, 0> {
+			T* inline_data() noexcept { return nullptr; }
+		};
+	}
+
+	// _VECTOR_BIN is the inline capacity: the first _VECTOR_BIN elements live inside
+	// the Vector object itself and only larger sizes allocate from _Alloc. With the
+	// default of 0 every element is heap allocated.
+	template<typename T, size_t _VECTOR_BIN = 0, typename _Alloc = aligned_allocator<T>, typename _Growth = vector_growth>
 	class Vector {
 	public:
-		Vector() : _size(0), _capacity(0), _data(nullptr) {}
-		Vector(int size) : _size(size), _capacity(size), _data(new int[size]) {}
-		Vector(const Vector& other) : _size(other._size), _capacity(other._capacity), _data(new int[other._capacity]) {
-			for (int i = 0; i < _size; ++i) {
-				_data[i] = other._data[i];
+		using value_type = T;
+		using allocator_type = _Alloc;
+		using size_type = size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference = T&;
+		using const_reference = const T&;
+		using pointer = T*;
+		using const_pointer = const T*;
+		using iterator = T*;
+		using const_iterator = const T*;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		Vector() noexcept(std::is_nothrow_default_constructible<_Alloc>::value) {}
+		explicit Vector(const _Alloc& alloc) noexcept : _impl(alloc) {
+			if constexpr (detail::has_adopt<_Alloc>::value) {
+				size_t size = 0, capacity = 0;
+				if (T* data = _impl.adopt(size, capacity)) {
+					_impl._data = data;
+					_impl._size = size;
+					_impl._capacity = capacity;
+				}
 			}
 		}
+
+		explicit Vector(size_t size, const _Alloc& alloc = _Alloc()) : _impl(alloc) {
+			resize(size);
+		}
+
+		Vector(size_t size, const T& value, const _Alloc& alloc = _Alloc()) : _impl(alloc) {
+			resize(size, value);
+		}
+
+		Vector(std::initializer_list<T> init, const _Alloc& alloc = _Alloc()) : _impl(alloc) {
+			assign(init.begin(), init.end());
+		}
+
+		template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+		Vector(It first, It last, const _Alloc& alloc = _Alloc()) : _impl(alloc) {
+			assign(first, last);
+		}
+
+		Vector(const Vector& other)
+			: _impl(std::allocator_traits<_Alloc>::select_on_container_copy_construction(other._impl)) {
+			reserve(other._impl._size);
+			copy_construct(other._impl._data, other._impl._size, _impl._data);
+			_impl._size = other._impl._size;
+		}
+
+		Vector(Vector&& other) noexcept(_VECTOR_BIN == 0 || std::is_nothrow_move_constructible<T>::value)
+			: _impl(std::move(static_cast<_Alloc&>(other._impl))) {
+			steal(other);
+		}
+
 		Vector& operator=(const Vector& other) {
 			if (this != &other) {
-				delete[] _data;
-				_size = other._size;
-				_capacity = other._capacity;
-				_data = new int[_capacity];
-				for (int i = 0; i < _size; ++i) {
-					_data[i] = other._data[i];
+				clear();
+				reserve(other._impl._size);
+				copy_construct(other._impl._data, other._impl._size, _impl._data);
+				_impl._size = other._impl._size;
+			}
+			return *this;
+		}
+
+		Vector& operator=(Vector&& other) noexcept(_VECTOR_BIN == 0 || std::is_nothrow_move_constructible<T>::value) {
+			if (this != &other) {
+				release();
+				static_cast<_Alloc&>(_impl) = std::move(static_cast<_Alloc&>(other._impl));
+				steal(other);
+			}
+			return *this;
+		}
+
+		Vector& operator=(std::initializer_list<T> init) {
+			assign(init.begin(), init.end());
+			return *this;
+		}
+
+		~Vector() { release(); }
+
+		template<typename It>
+		void assign(It first, It last) {
+			clear();
+			if constexpr (std::is_base_of<std::forward_iterator_tag,
+				typename std::iterator_traits<It>::iterator_category>::value) {
+				reserve(static_cast<size_t>(std::distance(first, last)));
+			}
+			for (; first != last; ++first) emplace_back(*first);
+		}
+
+		// Element access
+		T& operator[](size_t index) noexcept { return _impl._data[index]; }
+		const T& operator[](size_t index) const noexcept { return _impl._data[index]; }
+
+		T& at(size_t index) {
+			if (index >= _impl._size) throw std::out_of_range("Vector index out of range");
+			return _impl._data[index];
+		}
+		const T& at(size_t index) const {
+			if (index >= _impl._size) throw std::out_of_range("Vector index out of range");
+			return _impl._data[index];
+		}
+
+		T& front() noexcept { return _impl._data[0]; }
+		const T& front() const noexcept { return _impl._data[0]; }
+		T& back() noexcept { return _impl._data[_impl._size - 1]; }
+		const T& back() const noexcept { return _impl._data[_impl._size - 1]; }
+		T* data() noexcept { return _impl._data; }
+		const T* data() const noexcept { return _impl._data; }
+
+		// Iterators
+		iterator begin() noexcept { return _impl._data; }
+		iterator end() noexcept { return _impl._data + _impl._size; }
+		const_iterator begin() const noexcept { return _impl._data; }
+		const_iterator end() const noexcept { return _impl._data + _impl._size; }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend() const noexcept { return end(); }
+		reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+		reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+		// Capacity
+		bool empty() const noexcept { return _impl._size == 0; }
+		size_t size() const noexcept { return _impl._size; }
+		size_t capacity() const noexcept { return _impl._capacity; }
+		allocator_type get_allocator() const { return _impl; }
+
+		void reserve(size_t capacity) {
+			if (capacity > _impl._capacity) relocate(capacity);
+		}
+
+		void shrink_to_fit() {
+			if (!_on_heap() || _impl._size == _impl._capacity) return;
+			if (_impl._size == 0) {
+				release();
+				return;
+			}
+			relocate(_impl._size);
+		}
+
+		// Modifiers
+		void clear() noexcept {
+			destroy(_impl._data, _impl._size);
+			_impl._size = 0;
+		}
+
+		void push_back(const T& value) { emplace_back(value); }
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+
+		template<typename... Args>
+		T& emplace_back(Args&&... args) {
+			if (_impl._size == _impl._capacity) {
+				// args may alias an element that the reallocation is about to move.
+				T tmp(std::forward<Args>(args)...);
+				grow(_impl._size + 1);
+				::new (static_cast<void*>(_impl._data + _impl._size)) T(std::move(tmp));
+			}
+			else {
+				::new (static_cast<void*>(_impl._data + _impl._size)) T(std::forward<Args>(args)...);
+			}
+			return _impl._data[_impl._size++];
+		}
+
+		void pop_back() noexcept {
+			--_impl._size;
+			_impl._data[_impl._size].~T();
+		}
+
+		void resize(size_t size) {
+			if (size > _impl._size) {
+				reserve(size);
+				for (size_t i = _impl._size; i < size; ++i) ::new (static_cast<void*>(_impl._data + i)) T();
+			}
+			else {
+				destroy(_impl._data + size, _impl._size - size);
+			}
+			_impl._size = size;
+		}
+
+		void resize(size_t size, const T& value) {
+			if (size > _impl._size) {
+				if (size > _impl._capacity) {
+					T tmp(value);
+					grow(size);
+					std::uninitialized_fill(_impl._data + _impl._size, _impl._data + size, tmp);
+				}
+				else {
+					std::uninitialized_fill(_impl._data + _impl._size, _impl._data + size, value);
 				}
 			}
+			else {
+				destroy(_impl._data + size, _impl._size - size);
+			}
+			_impl._size = size;
+		}
+
+		iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+		iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+		template<typename... Args>
+		iterator emplace(const_iterator pos, Args&&... args) {
+			size_t index = static_cast<size_t>(pos - begin());
+			if (index == _impl._size) {
+				emplace_back(std::forward<Args>(args)...);
+				return begin() + index;
+			}
+			T tmp(std::forward<Args>(args)...);
+			emplace_back(std::move(back()));
+			std::move_backward(begin() + index, end() - 2, end() - 1);
+			_impl._data[index] = std::move(tmp);
+			return begin() + index;
+		}
+
+		iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+		iterator erase(const_iterator first, const_iterator last) {
+			iterator f = begin() + (first - begin());
+			iterator l = begin() + (last - begin());
+			if (f != l) {
+				iterator new_end = std::move(l, end(), f);
+				destroy(new_end, static_cast<size_t>(end() - new_end));
+				_impl._size = static_cast<size_t>(new_end - begin());
+			}
+			return f;
+		}
+
+		void swap(Vector& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+			if (!_on_heap() || !other._on_heap()) {
+				Vector tmp(std::move(other));
+				other = std::move(*this);
+				*this = std::move(tmp);
+				return;
+			}
+			using std::swap;
+			swap(static_cast<_Alloc&>(_impl), static_cast<_Alloc&>(other._impl));
+			swap(_impl._data, other._impl._data);
+			swap(_impl._size, other._impl._size);
+			swap(_impl._capacity, other._impl._capacity);
+		}
+
+		// True while the elements live in the inline buffer.
+		bool is_inline() const noexcept { return _VECTOR_BIN != 0 && !_on_heap(); }
+
+		bool operator==(const Vector& other) const {
+			return _impl._size == other._impl._size && std::equal(begin(), end(), other.begin());
+		}
+		bool operator!=(const Vector& other) const { return !(*this == other); }
+
+		// Bulk kernels for arithmetic element types, dispatched through cnt::simd.
+		void fill(const T& value) {
+			static_assert(std::is_arithmetic<T>::value, "fill() requires an arithmetic element type");
+			simd::fill(_impl._data, _impl._size, value);
+		}
+
+		T sum() const {
+			static_assert(std::is_arithmetic<T>::value, "sum() requires an arithmetic element type");
+			return simd::sum(_impl._data, _impl._size);
+		}
+
+		T min() const {
+			static_assert(std::is_arithmetic<T>::value, "min() requires an arithmetic element type");
+			if (empty()) throw std::out_of_range("min() of an empty Vector");
+			return simd::min(_impl._data, _impl._size);
+		}
+
+		T max() const {
+			static_assert(std::is_arithmetic<T>::value, "max() requires an arithmetic element type");
+			if (empty()) throw std::out_of_range("max() of an empty Vector");
+			return simd::max(_impl._data, _impl._size);
+		}
+
+		template<size_t N, typename A, typename G>
+		T dot(const Vector<T, N, A, G>& other) const {
+			static_assert(std::is_arithmetic<T>::value, "dot() requires an arithmetic element type");
+			if (other.size() != _impl._size) throw std::invalid_argument("dot() of Vectors with different sizes");
+			return simd::dot(_impl._data, other.data(), _impl._size);
+		}
+
+		// Element-wise *this += other.
+		template<size_t N, typename A, typename G>
+		Vector& add(const Vector<T, N, A, G>& other) {
+			static_assert(std::is_arithmetic<T>::value, "add() requires an arithmetic element type");
+			if (other.size() != _impl._size) throw std::invalid_argument("add() of Vectors with different sizes");
+			simd::add(_impl._data, _impl._data, other.data(), _impl._size);
 			return *this;
 		}
-		~Vector() { delete[] _data; }
+
+		// Element-wise *this *= other.
+		template<size_t N, typename A, typename G>
+		Vector& mul(const Vector<T, N, A, G>& other) {
+			static_assert(std::is_arithmetic<T>::value, "mul() requires an arithmetic element type");
+			if (other.size() != _impl._size) throw std::invalid_argument("mul() of Vectors with different sizes");
+			simd::mul(_impl._data, _impl._data, other.data(), _impl._size);
+			return *this;
+		}
+
+		const_iterator find(const T& value) const {
+			static_assert(std::is_arithmetic<T>::value, "find() requires an arithmetic element type");
+			return _impl._data + simd::find(_impl._data, _impl._size, value);
+		}
+
+		size_t count(const T& value) const {
+			static_assert(std::is_arithmetic<T>::value, "count() requires an arithmetic element type");
+			return simd::count(_impl._data, _impl._size, value);
+		}
+
+	private:
+		static constexpr bool _relocatable = is_trivially_relocatable<T>::value;
+
+		// The allocator and the inline buffer are bases so that they take no space when empty.
+		struct _Impl : _Alloc, detail::vector_inline_storage<T, _VECTOR_BIN> {
+			_Impl() { reset(); }
+			_Impl(const _Alloc& alloc) : _Alloc(alloc) { reset(); }
+			_Impl(_Alloc&& alloc) : _Alloc(std::move(alloc)) { reset(); }
+			void reset() noexcept {
+				_data = this->inline_data();
+				_size = 0;
+				_capacity = _VECTOR_BIN;
+			}
+			T* _data;
+			size_t _size;
+			size_t _capacity;
+		} _impl;
+
+		bool _on_heap() const noexcept {
+			return _impl._data != const_cast<_Impl&>(_impl).inline_data();
+		}
+
+		// Take other's elements; `this` must be empty and inline.
+		void steal(Vector& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+			if (_VECTOR_BIN == 0 || other._on_heap()) {
+				_impl._data = other._impl._data;
+				_impl._size = other._impl._size;
+				_impl._capacity = other._impl._capacity;
+				other._impl.reset();
+				return;
+			}
+			move_elements(other._impl._data, other._impl._size, _impl._data);
+			_impl._size = other._impl._size;
+			other.destroy(other._impl._data, other._impl._size);
+			other._impl._size = 0;
+		}
+
+		void release() noexcept {
+			destroy(_impl._data, _impl._size);
+			if (_on_heap()) {
+				if constexpr (detail::has_retain<_Alloc>::value) _impl.retain(_impl._data, _impl._size);
+				std::allocator_traits<_Alloc>::deallocate(_impl, _impl._data, _impl._capacity);
+			}
+			_impl.reset();
+		}
+
+		// Move-construct count elements into raw storage at dst; the sources stay alive.
+		static void move_elements(T* src, size_t count, T* dst) {
+			if constexpr (_relocatable) {
+				if (count) std::memcpy(static_cast<void*>(dst), src, count * sizeof(T));
+			}
+			else {
+				size_t i = 0;
+				try {
+					for (; i < count; ++i) {
+						::new (static_cast<void*>(dst + i)) T(std::move_if_noexcept(src[i]));
+					}
+				}
+				catch (...) {
+					destroy(dst, i);
+					throw;
+				}
+			}
+		}
+
+		static void destroy(T* first, size_t count) noexcept {
+			if constexpr (!std::is_trivially_destructible<T>::value) {
+				for (size_t i = 0; i < count; ++i) first[i].~T();
+			}
+		}
+
+		static void copy_construct(const T* src, size_t count, T* dst) {
+			if constexpr (simd::is_vectorizable<T>::value) {
+				simd::copy(dst, src, count);
+			}
+			else if constexpr (std::is_trivially_copyable<T>::value) {
+				if (count) std::memcpy(static_cast<void*>(dst), src, count * sizeof(T));
+			}
+			else {
+				std::uninitialized_copy(src, src + count, dst);
+			}
+		}
+
+		void grow(size_t required) {
+			relocate(_Growth::next_capacity(_impl._capacity, required, sizeof(T)));
+		}
+
+		// Move the elements into a block of exactly `capacity` elements, or back into
+		// the inline buffer when they fit there.
+		void relocate(size_t capacity) {
+			const bool heap = _on_heap();
+			const bool to_inline = _VECTOR_BIN != 0 && capacity <= _VECTOR_BIN;
+			if constexpr (_relocatable && detail::has_reallocate<_Alloc>::value) {
+				if (heap && !to_inline) {
+					_impl._data = _impl.reallocate(_impl._data, _impl._capacity, capacity);
+					_impl._capacity = capacity;
+					return;
+				}
+			}
+			T* block = to_inline ? _impl.inline_data() : std::allocator_traits<_Alloc>::allocate(_impl, capacity);
+			try {
+				move_elements(_impl._data, _impl._size, block);
+			}
+			catch (...) {
+				if (!to_inline) std::allocator_traits<_Alloc>::deallocate(_impl, block, capacity);
+				throw;
+			}
+			if constexpr (!_relocatable) destroy(_impl._data, _impl._size);
+			if (heap) std::allocator_traits<_Alloc>::deallocate(_impl, _impl._data, _impl._capacity);
+			_impl._data = block;
+			_impl._capacity = to_inline ? _VECTOR_BIN : capacity;
+		}
 	};
-}
\ No newline at end of file
+
+	template<typename T, size_t _VECTOR_BIN, typename _Alloc, typename _Growth>
+	void swap(Vector<T, _VECTOR_BIN, _Alloc, _Growth>& a, Vector<T, _VECTOR_BIN, _Alloc, _Growth>& b)
+		noexcept(noexcept(a.swap(b))) { a.swap(b); }
+}
@@ -0,0 +1,321 @@
+/**
+ * @file cnt/asyncconsole.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio),
+ * and according to the project license (MIT license) agreement,
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team.
+ * At the same time,
+ * project and documents can be used for commercial purposes under the condition of informing the development source,
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time,
+ * and any form of dispute event, CNT Development Team.
+ * and APlcexicesetrl shall not be liable for any damages,
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+ /* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__) || defined(__unix__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <climits>
+#endif
+
+#include "loggings.h"
+
+#ifdef ERROR
+#define _CNT_ASYNCCONSOLE_SAVED_ERROR_DEFINE_ ERROR
+#undef ERROR
+#endif
+
+namespace cnt
+{
+    /*
+     * Console sink that never blocks the logging thread on a slow terminal.
+     *
+     * write() only appends to a bounded in-memory queue; a dedicated thread
+     * drains it into a non-blocking descriptor, coalescing queued lines into
+     * writev() batches and waiting in poll() when the terminal pushes back.
+     *
+     * When the queue fills up output degrades by level: DEBUG and INFO are
+     * dropped once the queue is `degradeAt` full, WARNING once it is full, and
+     * ERROR/CRITICAL are always queued (they may overrun the capacity). Each
+     * dropped run is reported by a single summary line.
+     *
+     * The descriptor is switched to O_NONBLOCK for the lifetime of the sink.
+     * That flag is shared with every other user of the same open file, so
+     * disable the logger's direct console output (enableConsoleOutput(false))
+     * when this sink owns stdout.
+     */
+    class AsyncConsoleSink : public LogSink
+    {
+    public:
+        struct Options
+        {
+            size_t queueCapacity = 8192;     // queued lines
+            double degradeAt = 0.75;         // fraction of capacity where DEBUG/INFO start dropping
+            size_t maxBatch = 256;           // lines per writev()
+            bool color = true;
+            std::chrono::milliseconds shutdownTimeout{2000};
+#if !defined(_WIN32)
+            int fd = STDOUT_FILENO;
+#endif
+        };
+
+        struct Stats
+        {
+            uint64_t queued = 0;
+            uint64_t written = 0;
+            uint64_t dropped[5] = {0, 0, 0, 0, 0};  // by LogLevel
+            uint64_t writeCalls = 0;
+        };
+
+        AsyncConsoleSink() : AsyncConsoleSink(Options()) {}
+
+        explicit AsyncConsoleSink(const Options& options)
+            : options_(options)
+        {
+            if (options_.queueCapacity == 0) options_.queueCapacity = 1;
+            if (options_.maxBatch == 0) options_.maxBatch = 1;
+            queue_.reserve(options_.queueCapacity);
+            batch_.reserve(options_.queueCapacity);
+#if defined(_WIN32)
+            handle_ = GetStdHandle(STD_OUTPUT_HANDLE);
+#else
+            fd_ = options_.fd;
+            savedFlags_ = fcntl(fd_, F_GETFL);
+            if (savedFlags_ != -1) fcntl(fd_, F_SETFL, savedFlags_ | O_NONBLOCK);
+#endif
+            writer_ = std::thread([this] { run(); });
+        }
+
+        ~AsyncConsoleSink() override
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            writer_.join();
+#if !defined(_WIN32)
+            if (savedFlags_ != -1) fcntl(fd_, F_SETFL, savedFlags_);
+#endif
+        }
+
+        AsyncConsoleSink(const AsyncConsoleSink&) = delete;
+        AsyncConsoleSink& operator=(const AsyncConsoleSink&) = delete;
+
+        void write(LogLevel level, const std::string& message) override
+        {
+            std::string line;
+            const char* color = options_.color ? colorCode(level) : nullptr;
+            if (color) {
+                line.reserve(message.size() + 16);
+                line += color;
+                line += message;
+                line += "\033[0m";
+            }
+            else {
+                line = message;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                const size_t size = queue_.size();
+                bool keep;
+                switch (level) {
+                case LogLevel::DEBUG:
+                case LogLevel::INFO:
+                    keep = size < static_cast<size_t>(options_.queueCapacity * options_.degradeAt);
+                    break;
+                case LogLevel::WARNING:
+                    keep = size < options_.queueCapacity;
+                    break;
+                default:
+                    keep = true;
+                    break;
+                }
+                if (!keep) {
+                    ++stats_.dropped[static_cast<int>(level)];
+                    ++pendingDrops_[static_cast<int>(level)];
+                    return;
+                }
+                queue_.push_back(std::move(line));
+                ++stats_.queued;
+            }
+            wake_.notify_one();
+        }
+
+        // Wait until everything queued so far has been handed to the terminal.
+        void flush() override
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            const uint64_t target = stats_.queued;
+            drained_.wait_for(lock, options_.shutdownTimeout, [&] { return stats_.written >= target; });
+        }
+
+        Stats getStats() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Stats stats = stats_;
+            stats.writeCalls = writeCalls_.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    private:
+        static const char* colorCode(LogLevel level)
+        {
+            switch (level) {
+            case LogLevel::DEBUG: return "\033[36m";
+            case LogLevel::INFO: return "\033[32m";
+            case LogLevel::WARNING: return "\033[33m";
+            case LogLevel::ERROR: return "\033[31m";
+            case LogLevel::CRITICAL: return "\033[35m";
+            default: return nullptr;
+            }
+        }
+
+        std::string dropSummary()
+        {
+            static const char* names[5] = {"DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL"};
+            std::string summary;
+            for (int i = 0; i < 5; ++i) {
+                if (!pendingDrops_[i]) continue;
+                summary += summary.empty() ? "[console] output too slow, dropped " : ", ";
+                summary += std::to_string(pendingDrops_[i]);
+                summary += ' ';
+                summary += names[i];
+                pendingDrops_[i] = 0;
+            }
+            if (!summary.empty()) summary += " lines\n";
+            return summary;
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            std::chrono::steady_clock::time_point deadline{};
+            for (;;) {
+                wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (queue_.empty() && stopping_) break;
+                if (stopping_ && deadline == std::chrono::steady_clock::time_point{}) {
+                    deadline = std::chrono::steady_clock::now() + options_.shutdownTimeout;
+                }
+
+                batch_.swap(queue_);
+                std::string summary = dropSummary();
+                lock.unlock();
+
+                // The summary line is not part of stats_.queued, so it must not count as written.
+                const size_t lines = batch_.size();
+                if (!summary.empty()) batch_.insert(batch_.begin(), std::move(summary));
+                const bool complete = writeBatch(deadline);
+                batch_.clear();
+
+                lock.lock();
+                stats_.written += complete ? lines : 0;
+                if (!complete) {
+                    // Shutdown deadline passed with the terminal still stalled.
+                    stats_.written = stats_.queued;
+                    queue_.clear();
+                }
+                drained_.notify_all();
+            }
+            stats_.written = stats_.queued;
+            drained_.notify_all();
+        }
+
+        // Returns false if the shutdown deadline expired before the batch was written.
+        bool writeBatch(std::chrono::steady_clock::time_point deadline)
+        {
+#if defined(_WIN32)
+            for (const auto& line : batch_) {
+                DWORD n = 0;
+                WriteFile(handle_, line.data(), static_cast<DWORD>(line.size()), &n, nullptr);
+            }
+            writeCalls_.fetch_add(1, std::memory_order_relaxed);
+            (void)deadline;
+            return true;
+#else
+            size_t index = 0;   // first line not fully written
+            size_t offset = 0;  // bytes of batch_[index] already written
+            std::vector<struct iovec>& iov = iov_;
+            while (index < batch_.size()) {
+                iov.clear();
+                const size_t limit = std::min(options_.maxBatch, static_cast<size_t>(IOV_MAX));
+                for (size_t i = index; i < batch_.size() && iov.size() < limit; ++i) {
+                    const std::string& line = batch_[i];
+                    const size_t skip = (i == index) ? offset : 0;
+                    iov.push_back({const_cast<char*>(line.data()) + skip, line.size() - skip});
+                }
+
+                ssize_t n = ::writev(fd_, iov.data(), static_cast<int>(iov.size()));
+                writeCalls_.fetch_add(1, std::memory_order_relaxed);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) return true;  // terminal gone; discard
+                    if (deadline != std::chrono::steady_clock::time_point{} &&
+                        std::chrono::steady_clock::now() >= deadline) {
+                        return false;
+                    }
+                    struct pollfd pfd = {fd_, POLLOUT, 0};
+                    ::poll(&pfd, 1, 100);
+                    continue;
+                }
+
+                size_t done = static_cast<size_t>(n);
+                while (index < batch_.size() && done >= batch_[index].size() - offset) {
+                    done -= batch_[index].size() - offset;
+                    offset = 0;
+                    ++index;
+                }
+                offset += done;
+            }
+            return true;
+#endif
+        }
+
+        Options options_;
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable drained_;
+        std::vector<std::string> queue_;
+        std::vector<std::string> batch_;
+        uint64_t pendingDrops_[5] = {0, 0, 0, 0, 0};
+        Stats stats_;
+        bool stopping_ = false;
+        std::thread writer_;
+#if defined(_WIN32)
+        HANDLE handle_ = INVALID_HANDLE_VALUE;
+#else
+        int fd_ = STDOUT_FILENO;
+        int savedFlags_ = -1;
+        std::vector<struct iovec> iov_;
+#endif
+        std::atomic<uint64_t> writeCalls_{0};
+    };
+
+} // namespace cnt
+
+#ifdef _CNT_ASYNCCONSOLE_SAVED_ERROR_DEFINE_
+#define ERROR _CNT_ASYNCCONSOLE_SAVED_ERROR_DEFINE_
+#undef _CNT_ASYNCCONSOLE_SAVED_ERROR_DEFINE_
+#endif
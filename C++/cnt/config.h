@@ -19,13 +19,42 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <cstdint>
 #include <algorithm>
+#include <iterator>
+#include <cstddef>
 #include <stdexcept>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <random>
+#include <thread>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "instrument.h"
+#include "crc32c.h"
 
 //#include <cnt/lockskey.h>
 
@@ -37,21 +66,502 @@ namespace cnt {
         bool operator==(const ConfigObject& other) const {
             return (name == other.name) && (value == other.value);
         }
+    };
 
-        ConfigObject& operator=(const ConfigObject& other) {
-            if (this != &other) {
-                name = other.name;
-                value = other.value;
+    /*
+     * Zero-copy view over the entries of a ConfigManager whose names share a
+     * prefix, in name order. It refers to the manager's storage and is valid
+     * until the manager is next modified.
+     */
+    class ConfigView {
+    public:
+        class const_iterator {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = ConfigObject;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const ConfigObject*;
+            using reference = const ConfigObject&;
+
+            const_iterator() = default;
+            const_iterator(const ConfigObject* base, const uint32_t* pos) : base_(base), pos_(pos) {}
+
+            reference operator*() const { return base_[*pos_]; }
+            pointer operator->() const { return base_ + *pos_; }
+            reference operator[](difference_type n) const { return base_[pos_[n]]; }
+            const_iterator& operator++() { ++pos_; return *this; }
+            const_iterator operator++(int) { const_iterator tmp = *this; ++pos_; return tmp; }
+            const_iterator& operator--() { --pos_; return *this; }
+            const_iterator operator--(int) { const_iterator tmp = *this; --pos_; return tmp; }
+            const_iterator& operator+=(difference_type n) { pos_ += n; return *this; }
+            const_iterator& operator-=(difference_type n) { pos_ -= n; return *this; }
+            const_iterator operator+(difference_type n) const { return const_iterator(base_, pos_ + n); }
+            const_iterator operator-(difference_type n) const { return const_iterator(base_, pos_ - n); }
+            difference_type operator-(const const_iterator& other) const { return pos_ - other.pos_; }
+            bool operator==(const const_iterator& other) const { return pos_ == other.pos_; }
+            bool operator!=(const const_iterator& other) const { return pos_ != other.pos_; }
+            bool operator<(const const_iterator& other) const { return pos_ < other.pos_; }
+
+        private:
+            const ConfigObject* base_ = nullptr;
+            const uint32_t* pos_ = nullptr;
+        };
+
+        ConfigView() = default;
+        ConfigView(const ConfigObject* base, const uint32_t* first, const uint32_t* last, size_t strip)
+            : base_(base), first_(first), last_(last), strip_(strip) {}
+
+        const_iterator begin() const { return const_iterator(base_, first_); }
+        const_iterator end() const { return const_iterator(base_, last_); }
+        size_t size() const { return static_cast<size_t>(last_ - first_); }
+        bool empty() const { return first_ == last_; }
+        const ConfigObject& operator[](size_t i) const { return base_[first_[i]]; }
+
+        // Name with the view's prefix removed ("db.primary.host" -> "primary.host" in subtree("db")).
+        std::string_view relativeName(const ConfigObject& obj) const {
+            return std::string_view(obj.name).substr(std::min(strip_, obj.name.size()));
+        }
+
+    private:
+        const ConfigObject* base_ = nullptr;
+        const uint32_t* first_ = nullptr;
+        const uint32_t* last_ = nullptr;
+        size_t strip_ = 0;
+    };
+
+    // How saveText()/saveBinary() put the file on disk.
+    struct SaveOptions {
+        // Write "<file>.tmp" and rename it over the target, so readers and
+        // crashes see either the old file or the new one, never a torn one.
+        bool atomic = true;
+        // fsync the data (and, on POSIX, the directory entry) before returning.
+        bool sync = false;
+        // Records are encoded into a buffer of this size and written in chunks
+        // of it; memory use does not grow with the size of the config.
+        size_t buffer_size = 64 * 1024;
+    };
+
+    namespace detail {
+        inline uint64_t fnv1a64(const void* data, size_t len, uint64_t hash = 0xcbf29ce484222325ull) {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < len; ++i) hash = (hash ^ p[i]) * 0x100000001b3ull;
+            return hash;
+        }
+
+        // .cntconfigbin:
+        //   "CNTCFGB2"
+        //   blocks of [u32 size][u32 CRC-32C of the stored bytes][stored bytes]
+        //   a last block, flagged BINARY_LAST_BLOCK in its size, holding the u64 entry count
+        // The stored bytes are the records ([u32 length][name][u32 length][value])
+        // XOR 0xBB; a record may continue in the next block. Files without the
+        // magic are the original format, the bare record stream with no check.
+        constexpr char BINARY_MAGIC[8] = {'C', 'N', 'T', 'C', 'F', 'G', 'B', '2'};
+        constexpr uint32_t BINARY_LAST_BLOCK = 0x80000000u;
+        constexpr size_t BINARY_BLOCK_HEADER = 8;
+        constexpr uint8_t BINARY_KEY = 0xBB;
+
+        // Identifies a snapshot for its journal: CRC-32C and size.
+        inline uint64_t snapshotId(uint32_t crc, uint64_t size) {
+            return (static_cast<uint64_t>(crc) << 32) | (size & 0xffffffffu);
+        }
+
+        inline uint64_t snapshotId(const std::string& raw) {
+            return snapshotId(crc32c::value(raw.data(), raw.size()), raw.size());
+        }
+
+#if defined(_WIN32)
+        inline bool syncFile(std::FILE* f) { return _commit(_fileno(f)) == 0; }
+        inline bool replaceFile(const std::string& from, const std::string& to) {
+            return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+        }
+        inline void syncDirectory(const std::string&) {}
+#else
+        inline bool syncFile(std::FILE* f) { return fsync(fileno(f)) == 0; }
+        inline bool replaceFile(const std::string& from, const std::string& to) {
+            return std::rename(from.c_str(), to.c_str()) == 0;
+        }
+        // Makes a rename in the file's directory durable.
+        inline void syncDirectory(const std::string& path) {
+            size_t slash = path.find_last_of('/');
+            std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+            int fd = ::open(dir.c_str(), O_RDONLY);
+            if (fd < 0) return;
+            fsync(fd);
+            ::close(fd);
+        }
+#endif
+
+        inline bool readWholeFile(const std::string& path, std::string& out) {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file) return false;
+            std::streamsize size = file.tellg();
+            file.seekg(0);
+            out.assign(static_cast<size_t>(size), '\0');
+            return size == 0 || static_cast<bool>(file.read(&out[0], size));
+        }
+
+        class ConfigFileWriter {
+        public:
+            ConfigFileWriter(const std::string& path, const SaveOptions& options)
+                : path_(path), target_(options.atomic ? path + ".tmp" : path), sync_(options.sync) {
+                buffer_.resize(std::max<size_t>(options.buffer_size, 4096));
+                file_ = std::fopen(target_.c_str(), "wb");
+                if (file_) std::setvbuf(file_, nullptr, _IONBF, 0);
+            }
+
+            ~ConfigFileWriter() {
+                if (file_) std::fclose(file_);
+                if ((file_ || finished_) && target_ != path_) std::remove(target_.c_str());
+            }
+
+            ConfigFileWriter(const ConfigFileWriter&) = delete;
+            ConfigFileWriter& operator=(const ConfigFileWriter&) = delete;
+
+            bool isOpen() const { return file_ != nullptr; }
+
+            // snapshotId() of everything written, for callers that need to identify the file.
+            void trackChecksum() { track_ = true; }
+            uint64_t checksum() const { return snapshotId(checksum_, bytes_); }
+            uint64_t bytes() const { return bytes_; }
+
+            // From here on every buffer's worth of data goes out as one
+            // checksummed block (see BINARY_MAGIC); endBlocks() writes the
+            // last block.
+            void beginBlocks() {
+                drain();
+                framed_ = true;
+                used_ = BINARY_BLOCK_HEADER;
+            }
+
+            void endBlocks(uint64_t count) {
+                drain();
+                framed_ = false;
+                used_ = 0;
+                uint32_t header[2] = {static_cast<uint32_t>(sizeof(count)) | BINARY_LAST_BLOCK,
+                                      crc32c::value(&count, sizeof(count))};
+                put(header, sizeof(header));
+                put(&count, sizeof(count));
+            }
+
+            // Appends data, XOR-ed with mask on the way (0 leaves it as is).
+            void put(const void* data, size_t len, uint8_t mask = 0) {
+                const char* src = static_cast<const char*>(data);
+                while (len) {
+                    if (used_ == buffer_.size()) drain();
+                    size_t n = std::min(len, buffer_.size() - used_);
+                    char* dst = buffer_.data() + used_;
+                    std::memcpy(dst, src, n);
+                    if (mask) {
+                        for (size_t i = 0; i < n; ++i) dst[i] = static_cast<char>(dst[i] ^ mask);
+                    }
+                    used_ += n;
+                    src += n;
+                    len -= n;
+                }
+            }
+
+            void put(const std::string& text, uint8_t mask = 0) { put(text.data(), text.size(), mask); }
+
+            // Writes out the rest, syncs if asked and moves the file into place.
+            bool commit() { return finish() && publish(); }
+
+            // The two halves of commit(), for callers that must record the
+            // finished file somewhere before it replaces the old one.
+            bool finish() {
+                if (!file_) return false;
+                drain();
+                bool ok = ok_ && std::fflush(file_) == 0;
+                if (ok && sync_) ok = syncFile(file_);
+                ok = (std::fclose(file_) == 0) && ok;
+                file_ = nullptr;
+                finished_ = ok;
+                if (!ok && target_ != path_) std::remove(target_.c_str());
+                return ok;
+            }
+
+            bool publish() {
+                if (!finished_) return false;
+                finished_ = false;
+                if (target_ == path_) return true;
+                if (!replaceFile(target_, path_)) {
+                    std::remove(target_.c_str());
+                    return false;
+                }
+                if (sync_) syncDirectory(path_);
+                return true;
             }
+
+        private:
+            void drain() {
+                if (framed_) {
+                    if (used_ == BINARY_BLOCK_HEADER) return;
+                    uint32_t header[2] = {static_cast<uint32_t>(used_ - BINARY_BLOCK_HEADER),
+                                          crc32c::value(buffer_.data() + BINARY_BLOCK_HEADER, used_ - BINARY_BLOCK_HEADER)};
+                    std::memcpy(buffer_.data(), header, sizeof(header));
+                }
+                if (used_ && ok_) {
+                    ok_ = std::fwrite(buffer_.data(), 1, used_, file_) == used_;
+                    if (track_) checksum_ = crc32c::extend(checksum_, buffer_.data(), used_);
+                    bytes_ += used_;
+                }
+                used_ = framed_ ? BINARY_BLOCK_HEADER : 0;
+            }
+
+            std::string path_;
+            std::string target_;
+            bool sync_;
+            std::FILE* file_ = nullptr;
+            std::vector<char> buffer_;
+            size_t used_ = 0;
+            bool ok_ = true;
+            bool finished_ = false;
+            bool track_ = false;
+            bool framed_ = false;
+            uint32_t checksum_ = 0;
+            uint64_t bytes_ = 0;
+        };
+
+        // "<file>.journal": a JournalHeader, then records
+        //   [u32 payload length][u32 CRC-32C of op and payload][u8 op][payload]
+        // where the payload is a u32 row (row ops only) followed by
+        // length-prefixed strings. base_checksum names the snapshot the records
+        // apply to. A journal started while its predecessor is being folded
+        // names that predecessor in after_id and gets base_checksum once the
+        // fold has written the new snapshot.
+        struct JournalHeader {
+            char magic[8];
+            uint64_t id;
+            uint64_t base_checksum;
+            uint64_t after_id;
+        };
+        static_assert(sizeof(JournalHeader) == 32, "journal header layout");
+
+        constexpr char JOURNAL_MAGIC[8] = {'C', 'N', 'T', 'J', 'R', 'N', 'L', '2'};
+        constexpr size_t JOURNAL_RECORD_HEADER = 9;
+
+        enum JournalOp : uint8_t {
+            JOURNAL_ADD = 1,
+            JOURNAL_SET,
+            JOURNAL_SET_ROW,
+            JOURNAL_REMOVE_NAME,
+            JOURNAL_REMOVE_VALUE,
+            JOURNAL_REMOVE_ROW,
+            JOURNAL_CLEAR,
+            JOURNAL_BATCH
+        };
+
+        inline uint64_t journalId() {
+            std::random_device device;
+            uint64_t id = (static_cast<uint64_t>(device()) << 32) ^ device();
+            id ^= static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+            return id ? id : 1;
+        }
+
+        inline bool readJournal(const std::string& path, JournalHeader& header, std::string& body) {
+            std::string raw;
+            if (!readWholeFile(path, raw) || raw.size() < sizeof(JournalHeader)) return false;
+            std::memcpy(&header, raw.data(), sizeof(header));
+            if (std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0) return false;
+            body.assign(raw, sizeof(header), std::string::npos);
+            return true;
+        }
+
+        inline bool createJournal(const std::string& path, const JournalHeader& header, bool sync) {
+            std::FILE* f = std::fopen(path.c_str(), "wb");
+            if (!f) return false;
+            bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+            ok = (std::fflush(f) == 0) && ok && (!sync || syncFile(f));
+            return (std::fclose(f) == 0) && ok;
+        }
+
+        inline bool patchJournalBase(const std::string& path, uint64_t base_checksum, bool sync) {
+            std::FILE* f = std::fopen(path.c_str(), "r+b");
+            if (!f) return false;
+            bool ok = std::fseek(f, offsetof(JournalHeader, base_checksum), SEEK_SET) == 0 &&
+                      std::fwrite(&base_checksum, sizeof(base_checksum), 1, f) == 1;
+            ok = (std::fflush(f) == 0) && ok && (!sync || syncFile(f));
+            return (std::fclose(f) == 0) && ok;
+        }
+    }
+
+    // Append-only journal mode; see ConfigManager::openJournal().
+    struct JournalOptions {
+        // Fold the journal into the snapshot once it is larger than this
+        // fraction of the snapshot...
+        double compact_ratio = 0.5;
+        // ...and than this many bytes.
+        size_t compact_min_bytes = 1 << 20;
+        // fsync after every record. Without it records still reach the kernel
+        // before the call returns, so they survive a crash of the process.
+        bool sync = false;
+        // Fold on a worker thread; false folds inline in the mutating call.
+        bool background = true;
+    };
+
+    class ConfigManager;
+
+    /*
+     * Sets and removals collected for ConfigManager::apply(), which folds
+     * them into one change per name and merges those into the entries in a
+     * single pass: every name is looked up once and the storage grows at
+     * most once. The outcome
+     * is that of making the calls in order: set() updates the first entry of
+     * the name or appends one, remove() drops every entry of the name. In
+     * journal mode the batch is a single record, so a crash replays all of it
+     * or none of it.
+     */
+    class ConfigBatch {
+    public:
+        ConfigBatch() = default;
+
+        ConfigBatch& set(std::string_view name, std::string_view value) {
+            ops.push_back({Op::SET, static_cast<uint32_t>(name.size()), static_cast<uint32_t>(value.size()), text.size()});
+            text.append(name.data(), name.size());
+            text.append(value.data(), value.size());
             return *this;
         }
+        ConfigBatch& remove(std::string_view name) {
+            ops.push_back({Op::REMOVE, static_cast<uint32_t>(name.size()), 0, text.size()});
+            text.append(name.data(), name.size());
+            return *this;
+        }
+        // bytes: the names and values to come, when known.
+        void reserve(size_t operations, size_t bytes = 0) {
+            ops.reserve(operations);
+            text.reserve(bytes);
+        }
+        // Applies the batch to the manager that handed it out (ConfigManager::batch()).
+        void commit();
+
+        size_t size() const { return ops.size(); }
+        bool empty() const { return ops.empty(); }
+        void clear() {
+            ops.clear();
+            text.clear();
+        }
+
+    private:
+        friend class ConfigManager;
+
+        enum class Op : uint8_t { SET, REMOVE };
+        // Names and values are kept back to back in one buffer.
+        struct Entry {
+            Op op;
+            uint32_t name_size;
+            uint32_t value_size;
+            size_t at;
+        };
+
+        explicit ConfigBatch(ConfigManager* manager) : target(manager) {}
+
+        std::string_view name(const Entry& op) const {
+            return std::string_view(text.data() + op.at, op.name_size);
+        }
+        std::string_view value(const Entry& op) const {
+            return std::string_view(text.data() + op.at + op.name_size, op.value_size);
+        }
+
+        ConfigManager* target = nullptr;
+        std::vector<Entry> ops;
+        std::string text;
     };
 
     class ConfigManager {
     private:
+        // Slots in insertion order. Removal leaves a tombstone; tombstoned slots
+        // are squeezed out once they outnumber the live ones (or by compact()),
+        // so removals are amortized O(1) and survivors keep their order.
         std::vector<ConfigObject> configs;
+        std::vector<uint8_t> tombstones;    // parallel to configs, empty until the first removal
+        size_t dead_count = 0;
         std::string current_path;
 
+        // Positions in configs ordered by (name, position). The first name_sorted
+        // entries are ordered; appends land in the unsorted tail and are merged
+        // in by the next query. Mutable access to names drops the index, which
+        // is then rebuilt on demand.
+        mutable std::vector<uint32_t> name_index;
+        mutable size_t name_sorted = 0;
+        mutable bool name_index_valid = true;
+        mutable size_t name_index_dead = 0;     // dead_count already filtered out of name_index
+
+        // Hash -> slot indexes for lookups by name and (optionally) by value.
+        // Candidates are confirmed by comparing the strings. Entries handed out
+        // through operator[] or get() are recorded as dirty and re-hashed by the
+        // next call that consults the indexes, so a returned reference may be
+        // written until then; mutable iteration drops both indexes instead.
+        using SlotMap = std::unordered_multimap<size_t, uint32_t>;
+        struct DirtySlot {
+            uint32_t slot;
+            size_t name_hash;
+            size_t value_hash;
+        };
+        mutable SlotMap name_slots;
+        mutable SlotMap value_slots;
+        mutable std::vector<DirtySlot> dirty_slots;
+        mutable bool slots_valid = true;
+        bool value_index = false;
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        static size_t keyHash(std::string_view key) {
+            return std::hash<std::string_view>()(key);
+        }
+        bool isLive(size_t slot) const {
+            return dead_count == 0 || !tombstones[slot];
+        }
+        const uint8_t* deadFlags() const {
+            return dead_count ? tombstones.data() : nullptr;
+        }
+
+        void indexAppend() {
+            if (name_index_valid) name_index.push_back(static_cast<uint32_t>(configs.size() - 1));
+        }
+        void indexInvalidate() {
+            name_index_valid = false;
+            name_index.clear();
+            name_sorted = 0;
+        }
+        void indexRemove(const std::vector<uint32_t>& removed);
+        const std::vector<uint32_t>& nameIndex() const;
+
+        void slotsInvalidate() {
+            slots_valid = false;
+            dirty_slots.clear();
+        }
+        void refreshSlots() const;
+        void markDirty(size_t slot);
+        size_t findSlot(const SlotMap& map, std::string ConfigObject::*field, const std::string& key) const;
+        std::vector<uint32_t> matchSlots(std::string ConfigObject::*field, const std::string& key) const;
+        size_t findName(const std::string& name) const;
+
+        ConfigObject& append(ConfigObject&& obj);
+        void kill(size_t slot);
+        // set() and removeByName() without the journal.
+        void setEntry(const std::string& name, std::string value);
+        bool removeEntries(const std::string& name);
+        void maybeCompact() {
+            if (dead_count > 32 && dead_count * 2 > configs.size()) compact();
+        }
+        void resetStorage();
+        size_t rankOf(size_t slot) const;
+
+        // Journal mode (openJournal()); null otherwise. Moves with the manager, never copied.
+        struct JournalState;
+        std::unique_ptr<JournalState> journal;
+
+        void journalRecord(uint8_t op, const std::string* first, const std::string* second = nullptr, uint32_t row = 0) const;
+        void journalTouch(size_t slot) const;
+        void journalSync() const;
+        void journalCheck() const;
+        void journalFold() const;
+        void journalRotate() const;
+        void journalJoin() const;
+        size_t journalReplay(const std::string& body);
+        static void journalWorker(JournalState* state);
+        static std::string encodeBatch(const ConfigBatch& batch);
+        static bool decodeBatch(const std::string& record, ConfigBatch& batch);
+
         // Helper functions
         std::string trim(const std::string& str);
         std::string unescape(const std::string& str);
@@ -63,38 +573,105 @@ namespace cnt {
         // Binary processing
         static std::string encrypt(const std::string& data);
         static std::string decrypt(const std::string& data);
-        std::string serializeBinary() const;
-        bool deserializeBinary(const std::string& data);
+        void writeBinary(detail::ConfigFileWriter& out) const;
+        bool decodeBinary(std::string& raw);
 
     public:
         // Constructor
         explicit ConfigManager(const std::string& path = "");
+        ConfigManager(const ConfigManager& other);
+        ConfigManager(ConfigManager&& other) noexcept;
+        ~ConfigManager();
         
+        // Forward iterator over the live entries in insertion order.
+        template <typename Obj>
+        class SlotIterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = ConfigObject;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Obj*;
+            using reference = Obj&;
+
+            SlotIterator() = default;
+            SlotIterator(Obj* pos, Obj* end, const uint8_t* dead) : pos_(pos), end_(end), dead_(dead) { skip(); }
+            template <typename Other, typename = std::enable_if_t<std::is_same_v<const Other, Obj> && !std::is_same_v<Other, Obj>>>
+            SlotIterator(const SlotIterator<Other>& other) : pos_(other.pos_), end_(other.end_), dead_(other.dead_) {}
+
+            reference operator*() const { return *pos_; }
+            pointer operator->() const { return pos_; }
+            SlotIterator& operator++() { ++pos_; if (dead_) ++dead_; skip(); return *this; }
+            SlotIterator operator++(int) { SlotIterator tmp = *this; ++*this; return tmp; }
+            bool operator==(const SlotIterator& other) const { return pos_ == other.pos_; }
+            bool operator!=(const SlotIterator& other) const { return pos_ != other.pos_; }
+
+        private:
+            template <typename> friend class SlotIterator;
+
+            void skip() {
+                if (!dead_) return;
+                while (pos_ != end_ && *dead_) { ++pos_; ++dead_; }
+            }
+
+            Obj* pos_ = nullptr;
+            Obj* end_ = nullptr;
+            const uint8_t* dead_ = nullptr;
+        };
+
         // Iterator support (required for C  11 range-based for loop) 
-        using iterator = std::vector<ConfigObject>::iterator;
-        using const_iterator = std::vector<ConfigObject>::const_iterator;
-        iterator begin() noexcept { return configs.begin(); }
-        iterator end() noexcept { return configs.end(); }
-        const_iterator begin() const noexcept { return configs.begin(); }
-        const_iterator end() const noexcept { return configs.end(); }
+        using iterator = SlotIterator<ConfigObject>;
+        using const_iterator = SlotIterator<const ConfigObject>;
+        // Mutable iteration may rename entries, so it drops the name and value
+        // indexes, and in journal mode the next mutation folds the journal.
+        iterator begin() noexcept {
+            indexInvalidate();
+            slotsInvalidate();
+            if (journal) journalTouch(npos);
+            return iterator(configs.data(), configs.data() + configs.size(), deadFlags());
+        }
+        iterator end() noexcept {
+            indexInvalidate();
+            slotsInvalidate();
+            if (journal) journalTouch(npos);
+            ConfigObject* last = configs.data() + configs.size();
+            return iterator(last, last, nullptr);
+        }
+        const_iterator begin() const noexcept {
+            return const_iterator(configs.data(), configs.data() + configs.size(), deadFlags());
+        }
+        const_iterator end() const noexcept {
+            const ConfigObject* last = configs.data() + configs.size();
+            return const_iterator(last, last, nullptr);
+        }
         
 		// Overload
         ConfigManager& operator=(const ConfigManager& other) {
             if (this != &other) {
                 configs = other.configs;
+                tombstones = other.tombstones;
+                dead_count = other.dead_count;
                 current_path = other.current_path;
+                value_index = other.value_index;
+                indexInvalidate();
+                slotsInvalidate();
+                if (journal) journalTouch(npos);
             }
             return *this;
         }
+        // Closes this manager's journal first; the other one's journal moves over.
+        ConfigManager& operator=(ConfigManager&& other);
 
         std::string& operator[](const std::string& name) {
-            for (auto& obj : configs) {
-                if (obj.name == name) {
-                    return obj.value;
-                }
+            CNT_SCOPED_TIMER("config.lookup");
+            size_t slot = findName(name);
+            if (slot == npos) {
+                append({name, ""});
+                slot = configs.size() - 1;
+                if (journal) journalRecord(detail::JOURNAL_ADD, &name, &configs[slot].value);
             }
-            configs.push_back({name, ""});
-            return configs.back().value;
+            if (value_index) markDirty(slot);
+            if (journal) journalTouch(slot);
+            return configs[slot].value;
         }
         
         ConfigObject& operator[](const size_t row) {
@@ -102,41 +679,101 @@ namespace cnt {
         }
 
         const std::string& operator[](const std::string& name) const {
-            for (const auto& obj : configs) {
-                if (obj.name == name) {
-                    return obj.value;
-                }
-            }
-            throw std::out_of_range("Key not found: " + name);
+            CNT_SCOPED_TIMER("config.lookup");
+            size_t slot = findName(name);
+            if (slot == npos) throw std::out_of_range("Key not found: " + name);
+            return configs[slot].value;
         }
 
         // File operations
         bool loadText(const std::string& filename);
-        bool saveText(const std::string& filename) const;
+        bool saveText(const std::string& filename, const SaveOptions& options = SaveOptions()) const;
         bool loadBinary(const std::string& filename);
-        bool saveBinary(const std::string& filename) const;
+        bool saveBinary(const std::string& filename, const SaveOptions& options = SaveOptions()) const;
         bool loadFile(const std::string& filename);
 
         // Configuration operations
         void add(const ConfigObject& obj);
         void add(const std::string& name, const std::string& value);
+        // operator[](name) = value, recorded at once in journal mode.
+        void set(const std::string& name, const std::string& value);
         bool removeByName(const std::string& name);
         bool removeByValue(const std::string& value);
         bool removeByIndex(size_t index);
         void clear();
 
+        // Many sets and removals at once; see ConfigBatch. apply() performs
+        // all of the batch and empties it or, if it throws, none of it and
+        // leaves the batch as it was.
+        ConfigBatch batch() { return ConfigBatch(this); }
+        void apply(ConfigBatch& batch);
+
+        // Reclaims the slots of removed entries now rather than when they
+        // outnumber the live ones. Row numbers are positions among live entries
+        // either way; get() and removeByIndex() compact first when needed.
+        void compact();
+
+        // Reverse index for getName() and removeByValue(). Off by default: it
+        // costs a hash entry per key and a re-hash after every mutable access.
+        void enableValueIndex(bool enable = true);
+        bool valueIndexEnabled() const { return value_index; }
+
+        // Journal mode: loads the .cntconfigbin snapshot (created empty if
+        // missing), replays "<file>.journal" on top of it and from then on
+        // appends every add/set/remove/clear to the journal instead of
+        // rewriting the snapshot. Once the journal outgrows
+        // options.compact_ratio of the snapshot it is folded into a new
+        // snapshot, by default on a worker thread while mutations go to a
+        // fresh journal. Values written through references from operator[]
+        // or get() are recorded by the next mutation or flushJournal(); mutable
+        // iteration or loading another file is captured by folding.
+        // saveBinary() to the journaled file folds the journal as well.
+        // Throws std::runtime_error on I/O failure.
+        void openJournal(const std::string& filename, const JournalOptions& options = JournalOptions());
+        void flushJournal();
+        // Folds the journal into the snapshot now, waiting for the result.
+        void compactJournal();
+        // Records pending reference writes and waits for a running fold.
+        void closeJournal();
+        bool journaling() const { return journal != nullptr; }
+
         // Query methods
         std::string getValue(const std::string& name) const;
         std::string getName(const std::string& value) const;
         ConfigObject& get(size_t index);
         bool contains(const std::string& name) const;
         size_t size() const;
+
+        // Prefix queries, served from a sorted name index.
+        // scan("db.pri") matches any name starting with the text "db.pri";
+        // subtree("db") (or "db.") matches the names below the "db." namespace
+        // and reports them relative to it.
+        ConfigView scan(std::string_view prefix) const;
+        ConfigView subtree(std::string_view prefix) const;
     };
 
     // ============== Implementation ==============
 
+    // Journal mode state
+    struct ConfigManager::JournalState {
+        std::string base_path;
+        std::string journal_path;
+        std::string compacting_path;    // a journal being folded by the worker
+        JournalOptions options;
+        std::FILE* file = nullptr;
+        uint64_t id = 0;
+        uint64_t journal_bytes = 0;
+        uint64_t base_bytes = 0;
+        std::vector<uint32_t> touched;  // slots handed out through references
+        bool rewrite = false;           // changed in ways only a fold captures
+        std::thread worker;
+        std::atomic<bool> worker_done{true};
+        std::atomic<bool> worker_failed{false};
+        std::atomic<uint64_t> folded_bytes{0};
+    };
+
     // Constructor
-    ConfigManager::ConfigManager(const std::string& path) {
+    inline ConfigManager::ConfigManager(const std::string& path) {
     	try
 		{
         	if (!path.empty()) 
@@ -150,15 +787,66 @@ namespace cnt {
 		}
     }
 
+    inline ConfigManager::ConfigManager(const ConfigManager& other)
+        : configs(other.configs), tombstones(other.tombstones), dead_count(other.dead_count),
+          current_path(other.current_path), name_index(other.name_index), name_sorted(other.name_sorted),
+          name_index_valid(other.name_index_valid), name_index_dead(other.name_index_dead),
+          name_slots(other.name_slots), value_slots(other.value_slots), dirty_slots(other.dirty_slots),
+          slots_valid(other.slots_valid), value_index(other.value_index) {
+    }
+
+    // The journal worker only sees the JournalState, so moving the pointer is enough.
+    inline ConfigManager::ConfigManager(ConfigManager&& other) noexcept
+        : configs(std::move(other.configs)), tombstones(std::move(other.tombstones)), dead_count(other.dead_count),
+          current_path(std::move(other.current_path)), name_index(std::move(other.name_index)),
+          name_sorted(other.name_sorted), name_index_valid(other.name_index_valid),
+          name_index_dead(other.name_index_dead), name_slots(std::move(other.name_slots)),
+          value_slots(std::move(other.value_slots)), dirty_slots(std::move(other.dirty_slots)),
+          slots_valid(other.slots_valid), value_index(other.value_index), journal(std::move(other.journal)) {
+        other.resetStorage();
+        other.current_path.clear();
+    }
+
+    inline ConfigManager& ConfigManager::operator=(ConfigManager&& other) {
+        if (this != &other) {
+            closeJournal();
+            configs = std::move(other.configs);
+            tombstones = std::move(other.tombstones);
+            dead_count = other.dead_count;
+            current_path = std::move(other.current_path);
+            name_index = std::move(other.name_index);
+            name_sorted = other.name_sorted;
+            name_index_valid = other.name_index_valid;
+            name_index_dead = other.name_index_dead;
+            name_slots = std::move(other.name_slots);
+            value_slots = std::move(other.value_slots);
+            dirty_slots = std::move(other.dirty_slots);
+            slots_valid = other.slots_valid;
+            value_index = other.value_index;
+            journal = std::move(other.journal);
+            other.resetStorage();
+            other.current_path.clear();
+        }
+        return *this;
+    }
+
+    inline ConfigManager::~ConfigManager() {
+        try {
+            closeJournal();
+        }
+        catch (const std::exception&) {
+        }
+    }
+
     // File extension validation
-    bool ConfigManager::validateExtension(const std::string& filename, const std::string& expected) const {
+    inline bool ConfigManager::validateExtension(const std::string& filename, const std::string& expected) const {
         size_t dot_pos = filename.find_last_of('.');
         if (dot_pos == std::string::npos) return false;
         return filename.substr(dot_pos) == expected;
     }
 
     // Trim whitespace
-    std::string ConfigManager::trim(const std::string& str) {
+    inline std::string ConfigManager::trim(const std::string& str) {
         size_t first = str.find_first_not_of(" \t");
         if (first == std::string::npos) return "";
         size_t last = str.find_last_not_of(" \t");
@@ -166,7 +854,7 @@ namespace cnt {
     }
 
     // Parse configuration line
-    ConfigObject ConfigManager::parseLine(const std::string& line) {
+    inline ConfigObject ConfigManager::parseLine(const std::string& line) {
         ConfigObject obj;
         std::string trimmed = trim(line);
         if (trimmed.empty() || trimmed[0] == '#') return obj;
@@ -180,7 +868,7 @@ namespace cnt {
     }
 
     // Encryption/Decryption
-    std::string ConfigManager::encrypt(const std::string& data) {
+    inline std::string ConfigManager::encrypt(const std::string& data) {
     	const uint8_t key = 0xBB;
         std::string result = data;
         std::transform(result.begin(), result.end(), result.begin(),
@@ -188,48 +876,105 @@ namespace cnt {
         return result;	
     }
 
-    std::string ConfigManager::decrypt(const std::string& data) {
+    inline std::string ConfigManager::decrypt(const std::string& data) {
         return encrypt(data); 
 	}
 
     // Binary serialization
-    std::string ConfigManager::serializeBinary() const {
-        std::ostringstream oss(std::ios::binary);
-        for (const auto& obj : configs) {
+    inline void ConfigManager::writeBinary(detail::ConfigFileWriter& out) const {
+        const uint8_t key = detail::BINARY_KEY;   // same stream encrypt() produces, one record at a time
+        out.put(detail::BINARY_MAGIC, sizeof(detail::BINARY_MAGIC));
+        out.beginBlocks();
+        uint64_t count = 0;
+        for (const auto& obj : *this) {
             uint32_t name_len = obj.name.size();
-            oss.write(reinterpret_cast<const char*>(&name_len), sizeof(name_len));
-            oss.write(obj.name.c_str(), name_len);
+            out.put(&name_len, sizeof(name_len), key);
+            out.put(obj.name, key);
 
             uint32_t value_len = obj.value.size();
-            oss.write(reinterpret_cast<const char*>(&value_len), sizeof(value_len));
-            oss.write(obj.value.c_str(), value_len);
+            out.put(&value_len, sizeof(value_len), key);
+            out.put(obj.value, key);
+            ++count;
         }
-        return oss.str();
+        out.endBlocks(count);
     }
 
-    bool ConfigManager::deserializeBinary(const std::string& data) {
-        std::istringstream iss(data, std::ios::binary);
-        configs.clear();
-
-        while (iss) {
-            uint32_t name_len, value_len;
-            if (!iss.read(reinterpret_cast<char*>(&name_len), sizeof(name_len))) break;
-
-            std::string name(name_len, '\0');
-            if (!iss.read(&name[0], name_len)) return false;
-
-            if (!iss.read(reinterpret_cast<char*>(&value_len), sizeof(value_len))) return false;
-
-            std::string value(value_len, '\0');
-            if (!iss.read(&value[0], value_len)) return false;
+    // Decodes a whole .cntconfigbin image in place. Each block is checked,
+    // decrypted to the front of raw and parsed while it is still in cache.
+    // On any failure the manager is left unchanged.
+    inline bool ConfigManager::decodeBinary(std::string& raw) {
+        CNT_SCOPED_TIMER("config.decodeBinary");
+        std::vector<ConfigObject> entries;
+        char* data = &raw[0];
+        size_t decoded = 0;   // plain records at the front of raw
+        size_t parsed = 0;
+        const auto parse = [&] {
+            while (decoded - parsed >= 4) {
+                uint32_t name_len, value_len;
+                std::memcpy(&name_len, data + parsed, sizeof(name_len));
+                if (decoded - parsed - 4 < uint64_t(name_len) + 4) return;
+                std::memcpy(&value_len, data + parsed + 4 + name_len, sizeof(value_len));
+                const uint64_t size = uint64_t(8) + name_len + value_len;
+                if (decoded - parsed < size) return;
+                entries.push_back({std::string(data + parsed + 4, name_len), std::string(data + parsed + 8 + name_len, value_len)});
+                parsed += size;
+            }
+        };
+        // Blocks only ever move towards the front, by at least eight bytes.
+        const auto decrypt_to = [](char* dst, const char* src, size_t n) {
+            const uint64_t mask = 0x0101010101010101ull * detail::BINARY_KEY;
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                uint64_t word;
+                std::memcpy(&word, src + i, 8);
+                word ^= mask;
+                std::memcpy(dst + i, &word, 8);
+            }
+            for (; i < n; ++i) dst[i] = static_cast<char>(src[i] ^ detail::BINARY_KEY);
+        };
 
-            configs.push_back({std::move(name), std::move(value)});
+        if (raw.size() < sizeof(detail::BINARY_MAGIC) ||
+            std::memcmp(data, detail::BINARY_MAGIC, sizeof(detail::BINARY_MAGIC)) != 0) {
+            // Written before the checksummed format; only the framing can be checked.
+            decrypt_to(data, data, raw.size());
+            decoded = raw.size();
+            parse();
+            if (parsed != decoded) return false;
+        }
+        else {
+            size_t in = sizeof(detail::BINARY_MAGIC);
+            bool ended = false;
+            uint64_t count = 0;
+            while (in < raw.size() && !ended) {
+                if (raw.size() - in < detail::BINARY_BLOCK_HEADER) return false;
+                uint32_t header[2];
+                std::memcpy(header, data + in, sizeof(header));
+                ended = (header[0] & detail::BINARY_LAST_BLOCK) != 0;
+                const size_t size = header[0] & ~detail::BINARY_LAST_BLOCK;
+                const char* block = data + in + detail::BINARY_BLOCK_HEADER;
+                if (size > raw.size() - in - detail::BINARY_BLOCK_HEADER) return false;
+                if (crc32c::value(block, size) != header[1]) return false;
+                in += detail::BINARY_BLOCK_HEADER + size;
+                if (ended) {
+                    if (size != sizeof(count)) return false;
+                    std::memcpy(&count, block, sizeof(count));
+                    break;
+                }
+                decrypt_to(data + decoded, block, size);
+                decoded += size;
+                parse();
+            }
+            if (!ended || in != raw.size() || parsed != decoded || count != entries.size()) return false;
         }
+
+        resetStorage();
+        slotsInvalidate();   // built on the first lookup
+        for (auto& obj : entries) append(std::move(obj));
         return true;
     }
 
     // File operations
-    bool ConfigManager::loadText(const std::string& filename) {
+    inline bool ConfigManager::loadText(const std::string& filename) {
         if (!validateExtension(filename, ".cntconfig")) {
             throw std::runtime_error("Invalid text config file extension");
         }
@@ -237,60 +982,72 @@ namespace cnt {
         std::ifstream file(filename);
         if (!file.is_open()) return false;
 
+        if (configs.empty()) slotsInvalidate();   // built on the first lookup
+
         std::string line;
         while (std::getline(file, line)) {
             ConfigObject obj = parseLine(line);
-            if (!obj.name.empty()) configs.push_back(obj);
+            if (!obj.name.empty()) {
+                append(std::move(obj));
+            }
         }
         file.close();
+        if (journal) journalTouch(npos);
         return true;
     }
 
-    bool ConfigManager::saveText(const std::string& filename) const {
+    inline bool ConfigManager::saveText(const std::string& filename, const SaveOptions& options) const {
         if (!validateExtension(filename, ".cntconfig")) {
             throw std::runtime_error("Invalid text config file extension");
         }
 
-        std::ofstream file(filename);
-        if (!file.is_open()) return false;
+        detail::ConfigFileWriter file(filename, options);
+        if (!file.isOpen()) return false;
 
-        for (const auto& obj : configs) {
-            file << obj.name << "=" << obj.value << "\n";
+        for (const auto& obj : *this) {
+            file.put(obj.name);
+            file.put("=", 1);
+            file.put(obj.value);
+            file.put("\n", 1);
         }
-        file.close();
-        return true;
+        return file.commit();
     }
 
-    bool ConfigManager::loadBinary(const std::string& filename) {
+    inline bool ConfigManager::loadBinary(const std::string& filename) {
         if (!validateExtension(filename, ".cntconfigbin")) {
             throw std::runtime_error("Invalid binary file extension");
         }
 
-        std::ifstream file(filename, std::ios::binary | std::ios::ate);
-        if (!file) return false;
-
-        std::streamsize size = file.tellg();
-        file.seekg(0);
-        std::string encrypted(size, '\0');
-        if (!file.read(&encrypted[0], size)) return false;
+        std::string raw;
+        if (!detail::readWholeFile(filename, raw)) return false;
 
-        return deserializeBinary(decrypt(encrypted));
+        bool ok = decodeBinary(raw);
+        if (journal) journalTouch(npos);
+        return ok;
     }
 
-    bool ConfigManager::saveBinary(const std::string& filename) const {
+    inline bool ConfigManager::saveBinary(const std::string& filename, const SaveOptions& options) const {
         if (!validateExtension(filename, ".cntconfigbin")) {
             throw std::runtime_error("Invalid binary file extension");
         }
+        if (journal && filename == journal->base_path) {
+            try {
+                journalFold();
+            }
+            catch (const std::runtime_error&) {
+                return false;
+            }
+            return true;
+        }
 
-        std::string data = encrypt(serializeBinary());
-        std::ofstream file(filename, std::ios::binary);
-        if (!file) return false;
+        detail::ConfigFileWriter file(filename, options);
+        if (!file.isOpen()) return false;
 
-        file.write(data.data(), data.size());
-        return file.good();
+        writeBinary(file);
+        return file.commit();
     }
     
-    bool ConfigManager::loadFile(const std::string& filename) {
+    inline bool ConfigManager::loadFile(const std::string& filename) {
         if (validateExtension(filename, ".cntconfig"))
 			return loadText(filename);
 		
@@ -300,73 +1057,985 @@ namespace cnt {
 		throw std::runtime_error("Invalid binary file extension");
     }
 
+    // Slot bookkeeping
+    inline ConfigObject& ConfigManager::append(ConfigObject&& obj) {
+        configs.push_back(std::move(obj));
+        if (!tombstones.empty()) tombstones.push_back(0);
+        indexAppend();
+        if (slots_valid) {
+            const ConfigObject& added = configs.back();
+            uint32_t slot = static_cast<uint32_t>(configs.size() - 1);
+            name_slots.emplace(keyHash(added.name), slot);
+            if (value_index) value_slots.emplace(keyHash(added.value), slot);
+        }
+        return configs.back();
+    }
+
+    namespace detail {
+        inline void eraseSlot(std::unordered_multimap<size_t, uint32_t>& map, size_t hash, uint32_t slot) {
+            auto range = map.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == slot) {
+                    map.erase(it);
+                    return;
+                }
+            }
+        }
+
+        inline void insertSlot(std::unordered_multimap<size_t, uint32_t>& map, size_t hash, uint32_t slot) {
+            auto range = map.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == slot) return;
+            }
+            map.emplace(hash, slot);
+        }
+    }
+
+    // Removal leaves a tombstone; the caller has refreshed the slot indexes.
+    inline void ConfigManager::kill(size_t slot) {
+        if (tombstones.empty()) tombstones.assign(configs.size(), 0);
+        tombstones[slot] = 1;
+        ++dead_count;
+        if (slots_valid) {
+            detail::eraseSlot(name_slots, keyHash(configs[slot].name), static_cast<uint32_t>(slot));
+            if (value_index) detail::eraseSlot(value_slots, keyHash(configs[slot].value), static_cast<uint32_t>(slot));
+        }
+        configs[slot] = ConfigObject();
+    }
+
+    inline void ConfigManager::compact() {
+        if (dead_count == 0) return;
+        if (journal && !journal->touched.empty()) journalSync();   // touched slots are about to move
+        std::vector<uint32_t> removed;
+        removed.reserve(dead_count);
+        size_t out = 0;
+        for (size_t i = 0; i < configs.size(); ++i) {
+            if (tombstones[i]) {
+                removed.push_back(static_cast<uint32_t>(i));
+            }
+            else {
+                if (out != i) configs[out] = std::move(configs[i]);
+                ++out;
+            }
+        }
+        configs.erase(configs.begin() + out, configs.end());
+        tombstones.clear();
+        dead_count = 0;
+
+        indexRemove(removed);
+        name_index_dead = 0;
+
+        // Survivors move down by the number of removed slots before them.
+        auto shift = [&removed](uint32_t slot) {
+            return static_cast<uint32_t>(std::lower_bound(removed.begin(), removed.end(), slot) - removed.begin());
+        };
+        if (slots_valid) {
+            for (auto& entry : name_slots) entry.second -= shift(entry.second);
+            for (auto& entry : value_slots) entry.second -= shift(entry.second);
+        }
+        size_t kept = 0;
+        for (const DirtySlot& dirty : dirty_slots) {
+            auto it = std::lower_bound(removed.begin(), removed.end(), dirty.slot);
+            if (it != removed.end() && *it == dirty.slot) continue;
+            DirtySlot moved = dirty;
+            moved.slot -= static_cast<uint32_t>(it - removed.begin());
+            dirty_slots[kept++] = moved;
+        }
+        dirty_slots.resize(kept);
+    }
+
+    inline void ConfigManager::markDirty(size_t slot) {
+        if (!slots_valid) return;
+        if (dirty_slots.size() >= configs.size()) {
+            slotsInvalidate();   // cheaper to rebuild than to replay
+            return;
+        }
+        const ConfigObject& obj = configs[slot];
+        dirty_slots.push_back({static_cast<uint32_t>(slot), keyHash(obj.name), value_index ? keyHash(obj.value) : 0});
+    }
+
+    inline void ConfigManager::refreshSlots() const {
+        if (!slots_valid) {
+            name_slots.clear();
+            value_slots.clear();
+            name_slots.reserve(size());
+            if (value_index) value_slots.reserve(size());
+            for (size_t i = 0; i < configs.size(); ++i) {
+                if (!isLive(i)) continue;
+                name_slots.emplace(keyHash(configs[i].name), static_cast<uint32_t>(i));
+                if (value_index) value_slots.emplace(keyHash(configs[i].value), static_cast<uint32_t>(i));
+            }
+            dirty_slots.clear();
+            slots_valid = true;
+            return;
+        }
+        for (const DirtySlot& dirty : dirty_slots) {
+            if (!isLive(dirty.slot)) continue;
+            const ConfigObject& obj = configs[dirty.slot];
+            size_t hash = keyHash(obj.name);
+            if (hash != dirty.name_hash) {
+                detail::eraseSlot(name_slots, dirty.name_hash, dirty.slot);
+                detail::insertSlot(name_slots, hash, dirty.slot);
+            }
+            if (value_index) {
+                hash = keyHash(obj.value);
+                if (hash != dirty.value_hash) {
+                    detail::eraseSlot(value_slots, dirty.value_hash, dirty.slot);
+                    detail::insertSlot(value_slots, hash, dirty.slot);
+                }
+            }
+        }
+        dirty_slots.clear();
+    }
+
+    // First live slot (in insertion order) whose field equals key, or npos.
+    inline size_t ConfigManager::findSlot(const SlotMap& map, std::string ConfigObject::*field, const std::string& key) const {
+        size_t found = npos;
+        auto range = map.equal_range(keyHash(key));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second < found && isLive(it->second) && configs[it->second].*field == key) found = it->second;
+        }
+        return found;
+    }
+
+    // Every live slot whose field equals key, ascending.
+    inline std::vector<uint32_t> ConfigManager::matchSlots(std::string ConfigObject::*field, const std::string& key) const {
+        std::vector<uint32_t> slots;
+        refreshSlots();
+        if (field == &ConfigObject::name || value_index) {
+            const SlotMap& map = field == &ConfigObject::name ? name_slots : value_slots;
+            auto range = map.equal_range(keyHash(key));
+            for (auto it = range.first; it != range.second; ++it) {
+                if (isLive(it->second) && configs[it->second].*field == key) slots.push_back(it->second);
+            }
+            std::sort(slots.begin(), slots.end());
+        }
+        else {
+            for (size_t i = 0; i < configs.size(); ++i) {
+                if (isLive(i) && configs[i].*field == key) slots.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return slots;
+    }
+
+    inline size_t ConfigManager::findName(const std::string& name) const {
+        refreshSlots();
+        return findSlot(name_slots, &ConfigObject::name, name);
+    }
+
     // Configuration operations
-    void ConfigManager::add(const ConfigObject& obj) {
-        configs.push_back(obj);
+    inline void ConfigManager::add(const ConfigObject& obj) {
+        add(obj.name, obj.value);
     }
 
-    void ConfigManager::add(const std::string& name, const std::string& value) {
-        configs.push_back({name, value});
+    inline void ConfigManager::add(const std::string& name, const std::string& value) {
+        if (journal) journalSync();
+        append({name, value});
+        if (journal) {
+            journalRecord(detail::JOURNAL_ADD, &name, &value);
+            journalCheck();
+        }
     }
 
-    bool ConfigManager::removeByName(const std::string& name) {
-        auto it = std::remove_if(configs.begin(), configs.end(),
-            [&name](const ConfigObject& obj) { return obj.name == name; });
-        if (it != configs.end()) {
-            configs.erase(it, configs.end());
-            return true;
+    inline void ConfigManager::setEntry(const std::string& name, std::string value) {
+        size_t slot = findName(name);
+        if (slot == npos) {
+            append({name, std::move(value)});
+        }
+        else {
+            if (value_index) markDirty(slot);
+            configs[slot].value = std::move(value);
         }
-        return false;
     }
 
-    bool ConfigManager::removeByValue(const std::string& value) {
-        auto it = std::remove_if(configs.begin(), configs.end(),
-            [&value](const ConfigObject& obj) { return obj.value == value; });
-        if (it != configs.end()) {
-            configs.erase(it, configs.end());
-            return true;
+    inline bool ConfigManager::removeEntries(const std::string& name) {
+        std::vector<uint32_t> slots = matchSlots(&ConfigObject::name, name);
+        for (uint32_t slot : slots) kill(slot);
+        return !slots.empty();
+    }
+
+    inline void ConfigManager::set(const std::string& name, const std::string& value) {
+        if (journal) journalSync();
+        setEntry(name, value);
+        if (journal) {
+            journalRecord(detail::JOURNAL_SET, &name, &value);
+            journalCheck();
+        }
+    }
+
+    inline bool ConfigManager::removeByName(const std::string& name) {
+        if (journal) journalSync();
+        const bool removed = removeEntries(name);
+        if (journal && removed) {
+            journalRecord(detail::JOURNAL_REMOVE_NAME, &name);
+            journalCheck();
+        }
+        maybeCompact();
+        return removed;
+    }
+
+    inline bool ConfigManager::removeByValue(const std::string& value) {
+        if (journal) journalSync();
+        std::vector<uint32_t> slots = matchSlots(&ConfigObject::value, value);
+        for (uint32_t slot : slots) kill(slot);
+        if (journal && !slots.empty()) {
+            journalRecord(detail::JOURNAL_REMOVE_VALUE, &value);
+            journalCheck();
         }
-        return false;
+        maybeCompact();
+        return !slots.empty();
     }
 
-    bool ConfigManager::removeByIndex(size_t index) {
+    inline bool ConfigManager::removeByIndex(size_t index) {
+        if (journal) journalSync();
+        compact();
         if (index >= configs.size()) return false;
-        configs.erase(configs.begin() + index);
+        refreshSlots();
+        kill(index);
+        if (journal) {
+            journalRecord(detail::JOURNAL_REMOVE_ROW, nullptr, nullptr, static_cast<uint32_t>(index));
+            journalCheck();
+        }
+        return true;
+    }
+
+    inline void ConfigManager::clear() {
+        resetStorage();
+        if (journal) {
+            journal->touched.clear();
+            journal->rewrite = false;
+            journalRecord(detail::JOURNAL_CLEAR, nullptr);
+            journalCheck();
+        }
+    }
+
+    // Stages the batch as one plan per name, finds the existing entries of
+    // those names and makes every allocation; only then are the entries
+    // changed, in one pass that cannot throw. The journal record follows,
+    // and if it cannot be written the pass is undone.
+    inline void ConfigManager::apply(ConfigBatch& batch) {
+        CNT_SCOPED_TIMER("config.batch");
+        if (batch.ops.empty()) return;
+        if (journal) journalSync();
+        if (slots_valid) refreshSlots();
+
+        // What the calls of each name come to, in order: one plan per name,
+        // found through an open-addressed table keyed by the name hash (the
+        // key of the entries' own index), so that matching compares integers
+        // first and every name is compared at most once per probe.
+        constexpr uint32_t none = static_cast<uint32_t>(-1);
+        struct Plan {
+            size_t hash;
+            std::string_view name;
+            uint32_t created;   // first set after the last remove: appends when nothing is left
+            uint32_t value;     // last set after the last remove
+            uint32_t slot;      // first existing entry
+            bool drop;          // removed: the existing entries go
+        };
+        const size_t count = batch.ops.size();
+        size_t mask = 15;
+        while (mask < 2 * count) mask = mask * 2 + 1;
+        std::vector<uint32_t> table(mask + 1, none);
+        std::vector<Plan> plans;
+        plans.reserve(count);
+        const auto probe = [&](size_t hash, std::string_view name) -> uint32_t& {
+            size_t bucket = hash & mask;
+            while (table[bucket] != none && (plans[table[bucket]].hash != hash || plans[table[bucket]].name != name)) {
+                bucket = (bucket + 1) & mask;
+            }
+            return table[bucket];
+        };
+        for (size_t i = 0; i < count; ++i) {
+            const ConfigBatch::Entry& op = batch.ops[i];
+            const std::string_view name = batch.name(op);
+            const size_t hash = keyHash(name);
+            uint32_t& at = probe(hash, name);
+            if (at == none) {
+                at = static_cast<uint32_t>(plans.size());
+                plans.push_back({hash, name, none, none, none, false});
+            }
+            Plan& plan = plans[at];
+            if (op.op == ConfigBatch::Op::REMOVE) {
+                plan.drop = true;
+                plan.created = none;
+                plan.value = none;
+            }
+            else {
+                if (plan.created == none) plan.created = static_cast<uint32_t>(i);
+                plan.value = static_cast<uint32_t>(i);
+            }
+        }
+
+        // Existing entries of the staged names: through the hash index when it
+        // is current, otherwise in one scan of the entries.
+        std::vector<uint32_t> kills;
+        const auto found = [&kills](Plan& plan, uint32_t slot) {
+            plan.slot = std::min(plan.slot, slot);
+            if (plan.drop) kills.push_back(slot);
+        };
+        if (slots_valid) {
+            for (Plan& plan : plans) {
+                auto range = name_slots.equal_range(plan.hash);
+                for (auto it = range.first; it != range.second; ++it) {
+                    if (isLive(it->second) && configs[it->second].name == plan.name) found(plan, it->second);
+                }
+            }
+        }
+        else {
+            for (size_t i = 0; i < configs.size(); ++i) {
+                if (!isLive(i)) continue;
+                const uint32_t at = probe(keyHash(configs[i].name), configs[i].name);
+                if (at != none) found(plans[at], static_cast<uint32_t>(i));
+            }
+        }
+
+        // Everything that can throw happens before the first change: new
+        // values and entries are built here and only moved in below. Without
+        // a journal there is nothing to undo, so a value that fits the
+        // storage of the one it replaces is copied over it instead.
+        struct Update {
+            uint32_t slot;
+            uint32_t value;     // op holding the new value
+            size_t old_hash;    // of the value replaced, with the value index
+            bool in_place;
+        };
+        std::vector<Update> updates;
+        std::vector<std::string> values;   // parallel to updates: the new values, then the old ones
+        std::vector<std::pair<uint32_t, uint32_t>> appends;   // (created, value), in call order
+        for (const Plan& plan : plans) {
+            if (plan.created != none && (plan.drop || plan.slot == none)) {
+                appends.emplace_back(plan.created, plan.value);
+            }
+            else if (!plan.drop && plan.slot != none) {
+                const std::string& old = configs[plan.slot].value;
+                const std::string_view value = batch.value(batch.ops[plan.value]);
+                const bool in_place = !journal && value.size() <= old.capacity();
+                updates.push_back({plan.slot, plan.value, value_index ? keyHash(old) : 0, in_place});
+                values.emplace_back(in_place ? std::string_view() : value);
+            }
+        }
+        std::sort(appends.begin(), appends.end());
+        std::vector<ConfigObject> added;
+        added.reserve(appends.size());
+        for (const auto& append : appends) {
+            added.push_back({std::string(batch.name(batch.ops[append.first])), std::string(batch.value(batch.ops[append.second]))});
+        }
+        std::vector<ConfigObject> removed;   // kept until the journal has the batch
+        removed.reserve(kills.size());
+        std::string record;
+        if (journal) record = encodeBatch(batch);
+        const size_t first_new = configs.size();
+        const size_t grown = first_new + added.size();
+        configs.reserve(grown);
+        if (!kills.empty() && tombstones.empty()) tombstones.assign(first_new, 0);
+        if (!tombstones.empty()) tombstones.reserve(grown);
+        if (name_index_valid) name_index.reserve(name_index.size() + added.size());
+
+        for (size_t i = 0; i < updates.size(); ++i) {
+            std::string& value = configs[updates[i].slot].value;
+            if (updates[i].in_place) value.assign(batch.value(batch.ops[updates[i].value]));
+            else value.swap(values[i]);
+        }
+        for (uint32_t slot : kills) {
+            removed.push_back(std::move(configs[slot]));
+            tombstones[slot] = 1;
+        }
+        dead_count += kills.size();
+        for (ConfigObject& obj : added) {
+            configs.push_back(std::move(obj));
+            if (!tombstones.empty()) tombstones.push_back(0);
+        }
+
+        if (journal) {
+            try {
+                journalRecord(detail::JOURNAL_BATCH, &record);
+            }
+            catch (...) {
+                configs.resize(first_new);
+                if (!tombstones.empty()) tombstones.resize(first_new);
+                dead_count -= kills.size();
+                for (size_t i = 0; i < kills.size(); ++i) {
+                    configs[kills[i]] = std::move(removed[i]);
+                    tombstones[kills[i]] = 0;
+                }
+                for (size_t i = 0; i < updates.size(); ++i) configs[updates[i].slot].value.swap(values[i]);
+                throw;
+            }
+        }
+
+        // The indexes are caches: if they cannot grow they are rebuilt on demand.
+        if (name_index_valid) {
+            for (size_t slot = first_new; slot < grown; ++slot) name_index.push_back(static_cast<uint32_t>(slot));
+        }
+        if (slots_valid) {
+            try {
+                for (size_t i = 0; i < kills.size(); ++i) {
+                    detail::eraseSlot(name_slots, keyHash(removed[i].name), kills[i]);
+                    if (value_index) detail::eraseSlot(value_slots, keyHash(removed[i].value), kills[i]);
+                }
+                for (size_t i = 0; value_index && i < updates.size(); ++i) {
+                    detail::eraseSlot(value_slots, updates[i].old_hash, updates[i].slot);
+                    value_slots.emplace(keyHash(configs[updates[i].slot].value), updates[i].slot);
+                }
+                for (size_t slot = first_new; slot < grown; ++slot) {
+                    name_slots.emplace(keyHash(configs[slot].name), static_cast<uint32_t>(slot));
+                    if (value_index) value_slots.emplace(keyHash(configs[slot].value), static_cast<uint32_t>(slot));
+                }
+            }
+            catch (const std::bad_alloc&) {
+                slotsInvalidate();
+            }
+        }
+        batch.clear();
+
+        if (journal) journalCheck();
+        maybeCompact();
+    }
+
+    // Batch journal record: per operation [u8 op][u32 len][name], and for a
+    // set [u32 len][value].
+    inline std::string ConfigManager::encodeBatch(const ConfigBatch& batch) {
+        size_t bytes = 0;
+        for (const ConfigBatch::Entry& op : batch.ops) bytes += 9 + op.name_size + op.value_size;
+        std::string record;
+        record.reserve(bytes);
+        auto field = [&record](std::string_view text) {
+            uint32_t len = static_cast<uint32_t>(text.size());
+            record.append(reinterpret_cast<const char*>(&len), sizeof(len));
+            record.append(text.data(), text.size());
+        };
+        for (const ConfigBatch::Entry& op : batch.ops) {
+            bool set = op.op == ConfigBatch::Op::SET;
+            record += static_cast<char>(set ? detail::JOURNAL_SET : detail::JOURNAL_REMOVE_NAME);
+            field(batch.name(op));
+            if (set) field(batch.value(op));
+        }
+        return record;
+    }
+
+    inline bool ConfigManager::decodeBatch(const std::string& record, ConfigBatch& batch) {
+        const char* p = record.data();
+        const char* end = p + record.size();
+        auto field = [&p, end](std::string_view& text) {
+            uint32_t len;
+            if (end - p < 4) return false;
+            std::memcpy(&len, p, sizeof(len));
+            p += 4;
+            if (static_cast<size_t>(end - p) < len) return false;
+            text = std::string_view(p, len);
+            p += len;
+            return true;
+        };
+        std::string_view name;
+        std::string_view value;
+        while (p < end) {
+            uint8_t op = static_cast<uint8_t>(*p++);
+            if (op == detail::JOURNAL_SET && field(name) && field(value)) batch.set(name, value);
+            else if (op == detail::JOURNAL_REMOVE_NAME && field(name)) batch.remove(name);
+            else return false;
+        }
         return true;
     }
 
-    void ConfigManager::clear() {
+    inline void ConfigBatch::commit() {
+        if (!target) throw std::logic_error("Config batch is not bound to a manager");
+        target->apply(*this);
+    }
+
+    inline void ConfigManager::resetStorage() {
         configs.clear();
+        tombstones.clear();
+        dead_count = 0;
+        name_index.clear();
+        name_sorted = 0;
+        name_index_valid = true;
+        name_index_dead = 0;
+        name_slots.clear();
+        value_slots.clear();
+        dirty_slots.clear();
+        slots_valid = true;
+    }
+
+    inline void ConfigManager::enableValueIndex(bool enable) {
+        if (value_index == enable) return;
+        value_index = enable;
+        value_slots.clear();
+        slotsInvalidate();
     }
 
     // Query methods
-    std::string ConfigManager::getValue(const std::string& name) const {
-        for (const auto& obj : configs) {
-            if (obj.name == name) return obj.value;
-        }
-        return "";
+    inline std::string ConfigManager::getValue(const std::string& name) const {
+        CNT_SCOPED_TIMER("config.lookup");
+        size_t slot = findName(name);
+        return slot == npos ? "" : configs[slot].value;
     }
 
-    std::string ConfigManager::getName(const std::string& value) const {
-        for (const auto& obj : configs) {
+    inline std::string ConfigManager::getName(const std::string& value) const {
+        CNT_SCOPED_TIMER("config.lookup");
+        if (value_index) {
+            refreshSlots();
+            size_t slot = findSlot(value_slots, &ConfigObject::value, value);
+            return slot == npos ? "" : configs[slot].name;
+        }
+        for (const auto& obj : *this) {
             if (obj.value == value) return obj.name;
         }
         return "";
     }
 
-    ConfigObject& ConfigManager::get(size_t index) {
+    inline ConfigObject& ConfigManager::get(size_t index) {
+        compact();
         if (index >= configs.size()) throw std::out_of_range("Index out of range");
+        indexInvalidate();  // the caller may rename the entry
+        markDirty(index);
+        if (journal) journalTouch(index);
         return configs[index];
     }
 
-    bool ConfigManager::contains(const std::string& name) const {
-        for (const auto& obj : configs) {
-            if (obj.name == name) return true;
+    inline bool ConfigManager::contains(const std::string& name) const {
+        CNT_SCOPED_TIMER("config.lookup");
+        return findName(name) != npos;
+    }
+
+    inline size_t ConfigManager::size() const {
+        return configs.size() - dead_count;
+    }
+
+    // Journal
+
+    inline size_t ConfigManager::rankOf(size_t slot) const {
+        if (dead_count == 0) return slot;
+        size_t rank = 0;
+        for (size_t i = 0; i < slot; ++i) rank += tombstones[i] ? 0 : 1;
+        return rank;
+    }
+
+    inline void ConfigManager::journalRecord(uint8_t op, const std::string* first, const std::string* second, uint32_t row) const {
+        CNT_SCOPED_TIMER("config.journal.append");
+        JournalState& j = *journal;
+        std::string record(detail::JOURNAL_RECORD_HEADER, '\0');
+        record[8] = static_cast<char>(op);
+        if (op == detail::JOURNAL_SET_ROW || op == detail::JOURNAL_REMOVE_ROW) {
+            record.append(reinterpret_cast<const char*>(&row), sizeof(row));
+        }
+        for (const std::string* field : {first, second}) {
+            if (!field) continue;
+            uint32_t len = static_cast<uint32_t>(field->size());
+            record.append(reinterpret_cast<const char*>(&len), sizeof(len));
+            record.append(*field);
+        }
+        uint32_t length = static_cast<uint32_t>(record.size() - detail::JOURNAL_RECORD_HEADER);
+        uint32_t checksum = crc32c::value(record.data() + 8, record.size() - 8);
+        std::memcpy(&record[0], &length, sizeof(length));
+        std::memcpy(&record[4], &checksum, sizeof(checksum));
+
+        bool ok = std::fwrite(record.data(), 1, record.size(), j.file) == record.size();
+        ok = (std::fflush(j.file) == 0) && ok && (!j.options.sync || detail::syncFile(j.file));
+        if (!ok) throw std::runtime_error("Failed to append to config journal: " + j.journal_path);
+        j.journal_bytes += record.size();
+    }
+
+    // npos: the whole state may have changed.
+    inline void ConfigManager::journalTouch(size_t slot) const {
+        JournalState& j = *journal;
+        if (slot == npos) {
+            j.rewrite = true;
+            return;
+        }
+        j.touched.push_back(static_cast<uint32_t>(slot));
+        if (j.touched.size() > 2 * configs.size() + 64) {
+            std::sort(j.touched.begin(), j.touched.end());
+            j.touched.erase(std::unique(j.touched.begin(), j.touched.end()), j.touched.end());
+        }
+    }
+
+    // Records what was written through references since the last record.
+    inline void ConfigManager::journalSync() const {
+        JournalState& j = *journal;
+        if (j.rewrite) {
+            journalFold();
+            return;
+        }
+        if (j.touched.empty()) return;
+        std::sort(j.touched.begin(), j.touched.end());
+        j.touched.erase(std::unique(j.touched.begin(), j.touched.end()), j.touched.end());
+        for (uint32_t slot : j.touched) {
+            if (slot >= configs.size() || !isLive(slot)) continue;
+            journalRecord(detail::JOURNAL_SET_ROW, &configs[slot].name, &configs[slot].value,
+                          static_cast<uint32_t>(rankOf(slot)));
+        }
+        j.touched.clear();
+    }
+
+    inline void ConfigManager::journalJoin() const {
+        JournalState& j = *journal;
+        if (!j.worker.joinable()) return;
+        j.worker.join();
+        if (!j.worker_failed) j.base_bytes = j.folded_bytes;
+    }
+
+    inline void ConfigManager::journalCheck() const {
+        JournalState& j = *journal;
+        if (j.worker.joinable() && j.worker_done) journalJoin();
+        if (j.journal_bytes < j.options.compact_min_bytes ||
+            static_cast<double>(j.journal_bytes) <= j.options.compact_ratio * static_cast<double>(j.base_bytes)) {
+            return;
+        }
+        if (j.worker.joinable()) return;   // the previous fold is still running
+        std::error_code ec;
+        if (j.options.background && !std::filesystem::exists(j.compacting_path, ec)) journalRotate();
+        else journalFold();
+    }
+
+    // Writes the current state as the snapshot and starts an empty journal.
+    inline void ConfigManager::journalFold() const {
+        CNT_SCOPED_TIMER("config.journal.fold");
+        JournalState& j = *journal;
+        journalJoin();
+
+        SaveOptions options;
+        options.sync = true;
+        detail::ConfigFileWriter out(j.base_path, options);
+        out.trackChecksum();
+        if (!out.isOpen()) throw std::runtime_error("Failed to write config snapshot: " + j.base_path);
+        writeBinary(out);
+        if (!out.finish()) throw std::runtime_error("Failed to write config snapshot: " + j.base_path);
+
+        // The new journal names the new snapshot, so whichever pair a crash
+        // leaves behind, the old journal is never replayed onto it.
+        detail::JournalHeader header;
+        std::memcpy(header.magic, detail::JOURNAL_MAGIC, sizeof(header.magic));
+        header.id = detail::journalId();
+        header.base_checksum = out.checksum();
+        header.after_id = 0;
+        std::string fresh = j.journal_path + ".tmp";
+        if (!detail::createJournal(fresh, header, true)) {
+            std::remove(fresh.c_str());
+            throw std::runtime_error("Failed to create config journal: " + fresh);
+        }
+        if (j.file) std::fclose(j.file);
+        j.file = nullptr;
+        bool ok = out.publish() && detail::replaceFile(fresh, j.journal_path);
+        std::remove(fresh.c_str());
+        std::remove(j.compacting_path.c_str());
+        j.file = std::fopen(j.journal_path.c_str(), "ab");
+        if (!ok || !j.file) throw std::runtime_error("Failed to replace config snapshot: " + j.base_path);
+
+        j.id = header.id;
+        j.journal_bytes = sizeof(header);
+        j.base_bytes = out.bytes();
+        j.touched.clear();
+        j.rewrite = false;
+        j.worker_failed = false;
+    }
+
+    // Hands the journal to a worker that folds it into the snapshot, and
+    // continues in a fresh one.
+    inline void ConfigManager::journalRotate() const {
+        JournalState& j = *journal;
+        std::fclose(j.file);
+        j.file = nullptr;
+        bool rotated = detail::replaceFile(j.journal_path, j.compacting_path);
+
+        detail::JournalHeader header;
+        std::memcpy(header.magic, detail::JOURNAL_MAGIC, sizeof(header.magic));
+        header.id = detail::journalId();
+        header.base_checksum = 0;
+        header.after_id = j.id;
+        if (rotated && !detail::createJournal(j.journal_path, header, j.options.sync)) rotated = false;
+        j.file = std::fopen(j.journal_path.c_str(), "ab");
+        if (!j.file) throw std::runtime_error("Failed to open config journal: " + j.journal_path);
+        if (!rotated) {
+            journalFold();
+            return;
+        }
+
+        j.id = header.id;
+        j.journal_bytes = sizeof(header);
+        j.worker_done = false;
+        j.worker_failed = false;
+        j.worker = std::thread(&ConfigManager::journalWorker, &j);
+    }
+
+    // Runs without the owning manager: snapshot + folded journal -> new snapshot.
+    inline void ConfigManager::journalWorker(JournalState* state) {
+        bool ok = false;
+        try {
+            std::string raw;
+            std::string body;
+            detail::JournalHeader header;
+            if (detail::readWholeFile(state->base_path, raw) &&
+                detail::readJournal(state->compacting_path, header, body) &&
+                header.base_checksum == detail::snapshotId(raw)) {
+                ConfigManager snapshot;
+                if (snapshot.decodeBinary(raw)) {
+                    raw.clear();
+                    raw.shrink_to_fit();
+                    snapshot.journalReplay(body);
+
+                    SaveOptions options;
+                    options.sync = true;
+                    detail::ConfigFileWriter out(state->base_path, options);
+                    out.trackChecksum();
+                    if (out.isOpen()) {
+                        snapshot.writeBinary(out);
+                        // The live journal learns its snapshot before that snapshot appears.
+                        if (out.finish() &&
+                            detail::patchJournalBase(state->journal_path, out.checksum(), state->options.sync) &&
+                            out.publish()) {
+                            std::remove(state->compacting_path.c_str());
+                            state->folded_bytes = out.bytes();
+                            ok = true;
+                        }
+                    }
+                }
+            }
+        }
+        catch (const std::exception&) {
+        }
+        state->worker_failed = !ok;
+        state->worker_done = true;
+    }
+
+    // Applies records up to the first torn or corrupt one; returns the bytes used.
+    inline size_t ConfigManager::journalReplay(const std::string& body) {
+        size_t pos = 0;
+        while (pos + detail::JOURNAL_RECORD_HEADER <= body.size()) {
+            uint32_t length, checksum;
+            std::memcpy(&length, body.data() + pos, sizeof(length));
+            std::memcpy(&checksum, body.data() + pos + 4, sizeof(checksum));
+            if (length > body.size() - pos - detail::JOURNAL_RECORD_HEADER) break;
+            const char* checked = body.data() + pos + 8;
+            if (crc32c::value(checked, length + 1) != checksum) break;
+
+            const char* p = body.data() + pos + detail::JOURNAL_RECORD_HEADER;
+            const char* end = p + length;
+            uint8_t op = static_cast<uint8_t>(body[pos + 8]);
+            uint32_t row = 0;
+            std::string fields[2];
+            size_t count = 0;
+            bool ok = true;
+            if (op == detail::JOURNAL_SET_ROW || op == detail::JOURNAL_REMOVE_ROW) {
+                ok = end - p >= 4;
+                if (ok) std::memcpy(&row, p, sizeof(row));
+                p += ok ? 4 : 0;
+            }
+            while (ok && p < end && count < 2) {
+                uint32_t len;
+                ok = end - p >= 4;
+                if (!ok) break;
+                std::memcpy(&len, p, sizeof(len));
+                p += 4;
+                ok = static_cast<size_t>(end - p) >= len;
+                if (ok) fields[count++].assign(p, len);
+                p += ok ? len : 0;
+            }
+            if (!ok || p != end) break;
+
+            switch (op) {
+            case detail::JOURNAL_ADD:
+                ok = count == 2;
+                if (ok) add(fields[0], fields[1]);
+                break;
+            case detail::JOURNAL_SET:
+                ok = count == 2;
+                if (ok) set(fields[0], fields[1]);
+                break;
+            case detail::JOURNAL_SET_ROW:
+                ok = count == 2 && row < size();
+                if (ok) get(row) = {std::move(fields[0]), std::move(fields[1])};
+                break;
+            case detail::JOURNAL_REMOVE_NAME:
+                ok = count == 1;
+                if (ok) removeByName(fields[0]);
+                break;
+            case detail::JOURNAL_REMOVE_VALUE:
+                ok = count == 1;
+                if (ok) removeByValue(fields[0]);
+                break;
+            case detail::JOURNAL_REMOVE_ROW:
+                ok = count == 0 && removeByIndex(row);
+                break;
+            case detail::JOURNAL_CLEAR:
+                ok = count == 0;
+                if (ok) clear();
+                break;
+            case detail::JOURNAL_BATCH: {
+                ConfigBatch batch;
+                ok = count == 1 && decodeBatch(fields[0], batch);
+                if (ok) apply(batch);
+                break;
+            }
+            default:
+                ok = false;
+            }
+            if (!ok) break;
+            pos += detail::JOURNAL_RECORD_HEADER + length;
+        }
+        return pos;
+    }
+
+    inline void ConfigManager::openJournal(const std::string& filename, const JournalOptions& options) {
+        if (!validateExtension(filename, ".cntconfigbin")) {
+            throw std::runtime_error("Invalid binary file extension");
+        }
+        closeJournal();
+        resetStorage();
+
+        auto state = std::make_unique<JournalState>();
+        state->base_path = filename;
+        state->journal_path = filename + ".journal";
+        state->compacting_path = filename + ".journal.compacting";
+        state->options = options;
+
+        std::string raw;
+        uint64_t base = 0;
+        if (detail::readWholeFile(filename, raw)) {
+            base = detail::snapshotId(raw);
+            state->base_bytes = raw.size();
+            if (!decodeBinary(raw)) throw std::runtime_error("Corrupted config file: " + filename);
+        }
+        else {
+            SaveOptions create;
+            create.sync = true;
+            detail::ConfigFileWriter out(filename, create);
+            out.trackChecksum();
+            if (!out.isOpen()) throw std::runtime_error("Failed to create config file: " + filename);
+            writeBinary(out);
+            if (!out.commit()) throw std::runtime_error("Failed to create config file: " + filename);
+            base = out.checksum();
+            state->base_bytes = out.bytes();
+        }
+        raw.clear();
+        raw.shrink_to_fit();
+
+        // A journal left by an unfinished fold applies only to the snapshot it
+        // was written against; the live journal either names the snapshot or
+        // follows that leftover.
+        std::error_code ec;
+        bool leftover = std::filesystem::exists(state->compacting_path, ec);
+        detail::JournalHeader header;
+        std::string body;
+        bool applied = false;
+        uint64_t leftover_id = 0;
+        if (leftover && detail::readJournal(state->compacting_path, header, body) && header.base_checksum == base) {
+            journalReplay(body);
+            applied = true;
+            leftover_id = header.id;
+        }
+
+        bool resume = false;
+        if (detail::readJournal(state->journal_path, header, body) &&
+            (header.base_checksum == base || (applied && header.after_id == leftover_id))) {
+            size_t used = journalReplay(body);
+            if (!leftover) {
+                if (used < body.size()) std::filesystem::resize_file(state->journal_path, sizeof(header) + used);
+                state->id = header.id;
+                state->journal_bytes = sizeof(header) + used;
+                resume = true;
+            }
+        }
+
+        journal = std::move(state);
+        if (resume) {
+            journal->file = std::fopen(journal->journal_path.c_str(), "ab");
+            if (journal->file) return;
+        }
+        journalFold();
+    }
+
+    inline void ConfigManager::flushJournal() {
+        if (!journal) return;
+        journalSync();
+        journalCheck();
+    }
+
+    inline void ConfigManager::compactJournal() {
+        if (!journal) return;
+        journalJoin();
+        journalFold();
+    }
+
+    inline void ConfigManager::closeJournal() {
+        if (!journal) return;
+        journalSync();
+        journalJoin();
+        if (journal->file) std::fclose(journal->file);
+        journal.reset();
+    }
+
+    // Name index
+    inline const std::vector<uint32_t>& ConfigManager::nameIndex() const {
+        auto less = [this](uint32_t a, uint32_t b) {
+            int c = configs[a].name.compare(configs[b].name);
+            return c < 0 || (c == 0 && a < b);
+        };
+        if (!name_index_valid) {
+            name_index.clear();
+            name_index.reserve(size());
+            for (size_t i = 0; i < configs.size(); ++i) {
+                if (isLive(i)) name_index.push_back(static_cast<uint32_t>(i));
+            }
+            std::sort(name_index.begin(), name_index.end(), less);
+            name_sorted = name_index.size();
+            name_index_valid = true;
+        }
+        else if (name_index_dead != dead_count) {
+            // Drop entries removed since the last query; order is unaffected.
+            size_t out = 0;
+            size_t sorted = 0;
+            for (size_t i = 0; i < name_index.size(); ++i) {
+                if (!isLive(name_index[i])) continue;
+                name_index[out++] = name_index[i];
+                if (i < name_sorted) ++sorted;
+            }
+            name_index.resize(out);
+            name_sorted = sorted;
+        }
+        name_index_dead = dead_count;
+        if (name_sorted < name_index.size()) {
+            auto middle = name_index.begin() + name_sorted;
+            std::sort(middle, name_index.end(), less);
+            std::inplace_merge(name_index.begin(), middle, name_index.end(), less);
+            name_sorted = name_index.size();
         }
-        return false;
+        return name_index;
+    }
+
+    // removed: ascending positions already erased from configs.
+    inline void ConfigManager::indexRemove(const std::vector<uint32_t>& removed) {
+        if (!name_index_valid) return;
+        size_t out = 0;
+        size_t sorted = 0;
+        for (size_t i = 0; i < name_index.size(); ++i) {
+            uint32_t pos = name_index[i];
+            auto it = std::lower_bound(removed.begin(), removed.end(), pos);
+            if (it != removed.end() && *it == pos) continue;
+            name_index[out++] = pos - static_cast<uint32_t>(it - removed.begin());
+            if (i < name_sorted) ++sorted;
+        }
+        name_index.resize(out);
+        name_sorted = sorted;
+    }
+
+    inline ConfigView ConfigManager::scan(std::string_view prefix) const {
+        CNT_SCOPED_TIMER("config.scan");
+        const std::vector<uint32_t>& index = nameIndex();
+        auto first = std::lower_bound(index.begin(), index.end(), prefix,
+            [this](uint32_t pos, std::string_view key) { return std::string_view(configs[pos].name) < key; });
+        auto last = std::partition_point(first, index.end(),
+            [this, prefix](uint32_t pos) { return std::string_view(configs[pos].name).substr(0, prefix.size()) == prefix; });
+        return ConfigView(configs.data(), index.data() + (first - index.begin()),
+                          index.data() + (last - index.begin()), prefix.size());
     }
 
-    size_t ConfigManager::size() const {
-        return configs.size();
+    inline ConfigView ConfigManager::subtree(std::string_view prefix) const {
+        if (prefix.empty()) return scan(prefix);
+        if (prefix.back() == '.') return scan(prefix);
+        std::string dotted;
+        dotted.reserve(prefix.size() + 1);
+        dotted.append(prefix.data(), prefix.size());
+        dotted += '.';
+        return scan(dotted);
     }
 }
@@ -0,0 +1,227 @@
+/**
+ * @file cnt/configlayers.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio), 
+ * and according to the project license (MIT license) agreement, 
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team. 
+ * At the same time, 
+ * project and documents can be used for commercial purposes under the condition of informing the development source, 
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time, 
+ * and any form of dispute event, CNT Development Team. 
+ * and APlcexicesetrl shall not be liable for any damages, 
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+/* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "config.h"
+
+#if !defined(_WIN32)
+extern char** environ;
+#endif
+
+namespace cnt {
+    /*
+     * Read-only overlay of several ConfigManagers ("layers"), e.g. defaults,
+     * a site file, a host file and the environment. A name resolves to the
+     * layer with the highest precedence that holds it; layers added later win.
+     *
+     * Entries stay in their layers. What is cached is, per name, which layer
+     * supplies it (or that none does), so a lookup is one probe of that cache
+     * plus one of the winning layer whatever the number of layers. Changes
+     * made through set()/remove()/reload() drop only the names they touch.
+     * A layer modified directly through its ConfigManager needs invalidate().
+     *
+     * Like ConfigManager, a LayeredConfig is not safe for concurrent use.
+     */
+    class LayeredConfig {
+    public:
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        // Adds a layer above the existing ones and returns its index.
+        size_t addLayer(const std::string& name, std::shared_ptr<ConfigManager> source) {
+            if (!source) throw std::invalid_argument("Null config layer: " + name);
+            Layer added;
+            added.name = name;
+            added.source = std::move(source);
+            layers.push_back(std::move(added));
+            dropNames(layers.size() - 1);
+            return layers.size() - 1;
+        }
+
+        // A layer loaded from a .cntconfig/.cntconfigbin file; reload() re-reads it.
+        size_t addFile(const std::string& name, const std::string& path) {
+            auto source = std::make_shared<ConfigManager>();
+            if (!source->loadFile(path)) throw std::runtime_error("Failed to load config layer: " + path);
+            size_t index = addLayer(name, std::move(source));
+            layers[index].path = path;
+            return index;
+        }
+
+        // A layer of the environment variables starting with prefix: the rest
+        // of the variable name, lower-cased and with '_' turned into '.', is
+        // the config name (APP_DB_HOST with prefix "APP_" sets "db.host").
+        size_t addEnvironment(const std::string& name, const std::string& prefix) {
+            auto source = std::make_shared<ConfigManager>();
+            readEnvironment(*source, prefix);
+            size_t index = addLayer(name, std::move(source));
+            layers[index].env_prefix = prefix;
+            layers[index].from_env = true;
+            return index;
+        }
+
+        size_t layerCount() const { return layers.size(); }
+        const std::string& layerName(size_t index) const { return at(index).name; }
+        const ConfigManager& layer(size_t index) const { return *at(index).source; }
+
+        // Lookups by precedence
+        const std::string* find(const std::string& name) const {
+            size_t index = source(name);
+            if (index == npos) return nullptr;
+            const ConfigManager& winner = *layers[index].source;
+            return &winner[name];
+        }
+
+        const std::string& operator[](const std::string& name) const {
+            const std::string* value = find(name);
+            if (!value) throw std::out_of_range("Key not found: " + name);
+            return *value;
+        }
+
+        std::string getValue(const std::string& name) const {
+            const std::string* value = find(name);
+            return value ? *value : std::string();
+        }
+
+        bool contains(const std::string& name) const { return source(name) != npos; }
+
+        // Index of the layer that supplies name, npos if none does.
+        size_t source(const std::string& name) const {
+            CNT_SCOPED_TIMER("config.layers.lookup");
+            auto it = resolved.find(name);
+            if (it != resolved.end()) return it->second == NONE ? npos : it->second;
+
+            size_t index = layers.size();
+            while (index > 0 && !layers[index - 1].source->contains(name)) --index;
+            // Names that no layer has are cached too; bound that by the data.
+            if (resolved.size() >= 2 * entryCount() + 1024) resolved.clear();
+            resolved.emplace(name, index == 0 ? NONE : static_cast<uint32_t>(index - 1));
+            return index == 0 ? npos : index - 1;
+        }
+
+        // Visits every name once with its effective value and layer, lowest
+        // layer first and in each layer's order.
+        template <typename Fn>
+        void forEach(Fn fn) const {
+            for (size_t index = 0; index < layers.size(); ++index) {
+                for (const auto& obj : static_cast<const ConfigManager&>(*layers[index].source)) {
+                    if (find(obj.name) == &obj.value) fn(obj.name, obj.value, index);
+                }
+            }
+        }
+
+        // Changes to a layer
+        void set(size_t index, const std::string& name, const std::string& value) {
+            at(index).source->set(name, value);
+            resolved.erase(name);
+        }
+
+        bool remove(size_t index, const std::string& name) {
+            bool removed = at(index).source->removeByName(name);
+            if (removed) resolved.erase(name);
+            return removed;
+        }
+
+        // Re-reads a file or environment layer.
+        bool reload(size_t index) {
+            Layer& l = at(index);
+            if (l.path.empty() && !l.from_env) return false;
+            auto fresh = std::make_shared<ConfigManager>();
+            if (l.from_env) readEnvironment(*fresh, l.env_prefix);
+            else if (!fresh->loadFile(l.path)) return false;
+            dropNames(index);
+            l.source = std::move(fresh);
+            dropNames(index);
+            return true;
+        }
+
+        void replaceLayer(size_t index, std::shared_ptr<ConfigManager> source) {
+            if (!source) throw std::invalid_argument("Null config layer: " + at(index).name);
+            dropNames(index);
+            at(index).source = std::move(source);
+            at(index).path.clear();
+            at(index).from_env = false;
+            dropNames(index);
+        }
+
+        // For layers changed behind the overlay's back.
+        void invalidate(const std::string& name) { resolved.erase(name); }
+        void invalidate() { resolved.clear(); }
+
+    private:
+        struct Layer {
+            std::string name;
+            std::string path;
+            std::shared_ptr<ConfigManager> source;
+            std::string env_prefix;
+            bool from_env = false;
+        };
+
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        std::vector<Layer> layers;
+        mutable std::unordered_map<std::string, uint32_t> resolved;   // name -> layer, NONE if absent
+
+        Layer& at(size_t index) {
+            if (index >= layers.size()) throw std::out_of_range("Layer index out of range");
+            return layers[index];
+        }
+        const Layer& at(size_t index) const {
+            if (index >= layers.size()) throw std::out_of_range("Layer index out of range");
+            return layers[index];
+        }
+
+        size_t entryCount() const {
+            size_t count = 0;
+            for (const auto& l : layers) count += l.source->size();
+            return count;
+        }
+
+        // Forgets the resolution of every name the layer holds.
+        void dropNames(size_t index) {
+            if (resolved.empty()) return;
+            for (const auto& obj : static_cast<const ConfigManager&>(*layers[index].source)) resolved.erase(obj.name);
+        }
+
+        static void readEnvironment(ConfigManager& out, const std::string& prefix) {
+#if defined(_WIN32)
+            char** env = _environ;
+#else
+            char** env = environ;
+#endif
+            for (; env && *env; ++env) {
+                std::string entry(*env);
+                size_t eq = entry.find('=');
+                if (eq == std::string::npos || eq <= prefix.size() || entry.compare(0, prefix.size(), prefix) != 0) continue;
+                std::string name = entry.substr(prefix.size(), eq - prefix.size());
+                for (char& c : name) {
+                    if (c == '_') c = '.';
+                    else if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+                }
+                out.set(name, entry.substr(eq + 1));
+            }
+        }
+    };
+}
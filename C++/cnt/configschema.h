@@ -0,0 +1,389 @@
+/**
+ * @file cnt/configschema.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio), 
+ * and according to the project license (MIT license) agreement, 
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team. 
+ * At the same time, 
+ * project and documents can be used for commercial purposes under the condition of informing the development source, 
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time, 
+ * and any form of dispute event, CNT Development Team. 
+ * and APlcexicesetrl shall not be liable for any damages, 
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+/* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <array>
+#include <tuple>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <cstdio>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "config.h"
+
+/*
+ * Declares a key for a ConfigSchema: its C++ name, config name, type and
+ * default, e.g.
+ *
+ *     struct Keys {
+ *         CNT_CONFIG_KEY(DbHost, "db.host", std::string, "localhost");
+ *         CNT_CONFIG_KEY(DbPort, "db.port", int, 5432);
+ *     };
+ *
+ * Supported types are std::string, bool, the integer types and the
+ * floating-point types.
+ */
+#define CNT_CONFIG_KEY(Id, Name, Type, ...)                                 \
+    struct Id {                                                             \
+        using type = Type;                                                  \
+        static constexpr std::string_view name = Name;                      \
+        static type defaultValue() { return type(__VA_ARGS__); }            \
+    }
+
+namespace cnt {
+    namespace detail {
+        constexpr uint64_t schemaHash(std::string_view text, uint64_t seed) {
+            uint64_t hash = 14695981039346656037ull ^ (seed * 0x9E3779B97F4A7C15ull);
+            for (char c : text) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ull;
+            }
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdull;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        constexpr size_t schemaPow2(size_t n) {
+            size_t p = 1;
+            while (p < n) p <<= 1;
+            return p;
+        }
+
+        // Hash-and-displace perfect hash: a name's bucket picks the seed of
+        // its second hash, which lands on a table slot no other name uses.
+        template <size_t N>
+        struct SchemaHash {
+            static constexpr size_t buckets = schemaPow2(N) / 2 ? schemaPow2(N) / 2 : 1;
+            static constexpr size_t slots = schemaPow2(N) * 2;
+
+            std::array<uint32_t, buckets> displacement{};
+            std::array<uint16_t, slots> table{};   // key index + 1, 0 if empty
+            bool ok = false;                       // false on duplicate names
+
+            constexpr size_t find(std::string_view name) const {
+                const uint32_t d = displacement[schemaHash(name, 0) & (buckets - 1)];
+                return static_cast<size_t>(table[schemaHash(name, d) & (slots - 1)]) - 1;
+            }
+        };
+
+        template <size_t N>
+        constexpr SchemaHash<N> buildSchemaHash(const std::array<std::string_view, N>& names) {
+            using Hash = SchemaHash<N>;
+            Hash hash{};
+            for (size_t i = 0; i < N; ++i) {
+                for (size_t j = i + 1; j < N; ++j) {
+                    if (names[i] == names[j]) return hash;
+                }
+            }
+
+            std::array<size_t, N> bucket_of{};
+            std::array<size_t, Hash::buckets> count{};
+            for (size_t i = 0; i < N; ++i) {
+                bucket_of[i] = schemaHash(names[i], 0) & (Hash::buckets - 1);
+                ++count[bucket_of[i]];
+            }
+            // Fullest buckets first, while the table is still empty.
+            std::array<size_t, Hash::buckets> order{};
+            for (size_t b = 0; b < Hash::buckets; ++b) order[b] = b;
+            for (size_t b = 1; b < Hash::buckets; ++b) {
+                for (size_t k = b; k > 0 && count[order[k - 1]] < count[order[k]]; --k) {
+                    size_t t = order[k];
+                    order[k] = order[k - 1];
+                    order[k - 1] = t;
+                }
+            }
+
+            for (size_t b : order) {
+                if (count[b] == 0) break;
+                std::array<size_t, N> keys{}, slots{};
+                for (uint32_t d = 1;; ++d) {
+                    if (d == (1u << 20)) return hash;
+                    size_t placed = 0;
+                    for (size_t i = 0; i < N; ++i) {
+                        if (bucket_of[i] != b) continue;
+                        size_t slot = schemaHash(names[i], d) & (Hash::slots - 1);
+                        bool taken = hash.table[slot] != 0;
+                        for (size_t k = 0; k < placed && !taken; ++k) taken = slots[k] == slot;
+                        if (taken) break;
+                        keys[placed] = i;
+                        slots[placed] = slot;
+                        ++placed;
+                    }
+                    if (placed != count[b]) continue;
+                    for (size_t k = 0; k < placed; ++k) hash.table[slots[k]] = static_cast<uint16_t>(keys[k] + 1);
+                    hash.displacement[b] = d;
+                    break;
+                }
+            }
+            hash.ok = true;
+            return hash;
+        }
+
+        // Conversions between config text and schema types. Text that does
+        // not convert throws std::invalid_argument.
+        [[noreturn]] inline void badSchemaValue(std::string_view name, const std::string& text) {
+            throw std::invalid_argument("Invalid value for config key " + std::string(name) + ": " + text);
+        }
+
+        inline void parseSchemaValue(std::string_view, const std::string& text, std::string& out) {
+            out = text;
+        }
+
+        inline void parseSchemaValue(std::string_view name, const std::string& text, bool& out) {
+            if (text == "true" || text == "1" || text == "yes" || text == "on") out = true;
+            else if (text == "false" || text == "0" || text == "no" || text == "off") out = false;
+            else badSchemaValue(name, text);
+        }
+
+        template <typename T>
+        std::enable_if_t<std::is_integral_v<T>> parseSchemaValue(std::string_view name, const std::string& text, T& out) {
+            const char* end = text.data() + text.size();
+            auto result = std::from_chars(text.data(), end, out);
+            if (result.ec != std::errc() || result.ptr != end) badSchemaValue(name, text);
+        }
+
+        template <typename T>
+        std::enable_if_t<std::is_floating_point_v<T>> parseSchemaValue(std::string_view name, const std::string& text, T& out) {
+            char* end = nullptr;
+            errno = 0;
+            long double value = std::strtold(text.c_str(), &end);
+            if (text.empty() || errno == ERANGE || end != text.c_str() + text.size()) badSchemaValue(name, text);
+            out = static_cast<T>(value);
+        }
+
+        inline std::string formatSchemaValue(const std::string& value) { return value; }
+        inline std::string formatSchemaValue(bool value) { return value ? "true" : "false"; }
+
+        template <typename T>
+        std::enable_if_t<std::is_integral_v<T>, std::string> formatSchemaValue(T value) {
+            return std::to_string(value);
+        }
+
+        template <typename T>
+        std::enable_if_t<std::is_floating_point_v<T>, std::string> formatSchemaValue(T value) {
+            // The shortest text that reads back as the same value.
+            char text[64];
+            for (int digits = std::numeric_limits<T>::digits10; ; ++digits) {
+                std::snprintf(text, sizeof(text), "%.*Lg", digits, static_cast<long double>(value));
+                if (digits >= std::numeric_limits<T>::max_digits10 || static_cast<T>(std::strtold(text, nullptr)) == value) break;
+            }
+            return text;
+        }
+    }
+
+    /*
+     * A set of keys known at compile time. Each key has a dense slot, its
+     * position in the list, and names map to slots through a perfect hash
+     * generated at compile time: one hash, one table probe and one string
+     * compare, whether or not the name is in the schema.
+     */
+    template <typename... Keys>
+    class ConfigSchema {
+    public:
+        static_assert(sizeof...(Keys) > 0, "A config schema needs at least one key");
+        static_assert(sizeof...(Keys) < 65535, "Too many keys in a config schema");
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+        static constexpr size_t size = sizeof...(Keys);
+        static constexpr std::array<std::string_view, size> names{{Keys::name...}};
+
+        template <typename Key>
+        static constexpr bool contains = (std::is_same_v<Key, Keys> || ...);
+
+        template <typename Key>
+        static constexpr size_t slot() {
+            static_assert(contains<Key>, "Key is not part of this config schema");
+            constexpr bool matches[] = {std::is_same_v<Key, Keys>...};
+            size_t index = 0;
+            while (!matches[index]) ++index;
+            return index;
+        }
+
+        // Slot of name, npos if the name is not in the schema.
+        static constexpr size_t find(std::string_view name) {
+            size_t index = hash.find(name);
+            return index < size && names[index] == name ? index : npos;
+        }
+
+    private:
+        static constexpr detail::SchemaHash<size> hash = detail::buildSchemaHash(names);
+        static_assert(hash.ok, "Config schema key names must be unique");
+    };
+
+    template <typename Schema>
+    class SchemaConfig;
+
+    /*
+     * A ConfigManager with typed, slot-indexed access to the keys of a
+     * schema: get<Keys::DbPort>() reads a member of a tuple, with no string
+     * compare or conversion. The values are converted when the manager is
+     * loaded or refreshed and when a key is set through this class; keys
+     * missing from the configuration read as their defaults.
+     *
+     * Every entry, in the schema or not, stays in the ConfigManager, which
+     * serves the dynamic lookups and saves. A manager modified directly needs
+     * refresh().
+     *
+     * Like ConfigManager, a SchemaConfig is not safe for concurrent use.
+     */
+    template <typename... Keys>
+    class SchemaConfig<ConfigSchema<Keys...>> {
+    public:
+        using Schema = ConfigSchema<Keys...>;
+
+        explicit SchemaConfig(std::shared_ptr<ConfigManager> config = std::make_shared<ConfigManager>())
+            : source(std::move(config)) {
+            if (!source) throw std::invalid_argument("Null config manager");
+            refresh();
+        }
+
+        // Throws std::invalid_argument if a schema key holds text of the wrong type.
+        bool loadFile(const std::string& filename) {
+            if (!source->loadFile(filename)) return false;
+            refresh();
+            return true;
+        }
+
+        // Typed access
+        template <typename Key>
+        const typename Key::type& get() const {
+            return std::get<Schema::template slot<Key>()>(values);
+        }
+
+        // False when the key reads as its default because the configuration lacks it.
+        template <typename Key>
+        bool isSet() const {
+            return present[Schema::template slot<Key>()];
+        }
+
+        template <typename Key>
+        void set(const typename Key::type& value) {
+            constexpr size_t index = Schema::template slot<Key>();
+            source->set(std::string(Key::name), detail::formatSchemaValue(value));
+            std::get<index>(values) = value;
+            present[index] = true;
+        }
+
+        // Dynamic access by name
+        const std::string& operator[](const std::string& name) const {
+            const ConfigManager& config = *source;
+            return config[name];
+        }
+
+        std::string getValue(const std::string& name) const { return source->getValue(name); }
+        bool contains(const std::string& name) const { return source->contains(name); }
+
+        void set(const std::string& name, const std::string& value) {
+            size_t index = Schema::find(name);
+            if (index != Schema::npos) {
+                Values parsed = values;
+                assigners[index](parsed, value);
+                source->set(name, value);
+                values = std::move(parsed);
+                present[index] = true;
+            }
+            else {
+                source->set(name, value);
+            }
+        }
+
+        bool remove(const std::string& name) {
+            if (!source->removeByName(name)) return false;
+            refresh(name);
+            return true;
+        }
+
+        // Re-reads every schema key from the manager.
+        void refresh() {
+            Values parsed{Keys::defaultValue()...};
+            std::array<bool, Schema::size> seen{};
+            const ConfigManager& config = *source;
+            for (const auto& obj : config) {
+                size_t index = Schema::find(obj.name);
+                if (index == Schema::npos || seen[index]) continue;
+                assigners[index](parsed, obj.value);
+                seen[index] = true;
+            }
+            values = std::move(parsed);
+            present = seen;
+        }
+
+        // Re-reads one key; names outside the schema are ignored.
+        void refresh(const std::string& name) {
+            size_t index = Schema::find(name);
+            if (index == Schema::npos) return;
+            Values parsed = values;
+            resetters[index](parsed);
+            const bool found = source->contains(name);
+            if (found) {
+                const ConfigManager& config = *source;
+                assigners[index](parsed, config[name]);
+            }
+            values = std::move(parsed);
+            present[index] = found;
+        }
+
+        ConfigManager& manager() { return *source; }
+        const ConfigManager& manager() const { return *source; }
+
+    private:
+        using Values = std::tuple<typename Keys::type...>;
+        using Assign = void (*)(Values&, const std::string&);
+        using Reset = void (*)(Values&);
+
+        template <size_t I>
+        using KeyAt = std::tuple_element_t<I, std::tuple<Keys...>>;
+
+        template <size_t I>
+        static void assignSlot(Values& out, const std::string& text) {
+            detail::parseSchemaValue(KeyAt<I>::name, text, std::get<I>(out));
+        }
+
+        template <size_t I>
+        static void resetSlot(Values& out) {
+            std::get<I>(out) = KeyAt<I>::defaultValue();
+        }
+
+        template <size_t... I>
+        static constexpr std::array<Assign, sizeof...(I)> makeAssigners(std::index_sequence<I...>) {
+            return {{&assignSlot<I>...}};
+        }
+
+        template <size_t... I>
+        static constexpr std::array<Reset, sizeof...(I)> makeResetters(std::index_sequence<I...>) {
+            return {{&resetSlot<I>...}};
+        }
+
+        static constexpr std::array<Assign, Schema::size> assigners = makeAssigners(std::index_sequence_for<Keys...>());
+        static constexpr std::array<Reset, Schema::size> resetters = makeResetters(std::index_sequence_for<Keys...>());
+
+        std::shared_ptr<ConfigManager> source;
+        Values values;
+        std::array<bool, Schema::size> present{};
+    };
+}
@@ -0,0 +1,377 @@
+/**
+ * @file cnt/configshm.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio), 
+ * and according to the project license (MIT license) agreement, 
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team. 
+ * At the same time, 
+ * project and documents can be used for commercial purposes under the condition of informing the development source, 
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time, 
+ * and any form of dispute event, CNT Development Team. 
+ * and APlcexicesetrl shall not be liable for any damages, 
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+/* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "config.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cnt {
+    /*
+     * Configuration snapshots in POSIX shared memory, for pre-forked workers
+     * that would otherwise each parse the same file into their own heap.
+     *
+     * A ConfigPublisher writes each snapshot once, into a shared-memory
+     * object of its own ("<name>.<generation>") that is never modified
+     * afterwards, and then bumps the generation in a small control object
+     * ("<name>"). A SharedConfig maps the current snapshot read-only and
+     * answers lookups from it in place: a hash directory over a string pool,
+     * no parsing and no copies. Updates take no locks on either side;
+     * readers notice them with one atomic load and move over in refresh(),
+     * and a replaced snapshot stays mapped for the readers still on it.
+     */
+    namespace detail {
+        struct ShmControl {
+            char magic[8];                      // "CNTSHMC1"
+            std::atomic<uint64_t> generation;   // 0 until the first publish
+        };
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared config needs lock-free 64-bit atomics");
+
+        struct ShmSnapshotHeader {
+            char magic[8];          // "CNTSHMS1"
+            uint64_t generation;
+            uint64_t total_size;
+            uint32_t count;         // entries, in the manager's order
+            uint32_t dir_size;      // directory slots, a power of two
+            uint64_t entries_offset;
+            uint64_t dir_offset;
+            uint64_t pool_offset;
+        };
+
+        struct ShmEntry {
+            uint64_t hash;
+            uint32_t name_offset;   // into the pool; strings are NUL-terminated
+            uint32_t name_size;
+            uint32_t value_offset;
+            uint32_t value_size;
+        };
+
+        inline std::string shmSnapshotName(const std::string& name, uint64_t generation) {
+            return name + "." + std::to_string(generation);
+        }
+
+        inline size_t shmAlign(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+    }
+
+    class ConfigPublisher {
+    public:
+        // name is a shared-memory name such as "/myapp-config". Opening an
+        // existing control object continues its generation count.
+        explicit ConfigPublisher(const std::string& name) : shm_name(name) {
+            int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd < 0) throw std::runtime_error("Failed to open shared memory: " + name);
+            struct stat st;
+            if (fstat(fd, &st) != 0 || (static_cast<size_t>(st.st_size) < sizeof(detail::ShmControl) &&
+                                        ftruncate(fd, sizeof(detail::ShmControl)) != 0)) {
+                ::close(fd);
+                throw std::runtime_error("Failed to size shared memory: " + name);
+            }
+            void* p = mmap(nullptr, sizeof(detail::ShmControl), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (p == MAP_FAILED) throw std::runtime_error("Failed to map shared memory: " + name);
+            control = static_cast<detail::ShmControl*>(p);
+            if (std::memcmp(control->magic, "CNTSHMC1", 8) != 0) {
+                control->generation.store(0, std::memory_order_relaxed);
+                std::memcpy(control->magic, "CNTSHMC1", 8);
+            }
+        }
+
+        ~ConfigPublisher() {
+            munmap(control, sizeof(detail::ShmControl));
+        }
+
+        ConfigPublisher(const ConfigPublisher&) = delete;
+        ConfigPublisher& operator=(const ConfigPublisher&) = delete;
+
+        // Writes config as a new snapshot, makes it current and returns its
+        // generation. Where a name repeats, the first entry wins, as in
+        // ConfigManager lookups. Throws std::runtime_error on failure.
+        uint64_t publish(const ConfigManager& config) {
+            CNT_SCOPED_TIMER("config.shm.publish");
+            const uint64_t previous = control->generation.load(std::memory_order_acquire);
+            const uint64_t generation = previous + 1;
+
+            // Unique names in order, and the size of the image.
+            std::vector<const ConfigObject*> objects;
+            std::unordered_set<std::string_view> seen;
+            size_t pool_size = 0;
+            for (const auto& obj : config) {
+                if (!seen.insert(obj.name).second) continue;
+                if (obj.name.size() >= UINT32_MAX || obj.value.size() >= UINT32_MAX) throw std::runtime_error("Config entry too large for shared memory");
+                objects.push_back(&obj);
+                pool_size += obj.name.size() + obj.value.size() + 2;
+            }
+            uint32_t dir_size = 8;
+            while (dir_size < objects.size() * 2) dir_size <<= 1;
+
+            detail::ShmSnapshotHeader header{};
+            std::memcpy(header.magic, "CNTSHMS1", 8);
+            header.generation = generation;
+            header.count = static_cast<uint32_t>(objects.size());
+            header.dir_size = dir_size;
+            header.entries_offset = detail::shmAlign(sizeof(header));
+            header.dir_offset = detail::shmAlign(header.entries_offset + objects.size() * sizeof(detail::ShmEntry));
+            header.pool_offset = detail::shmAlign(header.dir_offset + dir_size * sizeof(uint32_t));
+            header.total_size = header.pool_offset + pool_size;
+            if (pool_size >= UINT32_MAX) throw std::runtime_error("Config too large for shared memory");
+
+            const std::string snapshot = detail::shmSnapshotName(shm_name, generation);
+            shm_unlink(snapshot.c_str());   // left over from a publisher that died mid-publish
+            int fd = shm_open(snapshot.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+            if (fd < 0) throw std::runtime_error("Failed to create shared memory: " + snapshot);
+            void* p = MAP_FAILED;
+            if (ftruncate(fd, static_cast<off_t>(header.total_size)) == 0) {
+                p = mmap(nullptr, header.total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            ::close(fd);
+            if (p == MAP_FAILED) {
+                shm_unlink(snapshot.c_str());
+                throw std::runtime_error("Failed to map shared memory: " + snapshot);
+            }
+
+            // Fresh shared memory reads as zeros: the directory starts empty.
+            char* base = static_cast<char*>(p);
+            auto* entries = reinterpret_cast<detail::ShmEntry*>(base + header.entries_offset);
+            auto* dir = reinterpret_cast<uint32_t*>(base + header.dir_offset);
+            char* pool = base + header.pool_offset;
+            size_t used = 0;
+            const auto put = [&](const std::string& text) {
+                std::memcpy(pool + used, text.data(), text.size());
+                pool[used + text.size()] = '\0';
+                used += text.size() + 1;
+                return static_cast<uint32_t>(used - text.size() - 1);
+            };
+            for (uint32_t i = 0; i < header.count; ++i) {
+                const ConfigObject& obj = *objects[i];
+                detail::ShmEntry& entry = entries[i];
+                entry.hash = detail::fnv1a64(obj.name.data(), obj.name.size());
+                entry.name_offset = put(obj.name);
+                entry.name_size = static_cast<uint32_t>(obj.name.size());
+                entry.value_offset = put(obj.value);
+                entry.value_size = static_cast<uint32_t>(obj.value.size());
+                uint32_t slot = static_cast<uint32_t>(entry.hash) & (dir_size - 1);
+                while (dir[slot] != 0) slot = (slot + 1) & (dir_size - 1);
+                dir[slot] = i + 1;
+            }
+            std::memcpy(base, &header, sizeof(header));
+            munmap(p, header.total_size);
+
+            control->generation.store(generation, std::memory_order_release);
+            // Readers still on the old snapshot keep their mapping.
+            if (previous != 0) shm_unlink(detail::shmSnapshotName(shm_name, previous).c_str());
+            return generation;
+        }
+
+        uint64_t generation() const { return control->generation.load(std::memory_order_acquire); }
+
+        // Removes the control object and the current snapshot. Attached
+        // readers keep working on what they have mapped.
+        void unlink() {
+            const uint64_t current = generation();
+            if (current != 0) shm_unlink(detail::shmSnapshotName(shm_name, current).c_str());
+            shm_unlink(shm_name.c_str());
+        }
+
+    private:
+        std::string shm_name;
+        detail::ShmControl* control = nullptr;
+    };
+
+    /*
+     * Read-only view of the snapshot a ConfigPublisher published under a
+     * name. Returned pointers and string_views point into the mapping and
+     * stay valid until refresh() moves to a newer snapshot or the view is
+     * destroyed. Lookups are safe from several threads; refresh() is not
+     * safe concurrently with them.
+     */
+    class SharedConfig {
+    public:
+        // Throws std::runtime_error if nothing has been published under name.
+        explicit SharedConfig(const std::string& name) : shm_name(name) {
+            int fd = shm_open(name.c_str(), O_RDONLY, 0);
+            if (fd < 0) throw std::runtime_error("No shared config: " + name);
+            struct stat st;
+            void* p = MAP_FAILED;
+            if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(detail::ShmControl)) {
+                p = mmap(nullptr, sizeof(detail::ShmControl), PROT_READ, MAP_SHARED, fd, 0);
+            }
+            ::close(fd);
+            if (p == MAP_FAILED) throw std::runtime_error("Invalid shared config: " + name);
+            control = static_cast<const detail::ShmControl*>(p);
+            if (std::memcmp(control->magic, "CNTSHMC1", 8) != 0 || !attach()) {
+                munmap(p, sizeof(detail::ShmControl));
+                throw std::runtime_error("No shared config: " + name);
+            }
+        }
+
+        ~SharedConfig() {
+            detach();
+            munmap(const_cast<detail::ShmControl*>(control), sizeof(detail::ShmControl));
+        }
+
+        SharedConfig(const SharedConfig&) = delete;
+        SharedConfig& operator=(const SharedConfig&) = delete;
+
+        // Generation of the mapped snapshot.
+        uint64_t generation() const { return header->generation; }
+        // True once a newer snapshot has been published.
+        bool stale() const { return control->generation.load(std::memory_order_acquire) != header->generation; }
+
+        // Moves to the newest snapshot; true if it changed. On failure the
+        // current snapshot stays mapped.
+        bool refresh() {
+            if (!stale()) return false;
+            const detail::ShmSnapshotHeader* old_header = header;
+            size_t old_size = mapped_size;
+            header = nullptr;
+            if (!attach()) {
+                header = old_header;
+                return false;
+            }
+            munmap(const_cast<detail::ShmSnapshotHeader*>(old_header), old_size);
+            return true;
+        }
+
+        // Lookups
+        // The value as a NUL-terminated string, nullptr if name is absent.
+        const char* find(std::string_view name) const {
+            const detail::ShmEntry* entry = lookup(name);
+            return entry ? pool + entry->value_offset : nullptr;
+        }
+
+        std::string_view operator[](std::string_view name) const {
+            const detail::ShmEntry* entry = lookup(name);
+            if (!entry) throw std::out_of_range("Key not found: " + std::string(name));
+            return std::string_view(pool + entry->value_offset, entry->value_size);
+        }
+
+        std::string getValue(std::string_view name) const {
+            const detail::ShmEntry* entry = lookup(name);
+            return entry ? std::string(pool + entry->value_offset, entry->value_size) : std::string();
+        }
+
+        bool contains(std::string_view name) const { return lookup(name) != nullptr; }
+        size_t size() const { return header->count; }
+
+        // Visits fn(name, value) for every entry in the published order.
+        template <typename Fn>
+        void forEach(Fn fn) const {
+            for (uint32_t i = 0; i < header->count; ++i) {
+                const detail::ShmEntry& entry = entries[i];
+                fn(std::string_view(pool + entry.name_offset, entry.name_size),
+                   std::string_view(pool + entry.value_offset, entry.value_size));
+            }
+        }
+
+        // A private, modifiable copy.
+        ConfigManager copy() const {
+            ConfigManager out;
+            forEach([&](std::string_view name, std::string_view value) { out.add(std::string(name), std::string(value)); });
+            return out;
+        }
+
+    private:
+        std::string shm_name;
+        const detail::ShmControl* control = nullptr;
+        const detail::ShmSnapshotHeader* header = nullptr;
+        size_t mapped_size = 0;
+        const detail::ShmEntry* entries = nullptr;
+        const uint32_t* dir = nullptr;
+        const char* pool = nullptr;
+
+        const detail::ShmEntry* lookup(std::string_view name) const {
+            CNT_SCOPED_TIMER("config.shm.lookup");
+            const uint64_t hash = detail::fnv1a64(name.data(), name.size());
+            const uint32_t mask = header->dir_size - 1;
+            for (uint32_t slot = static_cast<uint32_t>(hash) & mask;; slot = (slot + 1) & mask) {
+                uint32_t index = dir[slot];
+                if (index == 0) return nullptr;
+                const detail::ShmEntry& entry = entries[index - 1];
+                if (entry.hash == hash && entry.name_size == name.size() &&
+                    std::memcmp(pool + entry.name_offset, name.data(), name.size()) == 0) {
+                    return &entry;
+                }
+            }
+        }
+
+        // Maps the current snapshot. A publish can unlink it between reading
+        // the generation and opening it; then the next generation is tried.
+        bool attach() {
+            for (int attempt = 0; attempt < 100; ++attempt) {
+                const uint64_t generation = control->generation.load(std::memory_order_acquire);
+                if (generation == 0) return false;
+                int fd = shm_open(detail::shmSnapshotName(shm_name, generation).c_str(), O_RDONLY, 0);
+                if (fd < 0) {
+                    if (errno == ENOENT) continue;
+                    return false;
+                }
+                struct stat st;
+                void* p = MAP_FAILED;
+                size_t size = 0;
+                if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(detail::ShmSnapshotHeader)) {
+                    size = static_cast<size_t>(st.st_size);
+                    p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+                }
+                ::close(fd);
+                if (p == MAP_FAILED) return false;
+                const auto* h = static_cast<const detail::ShmSnapshotHeader*>(p);
+                if (!valid(h, size)) {
+                    munmap(p, size);
+                    return false;
+                }
+                const char* base = static_cast<const char*>(p);
+                header = h;
+                mapped_size = size;
+                entries = reinterpret_cast<const detail::ShmEntry*>(base + h->entries_offset);
+                dir = reinterpret_cast<const uint32_t*>(base + h->dir_offset);
+                pool = base + h->pool_offset;
+                return true;
+            }
+            return false;
+        }
+
+        static bool valid(const detail::ShmSnapshotHeader* h, size_t size) {
+            if (std::memcmp(h->magic, "CNTSHMS1", 8) != 0 || h->total_size != size) return false;
+            if (h->dir_size == 0 || (h->dir_size & (h->dir_size - 1)) != 0 || h->dir_size <= h->count) return false;
+            return h->entries_offset + static_cast<uint64_t>(h->count) * sizeof(detail::ShmEntry) <= h->dir_offset &&
+                   h->dir_offset + static_cast<uint64_t>(h->dir_size) * sizeof(uint32_t) <= h->pool_offset &&
+                   h->pool_offset <= size;
+        }
+
+        void detach() {
+            if (header) munmap(const_cast<detail::ShmSnapshotHeader*>(header), mapped_size);
+            header = nullptr;
+        }
+    };
+}
+#endif
@@ -18,20 +18,32 @@
 
 #pragma once
 
-#include <Windows.h>
 #include <string>
 
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
 #include "loggings.h"
+#include "terminal.h"
 
+/*
+ * Console front end. Text, colours and cursor moves are drawn into a
+ * cnt::TerminalRenderer and reach the terminal when present() is called,
+ * so a full dashboard redraw costs one write of only the changed cells.
+ */
 class console {
 private:
 	typedef std::wstring String;
 public:
-	console();
+	explicit console(const std::string& defaultLoggerName = "root");
 	~console();
 
+	console(const console&) = delete;
+	console& operator=(const console&) = delete;
 
 	// Object
+	cnt::Logger logger;
 	cnt::Logging logging;
 
 	// Function
@@ -47,11 +59,95 @@ public:
 
 	void setCursorPosition(int, int);
 	void getCursorPosition(int&, int&);
+
+	// Draw text at the cursor with the current colours and advance the cursor.
+	void print(const std::string&);
+	// Send everything drawn since the last call to the terminal.
+	cnt::TerminalRenderer::FrameStats present();
+
+	cnt::TerminalRenderer& screen() { return screen_; }
+
+private:
+	cnt::TerminalRenderer screen_;
+	String title_;
+	uint8_t textColor_ = cnt::TerminalRenderer::DEFAULT_COLOR;
+	uint8_t backgroundColor_ = cnt::TerminalRenderer::DEFAULT_COLOR;
+	int cursorX_ = 0;
+	int cursorY_ = 0;
 };
 
-console::console(String defaultLoggerName) : logging(new cnt::Logger(defaultLoggerName)) {}
+inline console::console(const std::string& defaultLoggerName)
+	: logger(defaultLoggerName), logging(&logger) {}
+
+inline console::~console() {
+	screen_.writeRaw("\033[0m\033[?25h");
+}
+
+inline void console::setTitle(String title) {
+	title_ = title;
+#if defined(_WIN32)
+	SetConsoleTitleW(title_.c_str());
+#else
+	std::string utf8 = "\033]0;";
+	for (wchar_t wc : title_) {
+		cnt::TerminalRenderer::appendUtf8(utf8, static_cast<char32_t>(wc));
+	}
+	utf8 += '\a';
+	screen_.writeRaw(utf8);
+#endif
+}
+
+inline console::String console::getTitle() {
+	return title_;
+}
+
+inline void console::setConsoleColor(int color) {
+	backgroundColor_ = static_cast<uint8_t>(color);
+}
 
-void console::clear() {
-	system("cls");
+inline void console::resetConsoleColor() {
+	backgroundColor_ = cnt::TerminalRenderer::DEFAULT_COLOR;
 }
 
+inline void console::setConsoleTextColor(int color) {
+	textColor_ = static_cast<uint8_t>(color);
+}
+
+inline void console::resetConsoleTextColor() {
+	textColor_ = cnt::TerminalRenderer::DEFAULT_COLOR;
+}
+
+inline void console::clear() {
+	screen_.clear(textColor_, backgroundColor_);
+	setCursorPosition(0, 0);
+	present();
+}
+
+inline void console::setCursorPosition(int x, int y) {
+	cursorX_ = x;
+	cursorY_ = y;
+	screen_.setCursor(x, y);
+}
+
+inline void console::getCursorPosition(int& x, int& y) {
+	x = cursorX_;
+	y = cursorY_;
+}
+
+inline void console::print(const std::string& text) {
+	size_t start = 0;
+	while (start <= text.size()) {
+		size_t end = text.find('\n', start);
+		std::string_view line(text.data() + start, (end == std::string::npos ? text.size() : end) - start);
+		cursorX_ = screen_.print(cursorX_, cursorY_, line, textColor_, backgroundColor_);
+		if (end == std::string::npos) break;
+		cursorX_ = 0;
+		++cursorY_;
+		start = end + 1;
+	}
+	screen_.setCursor(cursorX_, cursorY_);
+}
+
+inline cnt::TerminalRenderer::FrameStats console::present() {
+	return screen_.present();
+}
@@ -0,0 +1,237 @@
+/**
+ * @file cnt/crc32c.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio), 
+ * and according to the project license (MIT license) agreement, 
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team. 
+ * At the same time, 
+ * project and documents can be used for commercial purposes under the condition of informing the development source, 
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time, 
+ * and any form of dispute event, CNT Development Team. 
+ * and APlcexicesetrl shall not be liable for any damages, 
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+ /* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * CRC-32C (Castagnoli), the checksum of the binary config, journal and vault
+ * formats.
+ *
+ * On x86 the SSE4.2 crc32 instruction is used when the CPU has it (checked on
+ * first use): three independent streams over 8 KiB slices keep the
+ * instruction's pipeline full and are combined with a shift by x^(8*8192),
+ * which runs at several bytes per cycle. ARMv8 builds with the CRC extension
+ * use its instructions; everything else uses slicing-by-8 tables.
+ * set_hardware(false) forces the tables, e.g. for benchmarking.
+ */
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CNT_CRC32C_X86 1
+#include <nmmintrin.h>
+#define CNT_CRC32C_TARGET __attribute__((target("sse4.2")))
+#else
+#define CNT_CRC32C_X86 0
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace cnt {
+namespace crc32c {
+	namespace detail {
+		constexpr uint32_t POLY = 0x82F63B78u;   // reflected
+
+		struct tables {
+			uint32_t t[8][256];
+		};
+
+		constexpr tables make_tables() {
+			tables out{};
+			for (uint32_t i = 0; i < 256; ++i) {
+				uint32_t c = i;
+				for (int k = 0; k < 8; ++k) c = (c & 1) ? (c >> 1) ^ POLY : c >> 1;
+				out.t[0][i] = c;
+			}
+			for (int s = 1; s < 8; ++s) {
+				for (uint32_t i = 0; i < 256; ++i) out.t[s][i] = (out.t[s - 1][i] >> 8) ^ out.t[0][out.t[s - 1][i] & 0xff];
+			}
+			return out;
+		}
+
+		inline const tables& table() {
+			static constexpr tables value = make_tables();
+			return value;
+		}
+
+		// Slicing-by-8 over the raw (un-inverted) register.
+		inline uint32_t table_update(uint32_t crc, const uint8_t* p, size_t n) {
+			const auto& t = table().t;
+			while (n && (reinterpret_cast<uintptr_t>(p) & 7)) {
+				crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+				--n;
+			}
+			while (n >= 8) {
+				uint32_t lo, hi;
+				std::memcpy(&lo, p, 4);
+				std::memcpy(&hi, p + 4, 4);
+				lo ^= crc;
+				crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+					  t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+				p += 8;
+				n -= 8;
+			}
+			while (n--) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+			return crc;
+		}
+
+		// a * b modulo the polynomial, bit-reflected (as in zlib's crc32_combine).
+		inline uint32_t multiply(uint32_t a, uint32_t b) {
+			uint32_t m = 1u << 31, product = 0;
+			for (;;) {
+				if (a & m) {
+					product ^= b;
+					if ((a & (m - 1)) == 0) break;
+				}
+				m >>= 1;
+				b = (b & 1) ? (b >> 1) ^ POLY : b >> 1;
+			}
+			return product;
+		}
+
+		// x^(8 * bytes): multiplying a register by it is the same as feeding it that many zero bytes.
+		inline uint32_t shift_factor(size_t bytes) {
+			uint32_t square = 1u << 30;   // x^1
+			uint32_t result = 1u << 31;   // x^0
+			for (size_t n = bytes * 8; n; n >>= 1) {
+				if (n & 1) result = multiply(square, result);
+				square = multiply(square, square);
+			}
+			return result;
+		}
+
+#if CNT_CRC32C_X86
+		constexpr size_t SLICE = 8192;
+
+		CNT_CRC32C_TARGET inline uint32_t sse42_update(uint32_t crc, const uint8_t* p, size_t n) {
+			while (n && (reinterpret_cast<uintptr_t>(p) & 7)) {
+				crc = _mm_crc32_u8(crc, *p++);
+				--n;
+			}
+#if defined(__x86_64__)
+			if (n >= 3 * SLICE) {
+				static const uint32_t factor = shift_factor(SLICE);
+				do {
+					uint64_t c0 = crc, c1 = 0, c2 = 0;
+					for (size_t i = 0; i < SLICE; i += 8) {
+						uint64_t w0, w1, w2;
+						std::memcpy(&w0, p + i, 8);
+						std::memcpy(&w1, p + SLICE + i, 8);
+						std::memcpy(&w2, p + 2 * SLICE + i, 8);
+						c0 = _mm_crc32_u64(c0, w0);
+						c1 = _mm_crc32_u64(c1, w1);
+						c2 = _mm_crc32_u64(c2, w2);
+					}
+					crc = multiply(factor, multiply(factor, static_cast<uint32_t>(c0)) ^ static_cast<uint32_t>(c1)) ^
+						  static_cast<uint32_t>(c2);
+					p += 3 * SLICE;
+					n -= 3 * SLICE;
+				} while (n >= 3 * SLICE);
+			}
+			uint64_t c = crc;
+			while (n >= 8) {
+				uint64_t w;
+				std::memcpy(&w, p, 8);
+				c = _mm_crc32_u64(c, w);
+				p += 8;
+				n -= 8;
+			}
+			crc = static_cast<uint32_t>(c);
+#else
+			while (n >= 4) {
+				uint32_t w;
+				std::memcpy(&w, p, 4);
+				crc = _mm_crc32_u32(crc, w);
+				p += 4;
+				n -= 4;
+			}
+#endif
+			while (n--) crc = _mm_crc32_u8(crc, *p++);
+			return crc;
+		}
+
+		inline bool detect() {
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("sse4.2");
+		}
+#elif defined(__ARM_FEATURE_CRC32)
+		inline uint32_t arm_update(uint32_t crc, const uint8_t* p, size_t n) {
+			while (n >= 8) {
+				uint64_t w;
+				std::memcpy(&w, p, 8);
+				crc = __crc32cd(crc, w);
+				p += 8;
+				n -= 8;
+			}
+			while (n--) crc = __crc32cb(crc, *p++);
+			return crc;
+		}
+
+		inline bool detect() { return true; }
+#else
+		inline bool detect() { return false; }
+#endif
+
+		inline std::atomic<bool>& use_hardware() {
+			static std::atomic<bool> value{ detect() };
+			return value;
+		}
+	}
+
+	// Whether the CPU path is available and whether it is in use.
+	inline bool hardware_available() {
+		static const bool value = detail::detect();
+		return value;
+	}
+
+	inline bool hardware() { return detail::use_hardware().load(std::memory_order_relaxed); }
+
+	inline void set_hardware(bool enable) {
+		detail::use_hardware().store(enable && hardware_available(), std::memory_order_relaxed);
+	}
+
+	inline const char* implementation() {
+		if (!hardware()) return "table";
+#if CNT_CRC32C_X86
+		return "sse4.2";
+#else
+		return "armv8";
+#endif
+	}
+
+	// CRC-32C of the bytes that gave crc followed by data; extend(0, ...) starts afresh.
+	inline uint32_t extend(uint32_t crc, const void* data, size_t size) {
+		const uint8_t* p = static_cast<const uint8_t*>(data);
+		crc = ~crc;
+#if CNT_CRC32C_X86
+		if (hardware()) return ~detail::sse42_update(crc, p, size);
+#elif defined(__ARM_FEATURE_CRC32)
+		if (hardware()) return ~detail::arm_update(crc, p, size);
+#endif
+		return ~detail::table_update(crc, p, size);
+	}
+
+	inline uint32_t value(const void* data, size_t size) { return extend(0, data, size); }
+}
+}
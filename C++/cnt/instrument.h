@@ -0,0 +1,449 @@
+/**
+ * @file cnt/instrument.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio),
+ * and according to the project license (MIT license) agreement,
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team.
+ * At the same time,
+ * project and documents can be used for commercial purposes under the condition of informing the development source,
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time,
+ * and any form of dispute event, CNT Development Team.
+ * and APlcexicesetrl shall not be liable for any damages,
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+ /* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+ * Opt-in latency and volume instrumentation for the CNT headers.
+ *
+ * Define CNT_ENABLE_INSTRUMENTATION to 1 before including any CNT header (or
+ * on the compiler command line) to turn it on. Otherwise the CNT_* macros below
+ * expand to nothing and instrumented code is identical to uninstrumented code;
+ * the snapshot API still exists and simply reports nothing.
+ *
+ *   CNT_SCOPED_TIMER("config.lookup");        // latency histogram of the scope
+ *   CNT_COUNTER_ADD("logging.log.bytes", n);   // monotonically increasing counter
+ *
+ * Names must be string literals (or otherwise outlive the program). Every
+ * thread records into its own histograms and counters with plain relaxed
+ * stores, so the hot path takes no lock and shares no cache line; snapshot()
+ * merges all threads, including ones that have already exited. Values are
+ * cumulative since process start.
+ */
+#ifndef CNT_ENABLE_INSTRUMENTATION
+#define CNT_ENABLE_INSTRUMENTATION 0
+#endif
+
+#define CNT_INSTRUMENT_CAT_(a, b) a##b
+#define CNT_INSTRUMENT_CAT(a, b) CNT_INSTRUMENT_CAT_(a, b)
+
+#if CNT_ENABLE_INSTRUMENTATION
+#define CNT_SCOPED_TIMER(name)                                                                                   \
+    static ::cnt::instrument::Metric& CNT_INSTRUMENT_CAT(cntMetric_, __LINE__) =                               \
+        ::cnt::instrument::Registry::instance().metric(name, ::cnt::instrument::MetricKind::TIMER);            \
+    ::cnt::instrument::ScopedTimer CNT_INSTRUMENT_CAT(cntTimer_, __LINE__)(CNT_INSTRUMENT_CAT(cntMetric_, __LINE__))
+#define CNT_COUNTER_ADD(name, n)                                                                                 \
+    do {                                                                                                         \
+        static ::cnt::instrument::Metric& cntCounter_ =                                                          \
+            ::cnt::instrument::Registry::instance().metric(name, ::cnt::instrument::MetricKind::COUNTER);      \
+        ::cnt::instrument::Registry::instance().add(cntCounter_, static_cast<uint64_t>(n));                    \
+    } while (0)
+#else
+#define CNT_SCOPED_TIMER(name) ((void)0)
+#define CNT_COUNTER_ADD(name, n) ((void)0)
+#endif
+
+namespace cnt
+{
+    namespace instrument
+    {
+        enum class MetricKind
+        {
+            TIMER,
+            COUNTER
+        };
+
+        struct Metric
+        {
+            const char* name;
+            MetricKind kind;
+            size_t id;
+        };
+
+        /*
+         * Log-linear (HDR-style) bucketing of nanosecond values: exact below 32,
+         * then 16 sub-buckets per power of two, i.e. at most ~6% relative error
+         * over the full 64-bit range in 976 buckets.
+         */
+        namespace histogram
+        {
+            constexpr unsigned SUB_BITS = 5;
+            constexpr uint64_t SUB_COUNT = uint64_t(1) << SUB_BITS;
+            constexpr uint64_t HALF_COUNT = SUB_COUNT / 2;
+            constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * HALF_COUNT + HALF_COUNT;
+
+            inline unsigned highestBit(uint64_t v)
+            {
+#if defined(_MSC_VER)
+                unsigned long index;
+                _BitScanReverse64(&index, v);
+                return static_cast<unsigned>(index);
+#else
+                return 63u - static_cast<unsigned>(__builtin_clzll(v));
+#endif
+            }
+
+            inline size_t index(uint64_t v)
+            {
+                if (v < SUB_COUNT) return static_cast<size_t>(v);
+                const unsigned shift = highestBit(v) - (SUB_BITS - 1);
+                return static_cast<size_t>(shift * HALF_COUNT + (v >> shift));
+            }
+
+            // Highest value that maps to bucket i.
+            inline uint64_t upperBound(size_t i)
+            {
+                if (i < SUB_COUNT) return i;
+                const unsigned shift = static_cast<unsigned>(i / HALF_COUNT - 1);
+                const uint64_t sub = i - shift * HALF_COUNT;
+                return ((sub + 1) << shift) - 1;
+            }
+        } // namespace histogram
+
+        struct MetricSnapshot
+        {
+            std::string name;
+            MetricKind kind = MetricKind::COUNTER;
+            uint64_t count = 0;     // timer: calls, counter: accumulated value
+            uint64_t totalNs = 0;
+            uint64_t minNs = 0;
+            uint64_t maxNs = 0;
+            uint64_t p50Ns = 0;
+            uint64_t p90Ns = 0;
+            uint64_t p99Ns = 0;
+            uint64_t p999Ns = 0;
+
+            double meanNs() const { return count ? static_cast<double>(totalNs) / count : 0.0; }
+        };
+
+        struct Snapshot
+        {
+            bool enabled = CNT_ENABLE_INSTRUMENTATION != 0;
+            std::vector<MetricSnapshot> metrics;
+
+            const MetricSnapshot* find(const std::string& name) const
+            {
+                for (const auto& m : metrics)
+                {
+                    if (m.name == name) return &m;
+                }
+                return nullptr;
+            }
+
+            std::string toText() const
+            {
+                std::string out;
+                char line[256];
+                for (const auto& m : metrics)
+                {
+                    if (m.kind == MetricKind::COUNTER)
+                    {
+                        std::snprintf(line, sizeof(line), "%-32s %20llu\n", m.name.c_str(),
+                                      static_cast<unsigned long long>(m.count));
+                    }
+                    else
+                    {
+                        std::snprintf(line, sizeof(line),
+                                      "%-32s calls=%llu mean=%.0fns min=%llu p50=%llu p90=%llu p99=%llu p99.9=%llu max=%llu\n",
+                                      m.name.c_str(), static_cast<unsigned long long>(m.count), m.meanNs(),
+                                      static_cast<unsigned long long>(m.minNs), static_cast<unsigned long long>(m.p50Ns),
+                                      static_cast<unsigned long long>(m.p90Ns), static_cast<unsigned long long>(m.p99Ns),
+                                      static_cast<unsigned long long>(m.p999Ns), static_cast<unsigned long long>(m.maxNs));
+                    }
+                    out += line;
+                }
+                return out;
+            }
+
+            std::string toJson() const
+            {
+                std::string out = "{\"enabled\":";
+                out += enabled ? "true" : "false";
+                out += ",\"timers\":{";
+                bool first = true;
+                for (const auto& m : metrics)
+                {
+                    if (m.kind != MetricKind::TIMER) continue;
+                    if (!first) out += ',';
+                    first = false;
+                    out += '"' + m.name + "\":{\"calls\":" + std::to_string(m.count) +
+                           ",\"total_ns\":" + std::to_string(m.totalNs) +
+                           ",\"min_ns\":" + std::to_string(m.minNs) +
+                           ",\"p50_ns\":" + std::to_string(m.p50Ns) +
+                           ",\"p90_ns\":" + std::to_string(m.p90Ns) +
+                           ",\"p99_ns\":" + std::to_string(m.p99Ns) +
+                           ",\"p999_ns\":" + std::to_string(m.p999Ns) +
+                           ",\"max_ns\":" + std::to_string(m.maxNs) + '}';
+                }
+                out += "},\"counters\":{";
+                first = true;
+                for (const auto& m : metrics)
+                {
+                    if (m.kind != MetricKind::COUNTER) continue;
+                    if (!first) out += ',';
+                    first = false;
+                    out += '"' + m.name + "\":" + std::to_string(m.count);
+                }
+                out += "}}";
+                return out;
+            }
+        };
+
+        class Registry
+        {
+        public:
+            static Registry& instance()
+            {
+                static Registry* registry = new Registry();  // never destroyed; threads may exit after main
+                return *registry;
+            }
+
+            // Returns the metric registered under name, creating it on first use.
+            Metric& metric(const char* name, MetricKind kind)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (auto& m : metrics_)
+                {
+                    if (std::string(m->name) == name) return *m;
+                }
+                metrics_.emplace_back(new Metric{name, kind, metrics_.size()});
+                retired_.emplace_back();
+                return *metrics_.back();
+            }
+
+            void record(const Metric& metric, uint64_t ns)
+            {
+                Slot& slot = local().slot(metric.id);
+                bump(slot.count, 1);
+                bump(slot.total, ns);
+                if (ns < slot.min.load(std::memory_order_relaxed)) slot.min.store(ns, std::memory_order_relaxed);
+                if (ns > slot.max.load(std::memory_order_relaxed)) slot.max.store(ns, std::memory_order_relaxed);
+                bump(slot.buckets()[histogram::index(ns)], 1);
+            }
+
+            void add(const Metric& metric, uint64_t n)
+            {
+                bump(local().slot(metric.id).count, n);
+            }
+
+            Snapshot snapshot()
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                std::vector<Slot> merged(metrics_.size());
+                for (size_t id = 0; id < metrics_.size(); ++id)
+                {
+                    merged[id].mergeFrom(retired_[id], metrics_[id]->kind);
+                    for (ThreadData* thread : threads_)
+                    {
+                        if (id < thread->slots.size() && thread->slots[id])
+                        {
+                            merged[id].mergeFrom(*thread->slots[id], metrics_[id]->kind);
+                        }
+                    }
+                }
+
+                Snapshot snap;
+                for (size_t id = 0; id < metrics_.size(); ++id)
+                {
+                    snap.metrics.push_back(merged[id].summarize(metrics_[id]->name, metrics_[id]->kind));
+                }
+                std::sort(snap.metrics.begin(), snap.metrics.end(),
+                          [](const MetricSnapshot& a, const MetricSnapshot& b) { return a.name < b.name; });
+                return snap;
+            }
+
+        private:
+            // One thread's data for one metric. Only the owning thread writes, so
+            // relaxed load+store replaces read-modify-write on the hot path.
+            struct Slot
+            {
+                std::atomic<uint64_t> count{0};
+                std::atomic<uint64_t> total{0};
+                std::atomic<uint64_t> min{UINT64_MAX};
+                std::atomic<uint64_t> max{0};
+                std::unique_ptr<std::atomic<uint64_t>[]> histogram;   // timers only, allocated under the registry lock
+
+                std::atomic<uint64_t>* buckets()
+                {
+                    if (!histogram)
+                    {
+                        histogram.reset(new std::atomic<uint64_t>[histogram::BUCKETS]);
+                        for (size_t i = 0; i < histogram::BUCKETS; ++i) histogram[i].store(0, std::memory_order_relaxed);
+                    }
+                    return histogram.get();
+                }
+
+                void mergeFrom(Slot& other, MetricKind kind)
+                {
+                    bump(count, other.count.load(std::memory_order_relaxed));
+                    if (kind != MetricKind::TIMER) return;
+                    bump(total, other.total.load(std::memory_order_relaxed));
+                    min.store(std::min(min.load(std::memory_order_relaxed), other.min.load(std::memory_order_relaxed)),
+                              std::memory_order_relaxed);
+                    max.store(std::max(max.load(std::memory_order_relaxed), other.max.load(std::memory_order_relaxed)),
+                              std::memory_order_relaxed);
+                    if (!other.histogram) return;
+                    std::atomic<uint64_t>* mine = buckets();
+                    for (size_t i = 0; i < histogram::BUCKETS; ++i)
+                    {
+                        bump(mine[i], other.histogram[i].load(std::memory_order_relaxed));
+                    }
+                }
+
+                MetricSnapshot summarize(const char* name, MetricKind kind) const
+                {
+                    MetricSnapshot m;
+                    m.name = name;
+                    m.kind = kind;
+                    m.count = count.load(std::memory_order_relaxed);
+                    if (kind != MetricKind::TIMER || m.count == 0) return m;
+                    m.totalNs = total.load(std::memory_order_relaxed);
+                    m.minNs = min.load(std::memory_order_relaxed);
+                    m.maxNs = max.load(std::memory_order_relaxed);
+                    if (!histogram) return m;
+
+                    // Bucket counts may trail count slightly while threads are recording.
+                    uint64_t recorded = 0;
+                    for (size_t i = 0; i < histogram::BUCKETS; ++i) recorded += histogram[i].load(std::memory_order_relaxed);
+                    const double quantiles[4] = {0.5, 0.9, 0.99, 0.999};
+                    uint64_t* outputs[4] = {&m.p50Ns, &m.p90Ns, &m.p99Ns, &m.p999Ns};
+                    uint64_t seen = 0;
+                    size_t q = 0;
+                    for (size_t i = 0; i < histogram::BUCKETS && q < 4; ++i)
+                    {
+                        seen += histogram[i].load(std::memory_order_relaxed);
+                        while (q < 4 && seen >= static_cast<uint64_t>(quantiles[q] * recorded + 0.5) && seen)
+                        {
+                            *outputs[q++] = std::min(histogram::upperBound(i), m.maxNs);
+                        }
+                    }
+                    return m;
+                }
+            };
+
+            struct ThreadData
+            {
+                std::vector<std::unique_ptr<Slot>> slots;
+
+                Slot& slot(size_t id)
+                {
+                    if (id >= slots.size() || !slots[id]) return Registry::instance().createSlot(*this, id);
+                    return *slots[id];
+                }
+            };
+
+            // Registers the calling thread on first use and folds its data into
+            // retired_ when the thread exits.
+            struct ThreadHandle
+            {
+                ThreadData* data = nullptr;
+                ~ThreadHandle()
+                {
+                    if (data) Registry::instance().retire(data);
+                }
+            };
+
+            Registry() = default;
+
+            static void bump(std::atomic<uint64_t>& value, uint64_t n)
+            {
+                value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+
+            ThreadData& local()
+            {
+                thread_local ThreadHandle handle;
+                if (!handle.data)
+                {
+                    handle.data = new ThreadData();
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    threads_.push_back(handle.data);
+                }
+                return *handle.data;
+            }
+
+            Slot& createSlot(ThreadData& thread, size_t id)
+            {
+                // snapshot() walks thread->slots under the same lock.
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (id >= thread.slots.size()) thread.slots.resize(metrics_.size());
+                thread.slots[id].reset(new Slot());
+                if (metrics_[id]->kind == MetricKind::TIMER) thread.slots[id]->buckets();
+                return *thread.slots[id];
+            }
+
+            void retire(ThreadData* thread)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (size_t id = 0; id < thread->slots.size(); ++id)
+                {
+                    if (thread->slots[id]) retired_[id].mergeFrom(*thread->slots[id], metrics_[id]->kind);
+                }
+                threads_.erase(std::find(threads_.begin(), threads_.end(), thread));
+                delete thread;
+            }
+
+            std::mutex mutex_;
+            std::vector<std::unique_ptr<Metric>> metrics_;
+            std::vector<ThreadData*> threads_;
+            std::deque<Slot> retired_;
+        };
+
+        // Records the lifetime of the enclosing scope into a timer metric.
+        class ScopedTimer
+        {
+        public:
+            explicit ScopedTimer(const Metric& metric)
+                : metric_(metric), start_(std::chrono::steady_clock::now())
+            {
+            }
+
+            ~ScopedTimer()
+            {
+                auto elapsed = std::chrono::steady_clock::now() - start_;
+                Registry::instance().record(metric_,
+                    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            }
+
+            ScopedTimer(const ScopedTimer&) = delete;
+            ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        private:
+            const Metric& metric_;
+            std::chrono::steady_clock::time_point start_;
+        };
+
+        inline Snapshot snapshot() { return Registry::instance().snapshot(); }
+
+    } // namespace instrument
+} // namespace cnt
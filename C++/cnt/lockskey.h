@@ -24,7 +24,17 @@
 #include <vector>
 #include <unordered_map>
 #include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <cstring>
+#include <algorithm>
+
+#include "crc32c.h"
+#include "lockvault.h"
+#include "securealloc.h"
+#include "instrument.h"
 
 namespace cnt {
 
@@ -35,27 +45,134 @@ private:
         std::string author;
         std::string license;
         std::string version;
-        std::vector<uint8_t> key_data;
+        secure_bytes key_data;
         time_t created_time;
     };
 
-    std::unordered_map<std::string, KeyMeta> key_vault;  // Կ洢
+    mutable std::unordered_map<std::string, KeyMeta> key_vault;  // Կ洢
     static constexpr size_t MIN_KEY_LENGTH = 32;         // СԿ
 
     // 㷨
-    std::vector<uint8_t> process_data(const std::vector<uint8_t>& data, 
-                                     const std::vector<uint8_t>& key) const {
+    void process_data(const uint8_t* data, size_t size,
+                      const secure_bytes& key, secure_bytes& result) const {
         if (key.empty()) throw std::invalid_argument("Empty encryption key");
-        
-        std::vector<uint8_t> result;
-        result.reserve(data.size());
-        for (size_t i = 0; i < data.size(); ++i) {
-            result.push_back(data[i] ^ key[i % key.size()]);
+
+        result.resize(size);
+        size_t k = 0;
+        apply_key(data, size, key, k, result.data());
+    }
+
+    // XORs size bytes starting at key position k and advances k.
+    static void apply_key(const uint8_t* data, size_t size, const secure_bytes& key,
+                          size_t& k, uint8_t* dst) {
+        for (size_t i = 0; i < size; ++i) {
+            dst[i] = data[i] ^ key[k];
+            if (++k == key.size()) k = 0;
+        }
+    }
+
+    // Checked payload: [u64 plaintext size] then, per CHECKED_BLOCK bytes of
+    // ciphertext, [u32 CRC-32C of the block][block].  The key position runs
+    // on across blocks, so the ciphertext bytes equal the raw format's.
+    static constexpr size_t CHECKED_BLOCK = 64 * 1024;
+
+    static size_t checked_size(uint64_t size) {
+        return sizeof(uint64_t) + size + (size + CHECKED_BLOCK - 1) / CHECKED_BLOCK * sizeof(uint32_t);
+    }
+
+    void seal_checked(const uint8_t* data, size_t size,
+                      const secure_bytes& key, secure_bytes& result) const {
+        if (key.empty()) throw std::invalid_argument("Empty encryption key");
+
+        result.resize(checked_size(size));
+        uint8_t* dst = result.data();
+        const uint64_t length = size;
+        std::memcpy(dst, &length, sizeof(length));
+        dst += sizeof(length);
+        size_t k = 0;
+        for (size_t pos = 0; pos < size; pos += CHECKED_BLOCK) {
+            const size_t n = std::min(CHECKED_BLOCK, size - pos);
+            apply_key(data + pos, n, key, k, dst + sizeof(uint32_t));
+            const uint32_t crc = crc32c::value(dst + sizeof(uint32_t), n);
+            std::memcpy(dst, &crc, sizeof(crc));
+            dst += sizeof(uint32_t) + n;
+        }
+    }
+
+    // Each block is verified before it is decrypted.
+    void open_checked(const uint8_t* data, size_t size,
+                      const secure_bytes& key, secure_bytes& result) const {
+        if (key.empty()) throw std::invalid_argument("Empty encryption key");
+
+        uint64_t length = 0;
+        if (size < sizeof(length)) throw std::runtime_error("Truncated checked payload");
+        std::memcpy(&length, data, sizeof(length));
+        if (length > size || checked_size(length) != size) {
+            throw std::runtime_error("Invalid checked payload length");
+        }
+        result.resize(static_cast<size_t>(length));
+        const uint8_t* src = data + sizeof(length);
+        size_t k = 0;
+        for (size_t pos = 0; pos < length; pos += CHECKED_BLOCK) {
+            const size_t n = std::min<size_t>(CHECKED_BLOCK, length - pos);
+            uint32_t crc;
+            std::memcpy(&crc, src, sizeof(crc));
+            if (crc32c::value(src + sizeof(crc), n) != crc) {
+                throw std::runtime_error("Checked payload block " + std::to_string(pos / CHECKED_BLOCK) +
+                                         " is corrupted");
+            }
+            apply_key(src + sizeof(crc), n, key, k, result.data() + pos);
+            src += sizeof(crc) + n;
+        }
+    }
+
+    // Persistent store; when attached, key_vault only caches materialized entries.
+    std::unique_ptr<lock_vault> vault_;
+    mutable std::mutex vault_mutex_;
+
+    KeyMeta* materialize(const std::string& key_id) const {
+        lock_vault::record r;
+        if (!vault_->find(key_id, r)) return nullptr;
+        KeyMeta meta{std::string(r.author), std::string(r.license), std::string(r.version),
+                     secure_bytes(r.key_size), r.created_time};
+        vault_->unseal(r, meta.key_data.data());
+        return &(key_vault[key_id] = std::move(meta));
+    }
+
+    KeyMeta* find_key(const std::string& key_id) const {
+        auto it = key_vault.find(key_id);
+        if (it != key_vault.end()) return &it->second;
+        return vault_ ? materialize(key_id) : nullptr;
+    }
+
+    // Caller holds vault_mutex_.
+    const KeyMeta& require_key(const std::string& key_id) const {
+        const KeyMeta* meta = find_key(key_id);
+        if (!meta) {
+            throw std::out_of_range("Key not found: " + key_id);
+        }
+        return *meta;
+    }
+
+    // The key bytes are copied under the lock: a concurrent update_key or
+    // delete_key frees the stored ones while a cipher may still be running.
+    secure_bytes key_snapshot(const std::string& key_id) const {
+        std::lock_guard<std::mutex> lock(vault_mutex_);
+        return require_key(key_id).key_data;
+    }
+
+    void persist(const std::string& key_id, const KeyMeta& meta) {
+        if (vault_) {
+            vault_->put(key_id, meta.author, meta.license, meta.version,
+                        meta.key_data.data(), meta.key_data.size(), meta.created_time);
         }
-        return result;
     }
 
 public:
+    // Ciphertext layout.  raw is the bare XOR stream; checked adds a size
+    // prefix and a CRC-32C per 64 KiB block that decrypt() verifies.
+    enum class payload_format { raw, checked };
+
     // Կӿ
     void create_key(const std::string& key_id,
                    const std::string& author,
@@ -65,52 +182,153 @@ public:
         if (key_data.size() < MIN_KEY_LENGTH) {
             throw std::length_error("Key length must be at least 32 bytes");
         }
-        key_vault[key_id] = {author, license, version, key_data, time(nullptr)};
+        std::lock_guard<std::mutex> lock(vault_mutex_);
+        KeyMeta& meta = key_vault[key_id] = {author, license, version,
+                                             secure_bytes(key_data.begin(), key_data.end()),
+                                             time(nullptr)};
+        persist(key_id, meta);
     }
 
     void delete_key(const std::string& key_id) {
-        if (!key_vault.erase(key_id)) {
+        std::lock_guard<std::mutex> lock(vault_mutex_);
+        bool erased = key_vault.erase(key_id) != 0;
+        if (vault_) erased = vault_->erase(key_id) || erased;
+        if (!erased) {
             throw std::out_of_range("Key not found: " + key_id);
         }
     }
 
     void update_key(const std::string& key_id,
                    const std::vector<uint8_t>& new_key_data) {
-        auto it = key_vault.find(key_id);
-        if (it == key_vault.end()) {
+        std::lock_guard<std::mutex> lock(vault_mutex_);
+        KeyMeta* meta = find_key(key_id);
+        if (!meta) {
             throw std::out_of_range("Key not found: " + key_id);
         }
         if (new_key_data.size() < MIN_KEY_LENGTH) {
             throw std::length_error("New key length invalid");
         }
-        it->second.key_data = new_key_data;
-        it->second.created_time = time(nullptr);
+        meta->key_data.assign(new_key_data.begin(), new_key_data.end());
+        meta->created_time = time(nullptr);
+        persist(key_id, *meta);
+    }
+
+    // Persistent vault.  Keys already held in memory are written into the vault;
+    // keys stored in the vault are materialized on first use.
+    void open_vault(const std::string& path, const std::vector<uint8_t>& master_key) {
+        std::lock_guard<std::mutex> lock(vault_mutex_);
+        auto vault = std::make_unique<lock_vault>(path, master_key);
+        for (const auto& [key_id, meta] : key_vault) {
+            vault->put(key_id, meta.author, meta.license, meta.version,
+                       meta.key_data.data(), meta.key_data.size(), meta.created_time);
+        }
+        vault_ = std::move(vault);
+    }
+
+    // Detach the vault; materialized keys stay available in memory.
+    void close_vault() {
+        std::lock_guard<std::mutex> lock(vault_mutex_);
+        vault_.reset();
+    }
+
+    void compact_vault() {
+        std::lock_guard<std::mutex> lock(vault_mutex_);
+        if (vault_) vault_->compact();
     }
 
+    bool has_vault() const { return vault_ != nullptr; }
+
     // ݼ/
-    std::vector<uint8_t> encrypt(const std::string& key_id,
-                                const std::vector<uint8_t>& plaintext) const {
-        const auto& key = get_key(key_id).key_data;
-        return process_data(plaintext, key);
+    // Results live in secure_pool memory and are zeroized when released.
+    secure_bytes encrypt(const std::string& key_id,
+                         const std::vector<uint8_t>& plaintext) const {
+        secure_bytes result;
+        encrypt(key_id, plaintext.data(), plaintext.size(), result);
+        return result;
+    }
+
+    template <typename Alloc>
+    secure_bytes encrypt(const std::string& key_id,
+                         const std::vector<uint8_t, Alloc>& plaintext) const {
+        secure_bytes result;
+        encrypt(key_id, plaintext.data(), plaintext.size(), result);
+        return result;
+    }
+
+    // Writes into out, reusing its capacity across calls.
+    void encrypt(const std::string& key_id, const uint8_t* data, size_t size,
+                 secure_bytes& out) const {
+        CNT_SCOPED_TIMER("locks.encrypt");
+        CNT_COUNTER_ADD("locks.encrypt.bytes", size);
+        CNT_COUNTER_ADD("locks.encrypt.allocations", out.capacity() < size ? 1 : 0);
+        const secure_bytes key = key_snapshot(key_id);
+        process_data(data, size, key, out);
+    }
+
+    void encrypt(const std::string& key_id, const uint8_t* data, size_t size,
+                 secure_bytes& out, payload_format format) const {
+        if (format == payload_format::raw) return encrypt(key_id, data, size, out);
+        CNT_SCOPED_TIMER("locks.encrypt");
+        CNT_COUNTER_ADD("locks.encrypt.bytes", size);
+        seal_checked(data, size, key_snapshot(key_id), out);
+    }
+
+    void decrypt(const std::string& key_id, const uint8_t* data, size_t size,
+                 secure_bytes& out) const {
+        encrypt(key_id, data, size, out);
+    }
+
+    // Throws std::runtime_error if a checked payload is damaged or truncated.
+    void decrypt(const std::string& key_id, const uint8_t* data, size_t size,
+                 secure_bytes& out, payload_format format) const {
+        if (format == payload_format::raw) return encrypt(key_id, data, size, out);
+        CNT_SCOPED_TIMER("locks.decrypt");
+        CNT_COUNTER_ADD("locks.decrypt.bytes", size);
+        open_checked(data, size, key_snapshot(key_id), out);
     }
 
-    std::vector<uint8_t> decrypt(const std::string& key_id,
-                                const std::vector<uint8_t>& ciphertext) const {
+    template <typename Alloc>
+    secure_bytes encrypt(const std::string& key_id, const std::vector<uint8_t, Alloc>& plaintext,
+                         payload_format format) const {
+        secure_bytes result;
+        encrypt(key_id, plaintext.data(), plaintext.size(), result, format);
+        return result;
+    }
+
+    template <typename Alloc>
+    secure_bytes decrypt(const std::string& key_id, const std::vector<uint8_t, Alloc>& ciphertext,
+                         payload_format format) const {
+        secure_bytes result;
+        decrypt(key_id, ciphertext.data(), ciphertext.size(), result, format);
+        return result;
+    }
+
+    secure_bytes decrypt(const std::string& key_id,
+                         const std::vector<uint8_t>& ciphertext) const {
         return encrypt(key_id, ciphertext);  // ܽͬ
     }
 
+    template <typename Alloc>
+    secure_bytes decrypt(const std::string& key_id,
+                         const std::vector<uint8_t, Alloc>& ciphertext) const {
+        return encrypt(key_id, ciphertext);
+    }
+
     // Կѯ
-    const KeyMeta& get_key(const std::string& key_id) const {
-        auto it = key_vault.find(key_id);
-        if (it == key_vault.end()) {
-            throw std::out_of_range("Key not found: " + key_id);
-        }
-        return it->second;
+    // Returns a copy, so it stays valid when the key is updated or deleted.
+    KeyMeta get_key(const std::string& key_id) const {
+        std::lock_guard<std::mutex> lock(vault_mutex_);
+        return require_key(key_id);
     }
 
     // Կб
     std::vector<std::string> list_keys() const {
+        std::lock_guard<std::mutex> lock(vault_mutex_);
         std::vector<std::string> keys;
+        if (vault_) {
+            vault_->for_each_id([&keys](std::string_view id) { keys.emplace_back(id); });
+            return keys;
+        }
         keys.reserve(key_vault.size());
         for (const auto& [key, _] : key_vault) {
             keys.push_back(key);
@@ -121,7 +339,8 @@ public:
     // Э֤
     bool verify_license(const std::string& key_id,
                        const std::string& expected_license) const {
-        return get_key(key_id).license == expected_license;
+        std::lock_guard<std::mutex> lock(vault_mutex_);
+        return require_key(key_id).license == expected_license;
     }
 };
 
@@ -0,0 +1,649 @@
+/**
+ * @file cnt/lockvault.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio),
+ * and according to the project license (MIT license) agreement,
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team.
+ * At the same time,
+ * project and documents can be used for commercial purposes under the condition of informing the development source,
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time,
+ * and any form of dispute event, CNT Development Team.
+ * and APlcexicesetrl shall not be liable for any damages,
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+/* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+#ifndef CNT_LOCKVAULT_H
+#define CNT_LOCKVAULT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <random>
+#include <stdexcept>
+
+#include "crc32c.h"
+#include "sha256.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <io.h>
+#elif defined(__linux__) || defined(__unix__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+#endif
+
+namespace cnt {
+
+/*
+ * File-backed key vault used by cnt::locks.
+ *
+ * Layout (little-endian):
+ *   [file_header][entry ...][dir_entry ... sorted by id][journal record ...]
+ *
+ * The base image (everything up to base_end) is immutable and read through a
+ * memory mapping; lookups binary-search the directory in place and hand out
+ * views into the mapping, so opening a vault costs one mmap plus a header and
+ * directory check regardless of the number of keys.  Changes are appended as
+ * journal records after base_end and folded back into a fresh base image by
+ * compact(), which runs automatically once the journal outgrows the base.
+ *
+ * Key bytes are sealed with an HMAC-SHA-256 keystream.  Opening a vault runs
+ * HKDF (RFC 5869) over the full master key and the 128-bit per-file salt,
+ * which yields a sealing key and a check value; only the check value is
+ * stored, and it is one-way in the master key.  Keystream block n of a key is
+ * HMAC(sealing key, id length | id | n), so sealed blobs can be copied
+ * verbatim during compaction.  The master key is expected to be random key
+ * material, not a passphrase: HKDF does not slow down guessing.
+ *
+ * The header and directory, every journal record and every entry carry a
+ * CRC-32C; an entry is checked when it is read, so a damaged key is reported
+ * instead of handed out.
+ */
+class lock_vault {
+public:
+    // Borrowed view of one stored key.  Valid until the next mutating call.
+    struct record {
+        std::string_view id;
+        std::string_view author;
+        std::string_view license;
+        std::string_view version;
+        const uint8_t* sealed_key = nullptr;
+        size_t key_size = 0;
+        time_t created_time = 0;
+    };
+
+    // Journal grows to this fraction of the base image before auto compaction.
+    static constexpr double DEFAULT_COMPACTION_RATIO = 0.5;
+    static constexpr uint64_t MIN_COMPACTION_BYTES = 64 * 1024;
+
+    lock_vault(const std::string& path, const std::vector<uint8_t>& master_key)
+        : path_(path) {
+        if (master_key.empty()) throw std::invalid_argument("Empty master key");
+        if (!file_exists(path_)) {
+            uint8_t salt[SALT_SIZE];
+            random_salt(salt);
+            derive_keys(master_key, salt);
+            write_base(path_, {}, salt);
+        }
+        map_and_scan();
+        derive_keys(master_key, header().seal_salt);
+        if (!sha256::equal(header().seal_check, check_.data())) {
+            unmap();
+            throw std::invalid_argument("Master key does not match vault: " + path_);
+        }
+    }
+
+    ~lock_vault() {
+        close_journal();
+        unmap();
+        secure_wipe(&seal_, sizeof(seal_));
+        secure_wipe(check_.data(), check_.size());
+    }
+
+    lock_vault(const lock_vault&) = delete;
+    lock_vault& operator=(const lock_vault&) = delete;
+
+    // Lookup; returns false for unknown or erased ids.
+    bool find(std::string_view id, record& out) {
+        auto it = overlay_.find(std::string(id));
+        if (it != overlay_.end()) {
+            if (it->second == TOMBSTONE) return false;
+            return read_entry(it->second, out);
+        }
+        uint64_t offset;
+        return find_base(id, offset) && read_entry(offset, out);
+    }
+
+    bool contains(std::string_view id) {
+        record r;
+        return find(id, r);
+    }
+
+    void put(const std::string& id, const std::string& author,
+             const std::string& license, const std::string& version,
+             const uint8_t* key, size_t key_size, time_t created_time) {
+        std::string entry = encode_entry(id, author, license, version,
+                                         key, key_size, created_time);
+        uint64_t offset = append_record(OP_PUT, entry);
+        overlay_[id] = offset + sizeof(journal_header);
+        maybe_compact();
+    }
+
+    bool erase(const std::string& id) {
+        if (!contains(id)) return false;
+        std::string entry = encode_entry(id, "", "", "", nullptr, 0, 0);
+        append_record(OP_ERASE, entry);
+        overlay_[id] = TOMBSTONE;
+        maybe_compact();
+        return true;
+    }
+
+    // Unseal a record's key bytes into dst (dst must hold r.key_size bytes).
+    void unseal(const record& r, uint8_t* dst) const {
+        apply_keystream(r.id, r.sealed_key, dst, r.key_size);
+    }
+
+    // Visit every live id in sorted order of the base image followed by journal ids.
+    template <typename F>
+    void for_each_id(F&& fn) {
+        for (uint64_t i = 0; i < header().entry_count; ++i) {
+            dir_entry d = dir_at(i);
+            std::string_view id = entry_id(d.offset, d.id_len);
+            if (overlay_.empty() || overlay_.find(std::string(id)) == overlay_.end()) fn(id);
+        }
+        for (const auto& [id, offset] : overlay_) {
+            if (offset != TOMBSTONE) fn(std::string_view(id));
+        }
+    }
+
+    size_t size() {
+        size_t n = 0;
+        for_each_id([&n](std::string_view) { ++n; });
+        return n;
+    }
+
+    // Rewrite the vault as a single sorted base image and drop the journal.
+    void compact() {
+        ensure_mapped(append_offset_);
+        std::vector<std::pair<std::string_view, std::string_view>> live;  // id, raw entry
+        for_each_id([&](std::string_view id) {
+            uint64_t offset = locate(id);
+            live.emplace_back(id, raw_entry(offset));
+        });
+        std::sort(live.begin(), live.end());
+
+        std::string tmp = path_ + ".compact";
+        std::vector<std::string_view> entries;
+        entries.reserve(live.size());
+        for (const auto& item : live) entries.push_back(item.second);
+        write_base(tmp, entries, header().seal_salt);
+
+        close_journal();
+        unmap();
+        if (!replace_file(tmp, path_)) {
+            std::remove(tmp.c_str());
+            map_and_scan();
+            throw std::runtime_error("Failed to replace vault file: " + path_);
+        }
+        overlay_.clear();
+        map_and_scan();
+    }
+
+    void set_compaction_ratio(double ratio) { compaction_ratio_ = ratio; }
+    uint64_t journal_bytes() const { return append_offset_ - header().base_end; }
+    const std::string& path() const { return path_; }
+
+private:
+    static constexpr uint32_t VERSION = 3;
+    static constexpr size_t SALT_SIZE = 16;
+    static constexpr uint32_t JOURNAL_MAGIC = 0x4A544E43;  // "CNTJ"
+    static constexpr uint32_t OP_PUT = 1;
+    static constexpr uint32_t OP_ERASE = 2;
+    static constexpr uint64_t TOMBSTONE = ~uint64_t(0);
+
+    struct file_header {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        uint64_t entry_count;
+        uint64_t directory_offset;
+        uint64_t base_end;
+        uint8_t seal_salt[SALT_SIZE];
+        uint8_t seal_check[sha256::DIGEST_SIZE];   // HKDF output, never the key itself
+        uint32_t checksum;      // over header (checksum = 0) and directory
+        uint32_t reserved;
+    };
+
+    struct dir_entry {
+        uint64_t offset;
+        uint32_t id_len;
+        uint32_t entry_size;
+    };
+
+    struct entry_header {
+        uint32_t id_len;
+        uint32_t author_len;
+        uint32_t license_len;
+        uint32_t version_len;
+        uint32_t key_len;
+        uint32_t checksum;      // CRC-32C of the entry with this field zeroed
+        int64_t created_time;
+    };
+
+    struct journal_header {
+        uint32_t magic;
+        uint32_t op;
+        uint32_t size;
+        uint32_t checksum;
+    };
+
+    static_assert(sizeof(file_header) == 96, "unexpected vault header layout");
+    static_assert(sizeof(dir_entry) == 16, "unexpected vault directory layout");
+    static_assert(sizeof(entry_header) == 32, "unexpected vault entry layout");
+
+    // ---- checksums / sealing ----
+
+    static uint32_t entry_checksum(std::string_view entry) {
+        entry_header eh;
+        std::memcpy(&eh, entry.data(), sizeof(eh));
+        eh.checksum = 0;
+        return crc32c::extend(crc32c::value(&eh, sizeof(eh)), entry.data() + sizeof(eh), entry.size() - sizeof(eh));
+    }
+
+    static void secure_wipe(void* p, size_t n) {
+        volatile uint8_t* b = static_cast<volatile uint8_t*>(p);
+        while (n--) *b++ = 0;
+    }
+
+    // Salt from the operating system's random source.
+    static void random_salt(uint8_t* salt) {
+#if defined(_WIN32)
+        std::random_device device;  // RtlGenRandom with the Microsoft runtime
+        for (size_t i = 0; i < SALT_SIZE; i += sizeof(uint32_t)) {
+            uint32_t word = device();
+            std::memcpy(salt + i, &word, sizeof(word));
+        }
+#else
+        bool ok = false;
+#if defined(__linux__)
+        ok = getrandom(salt, SALT_SIZE, 0) == static_cast<ssize_t>(SALT_SIZE);
+#endif
+        if (!ok) {
+            std::FILE* f = std::fopen("/dev/urandom", "rb");
+            ok = f && std::fread(salt, SALT_SIZE, 1, f) == 1;
+            if (f) std::fclose(f);
+        }
+        if (!ok) throw std::runtime_error("No random source for the vault salt");
+#endif
+    }
+
+    // HKDF-SHA-256: extract with the salt, then expand one block per purpose.
+    void derive_keys(const std::vector<uint8_t>& master_key, const uint8_t* salt) {
+        sha256::digest prk = sha256::hmac(salt, SALT_SIZE).update(master_key.data(), master_key.size()).finish();
+        const auto expand = [&prk](const char* info) {
+            const uint8_t counter = 1;
+            return sha256::hmac(prk.data(), prk.size()).update(info, std::strlen(info)).update(&counter, 1).finish();
+        };
+        sha256::digest seal_key = expand("cnt vault seal");
+        check_ = expand("cnt vault check");
+        seal_ = sha256::hmac(seal_key.data(), seal_key.size());
+        secure_wipe(seal_key.data(), seal_key.size());
+        secure_wipe(prk.data(), prk.size());
+    }
+
+    void apply_keystream(std::string_view id, const uint8_t* src, uint8_t* dst, size_t size) const {
+        uint32_t id_len = static_cast<uint32_t>(id.size());
+        sha256::hmac keyed = seal_;
+        keyed.update(&id_len, sizeof(id_len)).update(id.data(), id.size());
+        for (uint64_t block = 0; size > 0; ++block) {
+            sha256::digest word = sha256::hmac(keyed).update(&block, sizeof(block)).finish();
+            size_t n = std::min(size, word.size());
+            for (size_t i = 0; i < n; ++i) dst[i] = src[i] ^ word[i];
+            src += n;
+            dst += n;
+            size -= n;
+        }
+    }
+
+    // ---- encoding ----
+
+    std::string encode_entry(const std::string& id, const std::string& author,
+                             const std::string& license, const std::string& version,
+                             const uint8_t* key, size_t key_size, time_t created_time) const {
+        entry_header eh{};
+        eh.id_len = static_cast<uint32_t>(id.size());
+        eh.author_len = static_cast<uint32_t>(author.size());
+        eh.license_len = static_cast<uint32_t>(license.size());
+        eh.version_len = static_cast<uint32_t>(version.size());
+        eh.key_len = static_cast<uint32_t>(key_size);
+        eh.created_time = static_cast<int64_t>(created_time);
+
+        std::string out;
+        out.reserve(sizeof(eh) + id.size() + author.size() + license.size() +
+                    version.size() + key_size);
+        out.append(reinterpret_cast<const char*>(&eh), sizeof(eh));
+        out += id;
+        out += author;
+        out += license;
+        out += version;
+        size_t key_pos = out.size();
+        out.resize(key_pos + key_size);
+        if (key_size) {
+            apply_keystream(id, key, reinterpret_cast<uint8_t*>(&out[key_pos]), key_size);
+        }
+        eh.checksum = entry_checksum(out);
+        std::memcpy(&out[0], &eh, sizeof(eh));
+        return out;
+    }
+
+    // ---- base image ----
+
+    const file_header& header() const {
+        return *reinterpret_cast<const file_header*>(map_);
+    }
+
+    // Entries have arbitrary lengths, so neither they nor the directory after
+    // them are aligned in the mapping: records are copied out, not cast.
+    const uint8_t* directory() const {
+        return map_ + header().directory_offset;
+    }
+
+    dir_entry dir_at(uint64_t index) const {
+        dir_entry d;
+        std::memcpy(&d, directory() + index * sizeof(dir_entry), sizeof(d));
+        return d;
+    }
+
+    static entry_header entry_header_at(const void* entry) {
+        entry_header eh;
+        std::memcpy(&eh, entry, sizeof(eh));
+        return eh;
+    }
+
+    std::string_view entry_id(uint64_t offset, uint32_t id_len) const {
+        return std::string_view(reinterpret_cast<const char*>(map_ + offset + sizeof(entry_header)), id_len);
+    }
+
+    bool find_base(std::string_view id, uint64_t& offset) const {
+        uint64_t first = 0;
+        uint64_t count = header().entry_count;
+        while (count > 0) {
+            uint64_t half = count / 2;
+            dir_entry d = dir_at(first + half);
+            if (entry_id(d.offset, d.id_len) < id) {
+                first += half + 1;
+                count -= half + 1;
+            } else {
+                count = half;
+            }
+        }
+        if (first == header().entry_count) return false;
+        dir_entry d = dir_at(first);
+        if (entry_id(d.offset, d.id_len) != id) return false;
+        offset = d.offset;
+        return true;
+    }
+
+    uint64_t locate(std::string_view id) const {
+        auto it = overlay_.find(std::string(id));
+        if (it != overlay_.end()) return it->second;
+        uint64_t offset;
+        return find_base(id, offset) ? offset : TOMBSTONE;
+    }
+
+    std::string_view raw_entry(uint64_t offset) {
+        ensure_mapped(offset + sizeof(entry_header));
+        entry_header eh = entry_header_at(map_ + offset);
+        uint64_t size = sizeof(entry_header) + uint64_t(eh.id_len) + eh.author_len +
+                        eh.license_len + eh.version_len + eh.key_len;
+        ensure_mapped(offset + size);
+        std::string_view entry(reinterpret_cast<const char*>(map_ + offset), size);
+        if (entry_checksum(entry) != eh.checksum) {
+            throw std::runtime_error("Corrupted vault entry in " + path_);
+        }
+        return entry;
+    }
+
+    bool read_entry(uint64_t offset, record& out) {
+        std::string_view raw = raw_entry(offset);
+        entry_header eh = entry_header_at(raw.data());
+        const char* p = raw.data() + sizeof(entry_header);
+        out.id = std::string_view(p, eh.id_len);           p += eh.id_len;
+        out.author = std::string_view(p, eh.author_len);   p += eh.author_len;
+        out.license = std::string_view(p, eh.license_len); p += eh.license_len;
+        out.version = std::string_view(p, eh.version_len); p += eh.version_len;
+        out.sealed_key = reinterpret_cast<const uint8_t*>(p);
+        out.key_size = eh.key_len;
+        out.created_time = static_cast<time_t>(eh.created_time);
+        return true;
+    }
+
+    // salt must be the one the current keys were derived from.
+    void write_base(const std::string& path, const std::vector<std::string_view>& entries, const uint8_t* salt) const {
+        file_header fh{};
+        std::memcpy(fh.magic, "CNTVAULT", 8);
+        fh.version = VERSION;
+        fh.header_size = sizeof(file_header);
+        fh.entry_count = entries.size();
+        std::memcpy(fh.seal_salt, salt, SALT_SIZE);
+        std::memcpy(fh.seal_check, check_.data(), check_.size());
+
+        std::vector<dir_entry> dir;
+        dir.reserve(entries.size());
+        uint64_t offset = sizeof(file_header);
+        for (const auto& e : entries) {
+            dir.push_back({offset, entry_header_at(e.data()).id_len, static_cast<uint32_t>(e.size())});
+            offset += e.size();
+        }
+        fh.directory_offset = offset;
+        fh.base_end = offset + dir.size() * sizeof(dir_entry);
+        fh.checksum = crc32c::extend(crc32c::value(&fh, sizeof(fh)), dir.data(), dir.size() * sizeof(dir_entry));
+
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) throw std::runtime_error("Failed to create vault file: " + path);
+        bool ok = std::fwrite(&fh, sizeof(fh), 1, f) == 1;
+        for (const auto& e : entries) {
+            ok = ok && std::fwrite(e.data(), 1, e.size(), f) == e.size();
+        }
+        if (!dir.empty()) {
+            ok = ok && std::fwrite(dir.data(), sizeof(dir_entry), dir.size(), f) == dir.size();
+        }
+        ok = (std::fflush(f) == 0) && ok && sync_file(f);
+        std::fclose(f);
+        if (!ok) {
+            std::remove(path.c_str());
+            throw std::runtime_error("Failed to write vault file: " + path);
+        }
+    }
+
+    // ---- journal ----
+
+    uint64_t append_record(uint32_t op, const std::string& entry) {
+        journal_header jh{JOURNAL_MAGIC, op, static_cast<uint32_t>(entry.size()),
+                          crc32c::extend(op, entry.data(), entry.size())};
+
+        if (!journal_) {
+            journal_ = std::fopen(path_.c_str(), "r+b");
+            if (!journal_) throw std::runtime_error("Failed to open vault file: " + path_);
+            journal_pos_ = TOMBSTONE;
+        }
+        // Each record is flushed to the kernel so it survives a process crash.
+        uint64_t offset = append_offset_;
+        bool ok = (journal_pos_ == offset || seek(journal_, offset)) &&
+                  std::fwrite(&jh, sizeof(jh), 1, journal_) == 1 &&
+                  std::fwrite(entry.data(), 1, entry.size(), journal_) == entry.size();
+        ok = (std::fflush(journal_) == 0) && ok;
+        if (ok && torn_tail_) ok = truncate_file(journal_, offset + sizeof(jh) + entry.size());
+        if (!ok) {
+            close_journal();
+            throw std::runtime_error("Failed to append to vault file: " + path_);
+        }
+
+        torn_tail_ = false;
+        append_offset_ = offset + sizeof(jh) + entry.size();
+        journal_pos_ = append_offset_;
+        return offset;
+    }
+
+    void close_journal() {
+        if (journal_) std::fclose(journal_);
+        journal_ = nullptr;
+    }
+
+    void scan_journal() {
+        uint64_t pos = header().base_end;
+        while (pos + sizeof(journal_header) <= map_size_) {
+            journal_header jh;
+            std::memcpy(&jh, map_ + pos, sizeof(jh));
+            uint64_t body = pos + sizeof(jh);
+            if (jh.magic != JOURNAL_MAGIC || body + jh.size > map_size_ ||
+                jh.size < sizeof(entry_header) ||
+                crc32c::extend(jh.op, map_ + body, jh.size) != jh.checksum) {
+                break;
+            }
+            std::string id(entry_id(body, entry_header_at(map_ + body).id_len));
+            overlay_[id] = (jh.op == OP_ERASE) ? TOMBSTONE : body;
+            pos = body + jh.size;
+        }
+        append_offset_ = pos;
+        torn_tail_ = pos != map_size_;
+    }
+
+    void maybe_compact() {
+        uint64_t base = header().base_end;
+        uint64_t journal = journal_bytes();
+        if (journal >= MIN_COMPACTION_BYTES && journal > base * compaction_ratio_) compact();
+    }
+
+    // ---- mapping ----
+
+    void map_and_scan() {
+        map_file();
+        if (map_size_ < sizeof(file_header) ||
+            std::memcmp(header().magic, "CNTVAULT", 8) != 0 ||
+            header().version != VERSION) {
+            unmap();
+            throw std::runtime_error("Invalid vault file: " + path_);
+        }
+        const file_header& fh = header();
+        if (fh.directory_offset > map_size_ || fh.base_end > map_size_ ||
+            fh.base_end - fh.directory_offset != fh.entry_count * sizeof(dir_entry)) {
+            unmap();
+            throw std::runtime_error("Corrupted vault file: " + path_);
+        }
+        file_header copy = fh;
+        copy.checksum = 0;
+        uint32_t sum = crc32c::extend(crc32c::value(&copy, sizeof(copy)), directory(),
+                                      fh.entry_count * sizeof(dir_entry));
+        if (sum != fh.checksum) {
+            unmap();
+            throw std::runtime_error("Corrupted vault file: " + path_);
+        }
+        scan_journal();
+    }
+
+    // Records appended after the mapping was taken are picked up by remapping.
+    void ensure_mapped(uint64_t end) {
+        if (end <= map_size_) return;
+        unmap();
+        map_file();
+        if (end > map_size_) throw std::runtime_error("Corrupted vault file: " + path_);
+    }
+
+    static bool file_exists(const std::string& path) {
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        std::fclose(f);
+        return true;
+    }
+
+#if defined(_WIN32)
+    void map_file() {
+        HANDLE file = CreateFileA(path_.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Failed to open vault file: " + path_);
+        LARGE_INTEGER size;
+        GetFileSizeEx(file, &size);
+        map_size_ = static_cast<uint64_t>(size.QuadPart);
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) throw std::runtime_error("Failed to map vault file: " + path_);
+        map_ = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+        if (!map_) throw std::runtime_error("Failed to map vault file: " + path_);
+    }
+
+    void unmap() {
+        if (map_) UnmapViewOfFile(map_);
+        map_ = nullptr;
+        map_size_ = 0;
+    }
+
+    static bool sync_file(std::FILE* f) { return _commit(_fileno(f)) == 0; }
+    static bool replace_file(const std::string& from, const std::string& to) {
+        return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+    }
+    static bool seek(std::FILE* f, uint64_t offset) { return _fseeki64(f, static_cast<__int64>(offset), SEEK_SET) == 0; }
+    static bool truncate_file(std::FILE* f, uint64_t size) { return _chsize_s(_fileno(f), static_cast<__int64>(size)) == 0; }
+#else
+    void map_file() {
+        int fd = ::open(path_.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Failed to open vault file: " + path_);
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to stat vault file: " + path_);
+        }
+        map_size_ = static_cast<uint64_t>(st.st_size);
+        void* p = mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) throw std::runtime_error("Failed to map vault file: " + path_);
+        map_ = static_cast<const uint8_t*>(p);
+    }
+
+    void unmap() {
+        if (map_) munmap(const_cast<uint8_t*>(map_), map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+    }
+
+    static bool sync_file(std::FILE* f) { return fsync(fileno(f)) == 0; }
+    static bool replace_file(const std::string& from, const std::string& to) {
+        return std::rename(from.c_str(), to.c_str()) == 0;
+    }
+    static bool seek(std::FILE* f, uint64_t offset) { return fseeko(f, static_cast<off_t>(offset), SEEK_SET) == 0; }
+    static bool truncate_file(std::FILE* f, uint64_t size) { return ftruncate(fileno(f), static_cast<off_t>(size)) == 0; }
+#endif
+
+    std::string path_;
+    sha256::hmac seal_{nullptr, 0};        // keyed with the HKDF sealing key
+    sha256::digest check_{};
+    const uint8_t* map_ = nullptr;
+    uint64_t map_size_ = 0;
+    uint64_t append_offset_ = 0;
+    bool torn_tail_ = false;
+    std::FILE* journal_ = nullptr;
+    uint64_t journal_pos_ = 0;
+    double compaction_ratio_ = DEFAULT_COMPACTION_RATIO;
+    std::unordered_map<std::string, uint64_t> overlay_;  // journal state: id -> entry offset or TOMBSTONE
+};
+
+} // namespace cnt
+
+#endif // CNT_LOCKVAULT_H
@@ -0,0 +1,162 @@
+/**
+ * @file cnt/logconfig.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio),
+ * and according to the project license (MIT license) agreement,
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team.
+ * At the same time,
+ * project and documents can be used for commercial purposes under the condition of informing the development source,
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time,
+ * and any form of dispute event, CNT Development Team.
+ * and APlcexicesetrl shall not be liable for any damages,
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+ /* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <cctype>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "config.h"
+#include "loggings.h"
+
+#ifdef ERROR
+#define _CNT_LOGCONFIG_SAVED_ERROR_DEFINE_ ERROR
+#undef ERROR
+#endif
+
+namespace cnt
+{
+    /*
+     * Drives a Logger's level and sampling from ConfigManager keys, so they
+     * can be changed at runtime by editing the configuration and reloading it:
+     *
+     *   <prefix>.level          DEBUG, INFO, WARNING, ERROR or CRITICAL
+     *   <prefix>.sample         "off", "1/N" (one record in N), "P%" or a
+     *                           probability in [0, 1]
+     *   <prefix>.sample.level   highest level that is sampled (DEBUG)
+     *
+     * refresh() applies the current values; call it after the manager has been
+     * (re)loaded, e.g. from the thread that reloads it. The logger takes them
+     * with atomic stores, so threads that are logging carry on undisturbed.
+     * Missing keys leave the corresponding setting as it is.
+     *
+     * Turning on DEBUG for 1% of the records during an incident:
+     *
+     *   log.level = DEBUG
+     *   log.sample = 1%
+     */
+    class LoggerConfigBinding
+    {
+    public:
+        LoggerConfigBinding(Logger& logger, std::shared_ptr<ConfigManager> config, std::string prefix = "log")
+            : logger_(logger),
+            config_(std::move(config)),
+            levelKey_(prefix + ".level"),
+            sampleKey_(prefix + ".sample"),
+            sampleLevelKey_(prefix + ".sample.level")
+        {
+            if (!config_) throw std::invalid_argument("Null config manager");
+            refresh();
+        }
+
+        // Returns true if the level or sampling changed. Malformed values throw
+        // std::invalid_argument and leave the logger unchanged.
+        bool refresh()
+        {
+            const ConfigManager& config = *config_;
+            const LogLevel oldLevel = logger_.getLevel();
+            LogLevel level = oldLevel;
+            if (config.contains(levelKey_)) level = parseLevel(config[levelKey_]);
+
+            const LogSampling oldSampling = logger_.getSampling();
+            LogSampling sampling = oldSampling;
+            if (config.contains(sampleKey_))
+            {
+                LogLevel upTo = LogLevel::DEBUG;
+                if (config.contains(sampleLevelKey_)) upTo = parseLevel(config[sampleLevelKey_]);
+                sampling = parseSampling(config[sampleKey_], upTo);
+            }
+
+            if (level != oldLevel) logger_.setLevel(level);
+            logger_.setSampling(sampling);
+            const LogSampling newSampling = logger_.getSampling();
+            const bool samplingChanged = newSampling.mode != oldSampling.mode || newSampling.upTo != oldSampling.upTo ||
+                                         newSampling.oneIn != oldSampling.oneIn ||
+                                         newSampling.probability != oldSampling.probability;
+            return samplingChanged || level != oldLevel;
+        }
+
+        const std::string& levelKey() const { return levelKey_; }
+        const std::string& sampleKey() const { return sampleKey_; }
+
+        // Level names are case-insensitive; WARN is accepted for WARNING.
+        static LogLevel parseLevel(const std::string& text)
+        {
+            std::string name = trim(text);
+            for (auto& c : name) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            if (name == "DEBUG") return LogLevel::DEBUG;
+            if (name == "INFO") return LogLevel::INFO;
+            if (name == "WARNING" || name == "WARN") return LogLevel::WARNING;
+            if (name == "ERROR") return LogLevel::ERROR;
+            if (name == "CRITICAL") return LogLevel::CRITICAL;
+            throw std::invalid_argument("Invalid log level: " + text);
+        }
+
+        static LogSampling parseSampling(const std::string& text, LogLevel upTo = LogLevel::DEBUG)
+        {
+            const std::string value = trim(text);
+            if (value.empty() || value == "off" || value == "none") return LogSampling::none();
+            const char* begin = value.c_str();
+            char* end = nullptr;
+            if (value.compare(0, 2, "1/") == 0)
+            {
+                const unsigned long long n = std::strtoull(begin + 2, &end, 10);
+                if (end == begin + 2 || *end != '\0' || n == 0 || n > 0xffffffffull)
+                {
+                    throw std::invalid_argument("Invalid log sampling: " + text);
+                }
+                return LogSampling::everyNth(static_cast<uint32_t>(n), upTo);
+            }
+            double probability = std::strtod(begin, &end);
+            if (end == begin) throw std::invalid_argument("Invalid log sampling: " + text);
+            if (*end == '%')
+            {
+                probability /= 100.0;
+                ++end;
+            }
+            if (*end != '\0' || !(probability >= 0.0 && probability <= 1.0))
+            {
+                throw std::invalid_argument("Invalid log sampling: " + text);
+            }
+            return LogSampling::withProbability(probability, upTo);
+        }
+
+    private:
+        static std::string trim(const std::string& text)
+        {
+            const size_t first = text.find_first_not_of(" \t\r\n");
+            if (first == std::string::npos) return std::string();
+            const size_t last = text.find_last_not_of(" \t\r\n");
+            return text.substr(first, last - first + 1);
+        }
+
+        Logger& logger_;
+        std::shared_ptr<ConfigManager> config_;
+        std::string levelKey_;
+        std::string sampleKey_;
+        std::string sampleLevelKey_;
+    };
+} // namespace cnt
+
+#ifdef _CNT_LOGCONFIG_SAVED_ERROR_DEFINE_
+#define ERROR _CNT_LOGCONFIG_SAVED_ERROR_DEFINE_
+#undef _CNT_LOGCONFIG_SAVED_ERROR_DEFINE_
+#endif
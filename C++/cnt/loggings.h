@@ -10,10 +10,18 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <vector>
 #include <ctime>
 #include <sstream>
 #include <iomanip>
 #include <map>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+
+#include "instrument.h"
 
 #ifdef ERROR
 #define _CNT_LOGGING_SAVED_ERROR_DEFINE_ ERROR
@@ -43,16 +51,128 @@ namespace cnt
         CRITICAL = 4
     };
 
+    class Logger;
+
+    // Thins out high-volume records before they are formatted. Records at or
+    // below upTo are kept one in oneIn (ONE_IN_N) or each with the given
+    // probability (PROBABILITY); records above upTo are never sampled. Both
+    // run on per-thread state, nothing is shared between logging threads.
+    struct LogSampling
+    {
+        enum class Mode
+        {
+            NONE = 0,
+            ONE_IN_N = 1,
+            PROBABILITY = 2
+        };
+
+        Mode mode = Mode::NONE;
+        uint32_t oneIn = 1;
+        double probability = 1.0;
+        LogLevel upTo = LogLevel::DEBUG;
+
+        static LogSampling none() { return LogSampling(); }
+
+        static LogSampling everyNth(uint32_t n, LogLevel upTo = LogLevel::DEBUG)
+        {
+            LogSampling sampling;
+            sampling.mode = Mode::ONE_IN_N;
+            sampling.oneIn = n;
+            sampling.upTo = upTo;
+            return sampling;
+        }
+
+        static LogSampling withProbability(double probability, LogLevel upTo = LogLevel::DEBUG)
+        {
+            LogSampling sampling;
+            sampling.mode = Mode::PROBABILITY;
+            sampling.probability = probability;
+            sampling.upTo = upTo;
+            return sampling;
+        }
+    };
+
+    // Extra destination for formatted log lines, attached with Logger::addSink().
+    class LogSink
+    {
+    public:
+        LogSink() = default;
+        // Copies take the level, not the loggers the original is attached to.
+        LogSink(const LogSink& other) : level_(other.level_.load(std::memory_order_relaxed)) {}
+        LogSink& operator=(const LogSink& other)
+        {
+            setLevelValue(other.level_.load(std::memory_order_relaxed));
+            return *this;
+        }
+        virtual ~LogSink() = default;
+
+        // message is the formatted line including its trailing newline, without colour codes.
+        virtual void write(LogLevel level, const std::string& message) = 0;
+        virtual void flush() {}
+
+        // A sink follows its logger's level unless given its own threshold, which
+        // may be lower than the logger's (e.g. DEBUG into a flight recorder while
+        // the console and file stay at WARNING).
+        // Safe while other threads log through the sink.
+        LogSink& setLevel(LogLevel level)
+        {
+            setLevelValue(static_cast<int>(level));
+            return *this;
+        }
+
+        LogSink& followLoggerLevel()
+        {
+            setLevelValue(-1);
+            return *this;
+        }
+
+        LogLevel getLevel(LogLevel loggerLevel) const
+        {
+            const int level = level_.load(std::memory_order_relaxed);
+            return level < 0 ? loggerLevel : static_cast<LogLevel>(level);
+        }
+
+    private:
+        friend class Logger;
+
+        // Stores the level and has every logger the sink is attached to
+        // recompute its threshold.
+        void setLevelValue(int level);
+
+        void attach(Logger* owner)
+        {
+            std::lock_guard<std::mutex> lock(ownersMutex_);
+            owners_.push_back(owner);
+        }
+
+        void detach(Logger* owner)
+        {
+            std::lock_guard<std::mutex> lock(ownersMutex_);
+            auto it = std::find(owners_.begin(), owners_.end(), owner);
+            if (it != owners_.end()) owners_.erase(it);
+        }
+
+        void moveOwner(Logger* from, Logger* to)
+        {
+            std::lock_guard<std::mutex> lock(ownersMutex_);
+            std::replace(owners_.begin(), owners_.end(), from, to);
+        }
+
+        std::atomic<int> level_{-1};
+        std::mutex ownersMutex_;
+        std::vector<Logger*> owners_;   // one entry per addSink()
+    };
+
     class Logger
     {
     public:
         explicit Logger(const std::string& name = "root")
             : name_(name),
-            level_(LogLevel::INFO),
+            level_(static_cast<int>(LogLevel::INFO)),
+            file_(nullptr),
             format_("[{timestamp}] - {name} - {level} - {message}"),
             useColor_(true),
-            consoleOutputEnabled_(true),
-            file_(nullptr)
+            consoleOutputEnabled_(true)
         {
             setDefaultColors();
         }
@@ -62,30 +182,46 @@ namespace cnt
 
         Logger(Logger&& other) noexcept
             : name_(std::move(other.name_)),
-            level_(other.level_),
+            level_(other.level_.load(std::memory_order_relaxed)),
+            threshold_(other.threshold_.load(std::memory_order_relaxed)),
+            sampling_(other.sampling_.load(std::memory_order_relaxed)),
             file_(std::move(other.file_)),
             format_(std::move(other.format_)),
             useColor_(other.useColor_),
             consoleOutputEnabled_(other.consoleOutputEnabled_),
-            levelColors_(std::move(other.levelColors_))
+            levelColors_(std::move(other.levelColors_)),
+            sinks_(std::move(other.sinks_))
         {
+            for (const auto& sink : sinks_) sink->moveOwner(&other, this);
+            other.refreshThreshold();
         }
 
         Logger& operator=(Logger&& other) noexcept
         {
             if (this != &other)
             {
+                for (const auto& sink : sinks_) sink->detach(this);
                 name_ = std::move(other.name_);
-                level_ = other.level_;
+                level_.store(other.level_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                sampling_.store(other.sampling_.load(std::memory_order_relaxed), std::memory_order_relaxed);
                 file_ = std::move(other.file_);
                 format_ = std::move(other.format_);
                 useColor_ = other.useColor_;
                 consoleOutputEnabled_ = other.consoleOutputEnabled_;
                 levelColors_ = std::move(other.levelColors_);
+                sinks_ = std::move(other.sinks_);
+                for (const auto& sink : sinks_) sink->moveOwner(&other, this);
+                refreshThreshold();
+                other.refreshThreshold();
             }
             return *this;
         }
 
+        ~Logger()
+        {
+            for (const auto& sink : sinks_) sink->detach(this);
+        }
+
         // Configuration methods
         Logger& setFormat(const std::string& format)
         {
@@ -105,12 +241,23 @@ namespace cnt
             return *this;
         }
 
+        // The level and sampling may be changed while other threads log.
         Logger& setLevel(LogLevel level)
         {
-            level_ = level;
+            level_.store(static_cast<int>(level), std::memory_order_relaxed);
+            refreshThreshold();
+            return *this;
+        }
+
+        // Throws std::invalid_argument for a zero oneIn or a probability outside [0, 1].
+        Logger& setSampling(const LogSampling& sampling)
+        {
+            sampling_.store(encodeSampling(sampling), std::memory_order_relaxed);
             return *this;
         }
 
+        Logger& disableSampling() { return setSampling(LogSampling::none()); }
+
         Logger& setOutputFile(const std::string& filename)
         {
             file_.reset(new std::ofstream(filename, std::ios::app));
@@ -123,13 +270,94 @@ namespace cnt
             return *this;
         }
 
+        Logger& addSink(std::shared_ptr<LogSink> sink)
+        {
+            sink->attach(this);
+            {
+                std::lock_guard<std::mutex> lock(thresholdMutex_);
+                sinks_.push_back(std::move(sink));
+            }
+            refreshThreshold();
+            return *this;
+        }
+
+        // Detaches one attachment of the sink; false if it was not attached.
+        bool removeSink(const std::shared_ptr<LogSink>& sink)
+        {
+            auto it = std::find(sinks_.begin(), sinks_.end(), sink);
+            if (it == sinks_.end()) return false;
+            sink->detach(this);
+            {
+                std::lock_guard<std::mutex> lock(thresholdMutex_);
+                sinks_.erase(it);
+            }
+            refreshThreshold();
+            return true;
+        }
+
+        Logger& clearSinks()
+        {
+            for (const auto& sink : sinks_) sink->detach(this);
+            {
+                std::lock_guard<std::mutex> lock(thresholdMutex_);
+                sinks_.clear();
+            }
+            refreshThreshold();
+            return *this;
+        }
+
         // Getters
         const std::string& getName() const { return name_; }
-        LogLevel getLevel() const { return level_; }
+        LogLevel getLevel() const { return static_cast<LogLevel>(level_.load(std::memory_order_relaxed)); }
         const std::string& getFormat() const { return format_; }
         bool isColorEnabled() const { return useColor_; }
         bool isConsoleOutputEnabled() const { return consoleOutputEnabled_; }
         const std::map<LogLevel, LogColor>& getLevelColors() const { return levelColors_; }
+        const std::vector<std::shared_ptr<LogSink>>& getSinks() const { return sinks_; }
+
+        LogSampling getSampling() const { return decodeSampling(sampling_.load(std::memory_order_relaxed)); }
+
+        // Lowest level that reaches any output of this logger: one relaxed load.
+        // setLevel(), addSink(), removeSink(), clearSinks() and the attached
+        // sinks' setLevel() keep it up to date.
+        LogLevel getEffectiveLevel() const
+        {
+            return static_cast<LogLevel>(threshold_.load(std::memory_order_relaxed));
+        }
+
+        // Whether a record at `level` survives sampling.
+        bool sample(LogLevel level) const
+        {
+            const uint64_t sampling = sampling_.load(std::memory_order_relaxed);
+            const auto mode = static_cast<LogSampling::Mode>(sampling >> 40);
+            if (mode == LogSampling::Mode::NONE || static_cast<int>(level) > static_cast<int>((sampling >> 32) & 0xff))
+            {
+                return true;
+            }
+            const auto value = static_cast<uint32_t>(sampling);
+            if (mode == LogSampling::Mode::ONE_IN_N)
+            {
+                // Each thread keeps every value-th record. The countdown starts
+                // at a random phase whenever the thread switches loggers, so
+                // interleaving loggers does not bias the rate.
+                thread_local const Logger* owner = nullptr;
+                thread_local uint32_t countdown = 0;
+                if (owner != this || countdown >= value)
+                {
+                    owner = this;
+                    countdown = nextRandom() % value;
+                }
+                if (countdown == 0)
+                {
+                    countdown = value - 1;
+                    return true;
+                }
+                --countdown;
+                return false;
+            }
+            return nextRandom() < value;
+        }
+
         std::ofstream& getOutputFile()
         {
             if (!file_) file_.reset(new std::ofstream);
@@ -137,6 +365,73 @@ namespace cnt
         }
 
     private:
+        friend class LogSink;
+
+        // Recomputed whenever one of its inputs changes. Serialized so that two
+        // concurrent changes cannot leave the result of the older one behind;
+        // the mutex also guards sinks_ against a sink's setLevel() on another thread.
+        void refreshThreshold()
+        {
+            std::lock_guard<std::mutex> lock(thresholdMutex_);
+            const LogLevel own = getLevel();
+            LogLevel level = own;
+            for (const auto& sink : sinks_)
+            {
+                level = std::min(level, sink->getLevel(own));
+            }
+            threshold_.store(static_cast<int>(level), std::memory_order_relaxed);
+        }
+
+        // [mode:8][upTo:8][oneIn, or probability * 2^32:32] in one word, so a
+        // change is a single atomic store.
+        static uint64_t encodeSampling(const LogSampling& sampling)
+        {
+            uint64_t value = 0;
+            LogSampling::Mode mode = sampling.mode;
+            if (mode == LogSampling::Mode::ONE_IN_N)
+            {
+                if (sampling.oneIn == 0) throw std::invalid_argument("Log sampling of 1 in 0");
+                if (sampling.oneIn == 1) mode = LogSampling::Mode::NONE;
+                value = sampling.oneIn;
+            }
+            else if (mode == LogSampling::Mode::PROBABILITY)
+            {
+                if (!(sampling.probability >= 0.0 && sampling.probability <= 1.0))
+                {
+                    throw std::invalid_argument("Log sampling probability outside [0, 1]");
+                }
+                if (sampling.probability == 1.0) mode = LogSampling::Mode::NONE;
+                else value = static_cast<uint64_t>(sampling.probability * 4294967296.0);
+            }
+            if (mode == LogSampling::Mode::NONE) return 0;
+            return static_cast<uint64_t>(mode) << 40 | static_cast<uint64_t>(sampling.upTo) << 32 | value;
+        }
+
+        static LogSampling decodeSampling(uint64_t value)
+        {
+            const auto mode = static_cast<LogSampling::Mode>(value >> 40);
+            const auto upTo = static_cast<LogLevel>((value >> 32) & 0xff);
+            const auto low = static_cast<uint32_t>(value);
+            if (mode == LogSampling::Mode::ONE_IN_N) return LogSampling::everyNth(low, upTo);
+            if (mode == LogSampling::Mode::PROBABILITY) return LogSampling::withProbability(low / 4294967296.0, upTo);
+            return LogSampling::none();
+        }
+
+        // xorshift32 per thread.
+        static uint32_t nextRandom()
+        {
+            thread_local uint32_t state = 0;
+            if (state == 0)
+            {
+                uint64_t seed = reinterpret_cast<uintptr_t>(&state) ^ static_cast<uint64_t>(std::time(nullptr)) * 0x9E3779B97F4A7C15ull;
+                state = static_cast<uint32_t>(seed ^ (seed >> 32)) | 1;
+            }
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+
         void setDefaultColors()
         {
             levelColors_ = {
@@ -149,14 +444,25 @@ namespace cnt
         }
 
         std::string name_;
-        LogLevel level_;
+        std::atomic<int> level_;
+        std::atomic<int> threshold_{static_cast<int>(LogLevel::INFO)};   // see getEffectiveLevel()
+        std::mutex thresholdMutex_;
+        std::atomic<uint64_t> sampling_{0};
         std::unique_ptr<std::ofstream> file_;
         std::string format_;
         bool useColor_;
         bool consoleOutputEnabled_;
         std::map<LogLevel, LogColor> levelColors_;
+        std::vector<std::shared_ptr<LogSink>> sinks_;
     };
 
+    inline void LogSink::setLevelValue(int level)
+    {
+        std::lock_guard<std::mutex> lock(ownersMutex_);
+        level_.store(level, std::memory_order_relaxed);
+        for (Logger* owner : owners_) owner->refreshThreshold();
+    }
+
     class Logging
     {
     public:
@@ -200,7 +506,9 @@ namespace cnt
         template <typename... Args>
         void log(LogLevel level, const std::string& format, Args... args)
         {
-            if (level < logger_.getLevel()) return;
+            if (level < logger_.getEffectiveLevel() || !logger_.sample(level)) return;
+            const bool direct = level >= logger_.getLevel();
+            CNT_SCOPED_TIMER("logging.log");
 
             std::string message = formatMessage(format, std::forward<Args>(args)...);
             std::string timestamp = getCurrentTimestamp();
@@ -212,9 +520,14 @@ namespace cnt
             replaceAll(logMessage, "{level}", levelStr);
             replaceAll(logMessage, "{message}", message);
             logMessage += "\n";
+            CNT_COUNTER_ADD("logging.log.bytes", logMessage.size());
 
-            outputToConsole(level, logMessage);
-            outputToFile(logMessage);
+            if (direct)
+            {
+                outputToConsole(level, logMessage);
+                outputToFile(logMessage);
+            }
+            outputToSinks(level, logMessage);
         }
 
         void replaceAll(std::string& str, const std::string& from, const std::string& to)
@@ -234,7 +547,7 @@ namespace cnt
 		#if defined(_MSC_VER) || defined(__MINGW32__)
 	        localtime_s(&tm, &now);
 	    #else
-	        tm_ptr = localtime_r(&now, &tm);
+	        localtime_r(&now, &tm);
 	    #endif
             char buffer[80];
             std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
@@ -291,6 +604,14 @@ namespace cnt
             }
         }
 
+        void outputToSinks(LogLevel level, const std::string& message)
+        {
+            for (const auto& sink : logger_.getSinks())
+            {
+                if (level >= sink->getLevel(logger_.getLevel())) sink->write(level, message);
+            }
+        }
+
         Logger& logger_;
     };
 
@@ -0,0 +1,416 @@
+/**
+ * @file cnt/logring.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio),
+ * and according to the project license (MIT license) agreement,
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team.
+ * At the same time,
+ * project and documents can be used for commercial purposes under the condition of informing the development source,
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time,
+ * and any form of dispute event, CNT Development Team.
+ * and APlcexicesetrl shall not be liable for any damages,
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+ /* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <new>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__) || defined(__unix__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "loggings.h"
+
+#ifdef ERROR
+#define _CNT_LOGRING_SAVED_ERROR_DEFINE_ ERROR
+#undef ERROR
+#endif
+
+namespace cnt
+{
+    /*
+     * On-disk layout shared by MappedLogRing and LogRingReader.
+     *
+     *   [RingHeader (64 bytes)][data area, `capacity` bytes, used circularly]
+     *
+     * `head` counts every byte ever reserved, so a record's position is unique
+     * for the lifetime of the file and the live window is [head - capacity, head).
+     * Records are 8-byte aligned and may wrap around the end of the data area.
+     * Each one starts with a commit word that is cleared before the record is
+     * rewritten and set (to a value derived from its position) only after the
+     * rest of the record is in place, so a reader never accepts a torn record.
+     */
+    namespace logring
+    {
+        constexpr char MAGIC[8] = {'C', 'N', 'T', 'L', 'R', 'I', 'N', 'G'};
+        constexpr uint32_t VERSION = 1;
+        constexpr uint32_t COMMIT_TAG = 0x52474F4Cu;
+        constexpr uint64_t ALIGN = 8;
+
+        enum RecordType : uint8_t
+        {
+            TEXT = 0,
+            BINARY = 1
+        };
+
+        struct RingHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t headerSize;
+            uint64_t capacity;
+            std::atomic<uint64_t> head;
+            int64_t createdNs;
+            uint32_t pid;
+            uint32_t reserved;
+            uint64_t padding[2];
+        };
+        static_assert(sizeof(RingHeader) == 64, "ring header must stay 64 bytes");
+
+        struct RecordHeader
+        {
+            std::atomic<uint32_t> commit;
+            uint32_t size;          // whole record, header included, aligned
+            uint64_t pos;           // reservation position
+            int64_t timestamp;      // nanoseconds since the epoch
+            uint8_t level;
+            uint8_t type;
+            uint16_t reserved;
+            uint32_t length;        // payload bytes
+        };
+        static_assert(sizeof(RecordHeader) == 32, "record header must stay 32 bytes");
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring head must be lock free to live in a mapping");
+
+        inline uint32_t commitValue(uint64_t pos) { return COMMIT_TAG ^ static_cast<uint32_t>(pos / ALIGN); }
+
+        inline uint64_t alignUp(uint64_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+
+        inline int64_t nowNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        // Map `size` bytes of `path`; creates or resizes the file when `writable`.
+        class FileMapping
+        {
+        public:
+            FileMapping(const std::string& path, uint64_t size, bool writable)
+            {
+#if defined(_WIN32)
+                DWORD access = writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+                HANDLE file = CreateFileA(path.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                          nullptr, writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Failed to open log ring: " + path);
+                LARGE_INTEGER current;
+                GetFileSizeEx(file, &current);
+                if (!writable) size = static_cast<uint64_t>(current.QuadPart);
+                HANDLE mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                                    static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+                CloseHandle(file);
+                if (!mapping) throw std::runtime_error("Failed to map log ring: " + path);
+                data_ = static_cast<uint8_t*>(MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+                if (!data_) throw std::runtime_error("Failed to map log ring: " + path);
+#elif defined(__linux__) || defined(__unix__)
+                int fd = ::open(path.c_str(), writable ? O_RDWR | O_CREAT | O_CLOEXEC : O_RDONLY | O_CLOEXEC, 0644);
+                if (fd < 0) throw std::runtime_error("Failed to open log ring: " + path);
+                struct stat st;
+                if (fstat(fd, &st) != 0) {
+                    ::close(fd);
+                    throw std::runtime_error("Failed to stat log ring: " + path);
+                }
+                if (!writable) {
+                    size = static_cast<uint64_t>(st.st_size);
+                }
+                else if (static_cast<uint64_t>(st.st_size) != size && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                    ::close(fd);
+                    throw std::runtime_error("Failed to size log ring: " + path);
+                }
+                void* p = size ? mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0)
+                               : MAP_FAILED;
+                ::close(fd);
+                if (p == MAP_FAILED) throw std::runtime_error("Failed to map log ring: " + path);
+                data_ = static_cast<uint8_t*>(p);
+#else
+                throw std::runtime_error("Memory-mapped log rings are not supported on this platform");
+#endif
+                size_ = size;
+            }
+
+            ~FileMapping()
+            {
+#if defined(_WIN32)
+                if (data_) UnmapViewOfFile(data_);
+#elif defined(__linux__) || defined(__unix__)
+                if (data_) munmap(data_, size_);
+#endif
+            }
+
+            FileMapping(const FileMapping&) = delete;
+            FileMapping& operator=(const FileMapping&) = delete;
+
+            uint8_t* data() const { return data_; }
+            uint64_t size() const { return size_; }
+
+            // Schedule write-back; only needed to survive a kernel crash or power loss.
+            void sync(bool wait) const
+            {
+#if defined(_WIN32)
+                FlushViewOfFile(data_, 0);
+                (void)wait;
+#elif defined(__linux__) || defined(__unix__)
+                msync(data_, size_, wait ? MS_SYNC : MS_ASYNC);
+#endif
+            }
+
+        private:
+            uint8_t* data_ = nullptr;
+            uint64_t size_ = 0;
+        };
+    } // namespace logring
+
+    /*
+     * Flight recorder: a Logger sink that keeps the most recent records in a
+     * fixed-size memory-mapped file.
+     *
+     * Appending is a fetch_add on the shared head plus plain stores into the
+     * mapping, with no system call and no lock, so it is cheap enough to leave
+     * DEBUG switched on permanently (give the sink its own level with
+     * LogSink::setLevel while the logger stays at WARNING). The pages belong to
+     * the file, so the history survives a crash or SIGKILL of the process and
+     * is picked up again when the ring is reopened; use LogRingReader or
+     * tools/logring_dump to read it. Call sync() if it also has to survive a
+     * machine crash.
+     *
+     * Several threads may append concurrently. Records larger than a quarter
+     * of the ring are truncated.
+     */
+    class MappedLogRing : public LogSink
+    {
+    public:
+        static constexpr uint64_t DEFAULT_CAPACITY = 4u << 20;
+
+        // Opens the ring at `path`, keeping its history if it was created with
+        // the same capacity, otherwise starting a new one.
+        explicit MappedLogRing(const std::string& path, uint64_t capacity = DEFAULT_CAPACITY)
+            : capacity_(logring::alignUp(capacity < 4096 ? 4096 : capacity)),
+            map_(path, sizeof(logring::RingHeader) + capacity_, true)
+        {
+            header_ = reinterpret_cast<logring::RingHeader*>(map_.data());
+            data_ = map_.data() + sizeof(logring::RingHeader);
+
+            const bool reuse = std::memcmp(header_->magic, logring::MAGIC, sizeof(logring::MAGIC)) == 0 &&
+                               header_->version == logring::VERSION &&
+                               header_->headerSize == sizeof(logring::RingHeader) &&
+                               header_->capacity == capacity_;
+            if (!reuse) {
+                std::memset(map_.data(), 0, map_.size());
+                new (&header_->head) std::atomic<uint64_t>(0);
+                header_->version = logring::VERSION;
+                header_->headerSize = sizeof(logring::RingHeader);
+                header_->capacity = capacity_;
+                header_->createdNs = logring::nowNs();
+                std::memcpy(header_->magic, logring::MAGIC, sizeof(logring::MAGIC));
+            }
+#if defined(_WIN32)
+            header_->pid = static_cast<uint32_t>(GetCurrentProcessId());
+#elif defined(__linux__) || defined(__unix__)
+            header_->pid = static_cast<uint32_t>(getpid());
+#endif
+            setLevel(LogLevel::DEBUG);
+        }
+
+        MappedLogRing(const MappedLogRing&) = delete;
+        MappedLogRing& operator=(const MappedLogRing&) = delete;
+
+        void write(LogLevel level, const std::string& message) override
+        {
+            append(level, logring::TEXT, message.data(), message.size());
+        }
+
+        void flush() override { map_.sync(false); }
+
+        void sync() { map_.sync(true); }
+
+        // Store one record; returns its position (usable to correlate with the reader).
+        uint64_t append(LogLevel level, uint8_t type, const void* payload, size_t length)
+        {
+            const uint64_t limit = capacity_ / 4 - sizeof(logring::RecordHeader);
+            if (length > limit) length = static_cast<size_t>(limit);
+            const uint32_t size = static_cast<uint32_t>(logring::alignUp(sizeof(logring::RecordHeader) + length));
+
+            const uint64_t pos = header_->head.fetch_add(size, std::memory_order_relaxed);
+            const uint64_t offset = pos % capacity_;
+
+            // The first 8 bytes never wrap: records and the capacity are 8-byte aligned.
+            auto* commit = reinterpret_cast<std::atomic<uint32_t>*>(data_ + offset);
+            commit->store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            logring::RecordHeader rec;
+            rec.size = size;
+            rec.pos = pos;
+            rec.timestamp = logring::nowNs();
+            rec.level = static_cast<uint8_t>(level);
+            rec.type = type;
+            rec.reserved = 0;
+            rec.length = static_cast<uint32_t>(length);
+            const size_t fieldsOffset = sizeof(std::atomic<uint32_t>);
+            copyIn(offset + fieldsOffset, reinterpret_cast<const uint8_t*>(&rec) + fieldsOffset,
+                   sizeof(rec) - fieldsOffset);
+            copyIn(offset + sizeof(rec), static_cast<const uint8_t*>(payload), length);
+
+            commit->store(logring::commitValue(pos), std::memory_order_release);
+            return pos;
+        }
+
+        // POD payloads are stored verbatim as BINARY records.
+        template <typename T>
+        uint64_t appendBinary(LogLevel level, const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "binary records must be trivially copyable");
+            return append(level, logring::BINARY, &value, sizeof(value));
+        }
+
+        uint64_t capacity() const { return capacity_; }
+        uint64_t bytesWritten() const { return header_->head.load(std::memory_order_relaxed); }
+
+    private:
+        void copyIn(uint64_t offset, const uint8_t* src, size_t length)
+        {
+            offset %= capacity_;
+            const size_t first = static_cast<size_t>(std::min<uint64_t>(length, capacity_ - offset));
+            std::memcpy(data_ + offset, src, first);
+            if (first < length) std::memcpy(data_, src + first, length - first);
+        }
+
+        uint64_t capacity_;
+        logring::FileMapping map_;
+        logring::RingHeader* header_ = nullptr;
+        uint8_t* data_ = nullptr;
+    };
+
+    /*
+     * Reads a log ring written by MappedLogRing, either after the writer is gone
+     * or while it is still running. Records are delivered oldest first; records
+     * that were torn by a crash, or overwritten while being read, are skipped.
+     */
+    class LogRingReader
+    {
+    public:
+        struct Entry
+        {
+            uint64_t pos;
+            int64_t timestamp;
+            LogLevel level;
+            uint8_t type;
+            std::string_view payload;   // valid only during the callback
+        };
+
+        explicit LogRingReader(const std::string& path)
+            : map_(path, 0, false)
+        {
+            if (map_.size() < sizeof(logring::RingHeader)) throw std::runtime_error("Not a log ring: " + path);
+            header_ = reinterpret_cast<const logring::RingHeader*>(map_.data());
+            if (std::memcmp(header_->magic, logring::MAGIC, sizeof(logring::MAGIC)) != 0 ||
+                header_->version != logring::VERSION ||
+                header_->headerSize != sizeof(logring::RingHeader) ||
+                header_->capacity % logring::ALIGN != 0 ||
+                map_.size() < sizeof(logring::RingHeader) + header_->capacity) {
+                throw std::runtime_error("Not a log ring: " + path);
+            }
+            capacity_ = header_->capacity;
+            data_ = map_.data() + sizeof(logring::RingHeader);
+        }
+
+        uint64_t capacity() const { return capacity_; }
+        uint64_t head() const { return header_->head.load(std::memory_order_acquire); }
+        uint32_t writerPid() const { return header_->pid; }
+        int64_t createdNs() const { return header_->createdNs; }
+
+        // Calls fn(const Entry&) for every intact record; returns how many were delivered.
+        template <typename Fn>
+        size_t forEach(Fn&& fn) const
+        {
+            const uint64_t end = head();
+            uint64_t pos = end > capacity_ ? logring::alignUp(end - capacity_) : 0;
+            size_t delivered = 0;
+            std::vector<uint8_t> buffer;
+
+            while (pos + sizeof(logring::RecordHeader) <= end) {
+                const uint64_t offset = pos % capacity_;
+                const auto* commit = reinterpret_cast<const std::atomic<uint32_t>*>(data_ + offset);
+                logring::RecordHeader rec;
+                if (commit->load(std::memory_order_acquire) != logring::commitValue(pos)) {
+                    pos += logring::ALIGN;   // torn or in-flight record: resynchronise
+                    continue;
+                }
+                copyOut(offset, reinterpret_cast<uint8_t*>(&rec) + sizeof(std::atomic<uint32_t>),
+                        sizeof(std::atomic<uint32_t>), sizeof(rec) - sizeof(std::atomic<uint32_t>));
+                if (rec.pos != pos || rec.size < sizeof(rec) || rec.size > capacity_ / 4 ||
+                    rec.length > rec.size - sizeof(rec) || pos + rec.size > end) {
+                    pos += logring::ALIGN;
+                    continue;
+                }
+
+                buffer.resize(rec.length);
+                copyOut(offset, buffer.data(), sizeof(rec), rec.length);
+
+                // A writer that reserved past pos + capacity may have overwritten the copy.
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (head() > pos + capacity_) {
+                    pos += rec.size;
+                    continue;
+                }
+
+                Entry entry{pos, rec.timestamp, static_cast<LogLevel>(rec.level), rec.type,
+                            std::string_view(reinterpret_cast<const char*>(buffer.data()), buffer.size())};
+                fn(entry);
+                ++delivered;
+                pos += rec.size;
+            }
+            return delivered;
+        }
+
+    private:
+        void copyOut(uint64_t offset, uint8_t* dst, uint64_t skip, size_t length) const
+        {
+            offset = (offset + skip) % capacity_;
+            const size_t first = static_cast<size_t>(std::min<uint64_t>(length, capacity_ - offset));
+            std::memcpy(dst, data_ + offset, first);
+            if (first < length) std::memcpy(dst + first, data_, length - first);
+        }
+
+        logring::FileMapping map_;
+        const logring::RingHeader* header_ = nullptr;
+        const uint8_t* data_ = nullptr;
+        uint64_t capacity_ = 0;
+    };
+
+} // namespace cnt
+
+#ifdef _CNT_LOGRING_SAVED_ERROR_DEFINE_
+#define ERROR _CNT_LOGRING_SAVED_ERROR_DEFINE_
+#undef _CNT_LOGRING_SAVED_ERROR_DEFINE_
+#endif
@@ -0,0 +1,451 @@
+/**
+ * @file cnt/mmapalloc.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio), 
+ * and according to the project license (MIT license) agreement, 
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team. 
+ * At the same time, 
+ * project and documents can be used for commercial purposes under the condition of informing the development source, 
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time, 
+ * and any form of dispute event, CNT Development Team. 
+ * and APlcexicesetrl shall not be liable for any damages, 
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+ /* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Vector.h"
+
+/*
+ * Page-mapped storage for very large cnt::Vector instances.
+ *
+ * mmap_allocator maps blocks of at least _MIN_MAP bytes straight from the
+ * kernel (smaller ones come from aligned_allocator) and grows them with
+ * mremap(), which moves page table entries instead of copying elements.
+ * page_mode::transparent_huge aligns mappings to 2 MiB and asks for
+ * transparent huge pages with MADV_HUGEPAGE; page_mode::hugetlb maps from
+ * the hugetlbfs pool (vm.nr_hugepages) and falls back to transparent huge
+ * pages when the pool is empty. Huge pages cut TLB misses on large random
+ * access working sets.
+ *
+ * file_allocator keeps a Vector's elements in a file mapped MAP_SHARED, so
+ * they persist; a Vector constructed from a file_allocator opened on an
+ * existing file starts out holding the stored elements, with nothing read
+ * or parsed.
+ *
+ * Linux only for mremap() and huge pages; other POSIX systems map and copy,
+ * and on Windows mmap_allocator is a plain aligned_allocator.
+ */
+
+namespace cnt {
+	enum class page_mode { normal, transparent_huge, hugetlb };
+
+	struct mapping_stats {
+		uint64_t maps;                // blocks mapped from the kernel
+		uint64_t remaps;              // grown or shrunk by mremap()
+		uint64_t remap_copies;        // resized by mapping a new block and copying
+		uint64_t hugetlb_fallbacks;   // hugetlb requests served with transparent huge pages
+		uint64_t mapped_bytes;        // currently mapped by mmap_allocator
+	};
+
+	namespace detail {
+		constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+		struct mapping_counters {
+			std::atomic<uint64_t> maps{0};
+			std::atomic<uint64_t> remaps{0};
+			std::atomic<uint64_t> remap_copies{0};
+			std::atomic<uint64_t> hugetlb_fallbacks{0};
+			std::atomic<uint64_t> mapped_bytes{0};
+		};
+
+		inline mapping_counters& map_counters() noexcept {
+			static mapping_counters counters;
+			return counters;
+		}
+
+		inline size_t os_page_size() noexcept {
+#if defined(_WIN32)
+			return 4096;
+#else
+			static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+			return size;
+#endif
+		}
+
+		inline size_t round_up(size_t bytes, size_t unit) {
+			if (bytes > static_cast<size_t>(-1) - unit) throw std::bad_alloc();
+			return (bytes + unit - 1) / unit * unit;
+		}
+
+#if !defined(_WIN32)
+		inline void* map_anonymous(size_t length, page_mode mode) {
+			auto& counters = map_counters();
+#if defined(__linux__) && defined(MAP_HUGETLB)
+			if (mode == page_mode::hugetlb) {
+				void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+				if (p != MAP_FAILED) {
+					counters.maps.fetch_add(1, std::memory_order_relaxed);
+					return p;
+				}
+				counters.hugetlb_fallbacks.fetch_add(1, std::memory_order_relaxed);
+				mode = page_mode::transparent_huge;
+			}
+#endif
+			if (mode == page_mode::normal) {
+				void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (p == MAP_FAILED) throw std::bad_alloc();
+				counters.maps.fetch_add(1, std::memory_order_relaxed);
+				return p;
+			}
+			// Over-map and trim so the block starts on a huge page boundary.
+			const size_t span = length + HUGE_PAGE_SIZE;
+			void* raw = ::mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (raw == MAP_FAILED) throw std::bad_alloc();
+			const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+			const uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~uintptr_t(HUGE_PAGE_SIZE - 1);
+			if (aligned > start) ::munmap(raw, aligned - start);
+			if (start + span > aligned + length) ::munmap(reinterpret_cast<void*>(aligned + length), start + span - aligned - length);
+			void* p = reinterpret_cast<void*>(aligned);
+#if defined(MADV_HUGEPAGE)
+			::madvise(p, length, MADV_HUGEPAGE);
+#endif
+			counters.maps.fetch_add(1, std::memory_order_relaxed);
+			return p;
+		}
+
+		// Resizes a mapping, in place or by moving its pages; nullptr if the kernel
+		// cannot (no mremap(), or hugetlb mappings before Linux 6.3).
+		inline void* remap(void* p, size_t old_length, size_t new_length) noexcept {
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+			void* q = ::mremap(p, old_length, new_length, MREMAP_MAYMOVE);
+			if (q != MAP_FAILED) {
+				map_counters().remaps.fetch_add(1, std::memory_order_relaxed);
+				return q;
+			}
+#else
+			(void)p; (void)old_length; (void)new_length;
+#endif
+			return nullptr;
+		}
+#endif
+	}
+
+	inline mapping_stats mapped_memory_stats() noexcept {
+		const auto& c = detail::map_counters();
+		return mapping_stats{c.maps.load(std::memory_order_relaxed), c.remaps.load(std::memory_order_relaxed),
+			c.remap_copies.load(std::memory_order_relaxed), c.hugetlb_fallbacks.load(std::memory_order_relaxed),
+			c.mapped_bytes.load(std::memory_order_relaxed)};
+	}
+
+	// Blocks below _MIN_MAP bytes come from aligned_allocator. The block size
+	// decides where a block lives, so allocate() and deallocate() agree without
+	// any bookkeeping.
+	template<typename T, page_mode _MODE = page_mode::transparent_huge, size_t _MIN_MAP = size_t(1) << 20>
+	struct mmap_allocator {
+		using value_type = T;
+		static constexpr page_mode mode = _MODE;
+
+		template<typename U>
+		struct rebind { using other = mmap_allocator<U, _MODE, _MIN_MAP>; };
+
+		mmap_allocator() noexcept = default;
+		template<typename U>
+		mmap_allocator(const mmap_allocator<U, _MODE, _MIN_MAP>&) noexcept {}
+
+		T* allocate(size_t n) {
+			const size_t bytes = byte_size(n);
+#if !defined(_WIN32)
+			if (mapped(bytes)) {
+				const size_t length = map_length(bytes);
+				T* p = static_cast<T*>(detail::map_anonymous(length, _MODE));
+				detail::map_counters().mapped_bytes.fetch_add(length, std::memory_order_relaxed);
+				return p;
+			}
+#endif
+			return heap().allocate(n);
+		}
+
+		void deallocate(T* p, size_t n) noexcept {
+#if !defined(_WIN32)
+			const size_t bytes = n * sizeof(T);
+			if (mapped(bytes)) {
+				const size_t length = map_length(bytes);
+				::munmap(p, length);
+				detail::map_counters().mapped_bytes.fetch_sub(length, std::memory_order_relaxed);
+				return;
+			}
+#endif
+			heap().deallocate(p, n);
+		}
+
+		// Used by Vector for trivially relocatable elements.
+		T* reallocate(T* p, size_t old_n, size_t new_n) {
+			const size_t old_bytes = old_n * sizeof(T), new_bytes = byte_size(new_n);
+#if !defined(_WIN32)
+			if (mapped(old_bytes) && mapped(new_bytes)) {
+				const size_t old_length = map_length(old_bytes), new_length = map_length(new_bytes);
+				if (old_length == new_length) return p;
+				if (void* q = detail::remap(p, old_length, new_length)) {
+					auto& mapped_bytes = detail::map_counters().mapped_bytes;
+					mapped_bytes.fetch_add(new_length, std::memory_order_relaxed);
+					mapped_bytes.fetch_sub(old_length, std::memory_order_relaxed);
+					return static_cast<T*>(q);
+				}
+				detail::map_counters().remap_copies.fetch_add(1, std::memory_order_relaxed);
+			}
+			else if (mapped(old_bytes) || mapped(new_bytes)) {
+				// Crossing _MIN_MAP: nothing to remap, move the bytes once.
+			}
+			else {
+				return heap().reallocate(p, old_n, new_n);
+			}
+			T* q = allocate(new_n);
+			std::memcpy(static_cast<void*>(q), p, std::min(old_bytes, new_bytes));
+			deallocate(p, old_n);
+			return q;
+#else
+			return heap().reallocate(p, old_n, new_n);
+#endif
+		}
+
+		template<typename U>
+		bool operator==(const mmap_allocator<U, _MODE, _MIN_MAP>&) const noexcept { return true; }
+		template<typename U>
+		bool operator!=(const mmap_allocator<U, _MODE, _MIN_MAP>&) const noexcept { return false; }
+
+	private:
+		static aligned_allocator<T> heap() noexcept { return aligned_allocator<T>(); }
+
+		static size_t byte_size(size_t n) {
+			if (n > static_cast<size_t>(-1) / sizeof(T)) throw std::bad_alloc();
+			return n * sizeof(T);
+		}
+
+		static bool mapped(size_t bytes) noexcept { return bytes >= _MIN_MAP && bytes != 0; }
+
+		static size_t map_length(size_t bytes) {
+			return detail::round_up(bytes, _MODE == page_mode::normal ? detail::os_page_size() : detail::HUGE_PAGE_SIZE);
+		}
+	};
+
+	/*
+	 * Storage in a file, for one Vector at a time.
+	 *
+	 * The file is a 4 KiB header page (magic, element size, element count,
+	 * capacity) followed by the elements, and stays mapped while any copy of the
+	 * allocator lives. Vector(alloc) adopts the stored elements; the count is
+	 * written back when the Vector releases its storage, and sync() records it
+	 * and flushes the mapping at any other time. Elements are stored as their
+	 * bytes, so T must be trivially copyable and the file is only portable
+	 * between builds with the same layout of T.
+	 */
+	template<typename T>
+	class file_allocator {
+		static_assert(std::is_trivially_copyable<T>::value, "file_allocator stores elements as raw bytes");
+
+	public:
+		using value_type = T;
+		static constexpr size_t HEADER_SIZE = 4096;
+
+		// Opens or creates path; truncate discards stored elements.
+		explicit file_allocator(const std::string& path, bool truncate = false)
+			: _file(std::make_shared<file>(path, truncate)) {}
+
+		// Moving copies: Vector moves its allocator, and a moved-from Vector must
+		// still reach the file so that reusing it is refused by allocate()
+		// instead of dereferencing an empty pointer.
+		file_allocator(const file_allocator&) = default;
+		file_allocator(file_allocator&& other) noexcept : _file(other._file) {}
+		file_allocator& operator=(const file_allocator&) = default;
+		file_allocator& operator=(file_allocator&& other) noexcept {
+			_file = other._file;
+			return *this;
+		}
+
+		T* allocate(size_t n) {
+			if (_file->live) throw std::logic_error("file_allocator already backs a Vector: " + _file->path);
+			_file->resize(n);
+			_file->live = true;
+			return _file->data();
+		}
+
+		void deallocate(T*, size_t) noexcept {
+			_file->live = false;
+		}
+
+		T* reallocate(T*, size_t, size_t new_n) {
+			_file->resize(new_n);
+			return _file->data();
+		}
+
+		// Hands the stored elements to the first Vector constructed from this file.
+		T* adopt(size_t& size, size_t& capacity) noexcept {
+			file& f = *_file;
+			if (f.live || f.header()->capacity == 0) return nullptr;
+			f.live = true;
+			size = static_cast<size_t>(f.header()->size);
+			capacity = static_cast<size_t>(f.header()->capacity);
+			return f.data();
+		}
+
+		void retain(const T*, size_t size) noexcept {
+			_file->header()->size = size;
+		}
+
+		// Records size as the element count and writes the mapping back to disk.
+		void sync(size_t size) {
+			retain(nullptr, size);
+#if !defined(_WIN32)
+			if (::msync(_file->base, _file->length, MS_SYNC) != 0) {
+				throw std::runtime_error("msync() failed: " + _file->path);
+			}
+#endif
+		}
+
+		// Element count stored in the file.
+		size_t stored_size() const noexcept { return static_cast<size_t>(_file->header()->size); }
+		const std::string& path() const noexcept { return _file->path; }
+
+		bool operator==(const file_allocator& other) const noexcept { return _file == other._file; }
+		bool operator!=(const file_allocator& other) const noexcept { return _file != other._file; }
+
+	private:
+		struct header_page {
+			char magic[8];
+			uint64_t element_size;
+			uint64_t size;
+			uint64_t capacity;
+		};
+
+		struct file {
+			std::string path;
+			int fd = -1;
+			char* base = nullptr;
+			size_t length = 0;
+			bool live = false;
+
+			file(const std::string& p, bool truncate) : path(p) {
+#if defined(_WIN32)
+				(void)truncate;
+				throw std::runtime_error("file_allocator is not supported on this platform");
+#else
+				fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+				if (fd < 0) throw std::runtime_error("Failed to open Vector file: " + path);
+				struct stat st;
+				if (::fstat(fd, &st) != 0) {
+					::close(fd);
+					throw std::runtime_error("Failed to stat Vector file: " + path);
+				}
+				try {
+					if (st.st_size == 0) {
+						if (::ftruncate(fd, HEADER_SIZE) != 0) throw std::runtime_error("Failed to extend Vector file: " + path);
+						map(HEADER_SIZE);
+						std::memcpy(header()->magic, "CNTVECF1", 8);
+						header()->element_size = sizeof(T);
+						header()->size = 0;
+						header()->capacity = 0;
+					}
+					else {
+						if (static_cast<uint64_t>(st.st_size) < HEADER_SIZE) throw std::runtime_error("Invalid Vector file: " + path);
+						map(static_cast<size_t>(st.st_size));
+						const header_page& h = *header();
+						if (std::memcmp(h.magic, "CNTVECF1", 8) != 0 || h.element_size != sizeof(T) ||
+							h.size > h.capacity || h.capacity > (length - HEADER_SIZE) / sizeof(T)) {
+							throw std::runtime_error("Invalid Vector file: " + path);
+						}
+					}
+				}
+				catch (...) {
+					if (base) ::munmap(base, length);
+					::close(fd);
+					throw;
+				}
+#endif
+			}
+
+			file(const file&) = delete;
+			file& operator=(const file&) = delete;
+
+			~file() {
+#if !defined(_WIN32)
+				if (base) ::munmap(base, length);
+				if (fd >= 0) ::close(fd);
+#endif
+			}
+
+			header_page* header() const noexcept { return reinterpret_cast<header_page*>(base); }
+			T* data() const noexcept { return reinterpret_cast<T*>(base + HEADER_SIZE); }
+
+#if !defined(_WIN32)
+			void map(size_t new_length) {
+				void* p = ::mmap(nullptr, new_length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+				if (p == MAP_FAILED) throw std::runtime_error("Failed to map Vector file: " + path);
+				base = static_cast<char*>(p);
+				length = new_length;
+			}
+#endif
+
+			// The file holds exactly the header and capacity elements, page-rounded.
+			void resize(size_t capacity) {
+#if !defined(_WIN32)
+				if (capacity > (static_cast<size_t>(-1) - 2 * HEADER_SIZE) / sizeof(T)) throw std::bad_alloc();
+				const size_t new_length = detail::round_up(HEADER_SIZE + capacity * sizeof(T), detail::os_page_size());
+				if (new_length != length) {
+					const size_t length_before = length;
+					if (new_length > length && ::ftruncate(fd, static_cast<off_t>(new_length)) != 0) {
+						throw std::runtime_error("Failed to extend Vector file: " + path);
+					}
+					// The pages belong to the file, so a mapping that cannot be
+					// resized is simply replaced.
+					if (void* q = detail::remap(base, length, new_length)) {
+						base = static_cast<char*>(q);
+						length = new_length;
+					}
+					else {
+						::munmap(base, length);
+						base = nullptr;
+						map(new_length);
+					}
+					if (new_length < length_before && ::ftruncate(fd, static_cast<off_t>(new_length)) != 0) {
+						throw std::runtime_error("Failed to shrink Vector file: " + path);
+					}
+				}
+				header()->capacity = capacity;
+#else
+				(void)capacity;
+#endif
+			}
+		};
+
+		std::shared_ptr<file> _file;
+	};
+
+	template<typename T>
+	using huge_vector = Vector<T, 0, mmap_allocator<T, page_mode::transparent_huge>>;
+
+	template<typename T>
+	using file_vector = Vector<T, 0, file_allocator<T>>;
+}
@@ -0,0 +1,437 @@
+/**
+ * @file cnt/parallel.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio), 
+ * and according to the project license (MIT license) agreement, 
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team. 
+ * At the same time, 
+ * project and documents can be used for commercial purposes under the condition of informing the development source, 
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time, 
+ * and any form of dispute event, CNT Development Team. 
+ * and APlcexicesetrl shall not be liable for any damages, 
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+ /* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Vector.h"
+
+/*
+ * Parallel sort, transform, reduce, for_each and find_if over random-access
+ * ranges and cnt::Vector.
+ *
+ * Work runs on a thread_pool: every worker owns a task deque, takes its own
+ * work newest-first and steals the oldest tasks of the others when it runs
+ * dry. A thread waiting for its tasks runs queued tasks instead of blocking,
+ * so algorithms may be nested inside each other's callbacks. Algorithms use
+ * thread_pool::shared() unless options::pool says otherwise.
+ *
+ * Inputs are cut into chunks of options::grain elements (by default at
+ * least MIN_GRAIN and at most MAX_CHUNKS chunks); an input that fits in one
+ * chunk is processed serially on the calling thread without touching the
+ * pool. The chunking depends only on the input size and the grain, never on
+ * the thread count, and reduce() combines the chunk results left to right:
+ * with the same grain, reduce() of floating-point data gives bit-identical
+ * results on any pool.
+ */
+
+namespace cnt {
+namespace parallel {
+	class thread_pool;
+
+	struct options {
+		size_t grain = 0;              // elements per task; 0 picks one from the input size
+		thread_pool* pool = nullptr;   // nullptr uses thread_pool::shared()
+	};
+
+	constexpr size_t MIN_GRAIN = 4096;
+	constexpr size_t MAX_CHUNKS = 256;
+
+	namespace detail {
+		struct task_group {
+			std::atomic<size_t> pending{0};
+			std::atomic<bool> failed{false};
+			std::exception_ptr error;
+			std::mutex error_mutex;
+
+			void fail(std::exception_ptr e) {
+				std::lock_guard<std::mutex> lock(error_mutex);
+				if (!error) error = std::move(e);
+				failed.store(true, std::memory_order_relaxed);
+			}
+		};
+
+		struct task {
+			void (*run)(const void* body, size_t index);
+			const void* body;
+			size_t index;
+			task_group* group;
+		};
+
+		struct alignas(64) task_queue {
+			std::mutex mutex;
+			std::deque<task> tasks;
+		};
+	}
+
+	class thread_pool {
+	public:
+		// threads counts the calling thread, which works while it waits; a pool
+		// of one runs everything inline.
+		explicit thread_pool(size_t threads = default_threads())
+			: _threads(threads ? threads : 1), _queues(_threads) {
+			_workers.reserve(_threads - 1);
+			for (size_t i = 1; i < _threads; ++i) _workers.emplace_back([this, i] { work(i); });
+		}
+
+		thread_pool(const thread_pool&) = delete;
+		thread_pool& operator=(const thread_pool&) = delete;
+
+		~thread_pool() {
+			{
+				std::lock_guard<std::mutex> lock(_sleep_mutex);
+				_stop = true;
+			}
+			_wake.notify_all();
+			for (auto& worker : _workers) worker.join();
+		}
+
+		static size_t default_threads() noexcept {
+			return std::max<size_t>(1, std::thread::hardware_concurrency());
+		}
+
+		// One pool per process, created on first use.
+		static thread_pool& shared() {
+			static thread_pool pool;
+			return pool;
+		}
+
+		size_t concurrency() const noexcept { return _threads; }
+
+		// Calls body(i) for every i in [0, tasks) and returns once all calls have
+		// finished. If a call throws, calls not yet started are skipped and the
+		// first exception is rethrown here.
+		template<typename F>
+		void run(size_t tasks, const F& body) {
+			if (tasks == 0) return;
+			if (tasks == 1 || _threads == 1) {
+				for (size_t i = 0; i < tasks; ++i) body(i);
+				return;
+			}
+			detail::task_group group;
+			group.pending.store(tasks, std::memory_order_relaxed);
+			submit(group, &invoke<F>, &body, tasks);
+			wait(group);
+		}
+
+	private:
+		struct worker_slot {
+			const thread_pool* pool;
+			size_t index;
+		};
+
+		static worker_slot& current() noexcept {
+			static thread_local worker_slot slot{nullptr, 0};
+			return slot;
+		}
+
+		// Queue 0 takes work submitted from threads outside the pool.
+		size_t self() const noexcept {
+			const worker_slot& slot = current();
+			return slot.pool == this ? slot.index : 0;
+		}
+
+		template<typename F>
+		static void invoke(const void* body, size_t index) {
+			(*static_cast<const F*>(body))(index);
+		}
+
+		void submit(detail::task_group& group, void (*fn)(const void*, size_t), const void* body, size_t tasks) {
+			detail::task_queue& queue = _queues[self()];
+			{
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				for (size_t i = 0; i < tasks; ++i) queue.tasks.push_back(detail::task{fn, body, i, &group});
+			}
+			_queued.fetch_add(tasks);
+			if (_sleeping.load() > 0) {
+				std::lock_guard<std::mutex> lock(_sleep_mutex);
+				_wake.notify_all();
+			}
+		}
+
+		bool pop(size_t index, detail::task& out) {
+			// Own work newest first, keeping it cache-warm ...
+			{
+				detail::task_queue& queue = _queues[index];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				if (!queue.tasks.empty()) {
+					out = queue.tasks.back();
+					queue.tasks.pop_back();
+					return true;
+				}
+			}
+			// ... then the oldest, largest-grained work of the others.
+			for (size_t k = 1; k < _threads; ++k) {
+				detail::task_queue& queue = _queues[(index + k) % _threads];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				if (!queue.tasks.empty()) {
+					out = queue.tasks.front();
+					queue.tasks.pop_front();
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool run_one(size_t index) {
+			detail::task t;
+			if (!pop(index, t)) return false;
+			_queued.fetch_sub(1);
+			if (!t.group->failed.load(std::memory_order_relaxed)) {
+				try {
+					t.run(t.body, t.index);
+				} catch (...) {
+					t.group->fail(std::current_exception());
+				}
+			}
+			// Last touch of the group: the waiter may return as soon as it sees zero.
+			t.group->pending.fetch_sub(1, std::memory_order_acq_rel);
+			return true;
+		}
+
+		void wait(detail::task_group& group) {
+			const size_t index = self();
+			while (group.pending.load(std::memory_order_acquire) != 0) {
+				if (!run_one(index)) std::this_thread::yield();
+			}
+			if (group.error) std::rethrow_exception(group.error);
+		}
+
+		void work(size_t index) {
+			current() = worker_slot{this, index};
+			for (;;) {
+				if (run_one(index)) continue;
+				std::unique_lock<std::mutex> lock(_sleep_mutex);
+				_sleeping.fetch_add(1);
+				_wake.wait(lock, [this] { return _stop || _queued.load() > 0; });
+				_sleeping.fetch_sub(1);
+				if (_stop && _queued.load() == 0) return;
+			}
+		}
+
+		size_t _threads;
+		std::vector<detail::task_queue> _queues;
+		std::vector<std::thread> _workers;
+		std::atomic<size_t> _queued{0};
+		std::atomic<size_t> _sleeping{0};
+		std::mutex _sleep_mutex;
+		std::condition_variable _wake;
+		bool _stop = false;
+	};
+
+	namespace detail {
+		inline thread_pool& pool_of(const options& opt) {
+			return opt.pool ? *opt.pool : thread_pool::shared();
+		}
+
+		inline size_t chunk_size(size_t n, size_t grain) noexcept {
+			if (grain) return grain;
+			return std::max(MIN_GRAIN, (n + MAX_CHUNKS - 1) / MAX_CHUNKS);
+		}
+
+		// Calls f(begin, end) for every chunk of [0, n).
+		template<typename F>
+		void for_chunks(size_t n, const options& opt, const F& f) {
+			const size_t chunk = chunk_size(n, opt.grain);
+			if (n <= chunk) {
+				if (n) f(size_t(0), n);
+				return;
+			}
+			pool_of(opt).run((n + chunk - 1) / chunk, [&](size_t c) {
+				const size_t begin = c * chunk;
+				f(begin, std::min(n, begin + chunk));
+			});
+		}
+
+		// Elements taken from a for the first d outputs of a stable merge of a and b.
+		template<typename A, typename B, typename Compare>
+		size_t co_rank(size_t d, A a, size_t na, B b, size_t nb, Compare& comp) {
+			size_t lo = d > nb ? d - nb : 0;
+			size_t hi = std::min(d, na);
+			while (lo < hi) {
+				const size_t i = lo + (hi - lo) / 2;
+				if (comp(b[d - i - 1], a[i])) hi = i;
+				else lo = i + 1;
+			}
+			return lo;
+		}
+
+		// Merges neighbouring sorted runs of width elements from src into dst. Every
+		// merge is split at its output positions, so one pass of a long merge is as
+		// parallel as many short ones. All split points are found before anything
+		// is moved, since the searches read across part boundaries.
+		template<typename In, typename Out, typename Compare>
+		void merge_runs(In src, Out dst, size_t n, size_t width, size_t piece, thread_pool& pool, Compare& comp) {
+			struct part { size_t start, mid, end, begin, split; };
+			std::vector<part> parts;
+			for (size_t start = 0; start < n; start += 2 * width) {
+				const size_t mid = std::min(start + width, n);
+				const size_t end = std::min(start + 2 * width, n);
+				for (size_t begin = start; begin < end; begin += piece) parts.push_back(part{start, mid, end, begin, 0});
+			}
+			pool.run(parts.size(), [&](size_t k) {
+				part& p = parts[k];
+				p.split = co_rank(p.begin - p.start, src + p.start, p.mid - p.start, src + p.mid, p.end - p.mid, comp);
+			});
+			pool.run(parts.size(), [&](size_t k) {
+				const part& p = parts[k];
+				const bool last = k + 1 == parts.size() || parts[k + 1].start != p.start;
+				const size_t i0 = p.split, i1 = last ? p.mid - p.start : parts[k + 1].split;
+				const size_t j0 = p.begin - p.start - i0, j1 = (last ? p.end : parts[k + 1].begin) - p.start - i1;
+				std::merge(std::make_move_iterator(src + p.start + i0), std::make_move_iterator(src + p.start + i1),
+					std::make_move_iterator(src + p.mid + j0), std::make_move_iterator(src + p.mid + j1),
+					dst + p.begin, comp);
+			});
+		}
+	}
+
+	template<typename It, typename F, typename = typename std::iterator_traits<It>::iterator_category>
+	void for_each(It first, It last, F f, const options& opt = options()) {
+		detail::for_chunks(static_cast<size_t>(last - first), opt, [&](size_t begin, size_t end) {
+			std::for_each(first + begin, first + end, f);
+		});
+	}
+
+	template<typename It, typename Out, typename F, typename = typename std::iterator_traits<It>::iterator_category>
+	Out transform(It first, It last, Out out, F f, const options& opt = options()) {
+		const size_t n = static_cast<size_t>(last - first);
+		detail::for_chunks(n, opt, [&](size_t begin, size_t end) {
+			std::transform(first + begin, first + end, out + begin, f);
+		});
+		return out + n;
+	}
+
+	// op must be associative; the result is init op c0 op c1 ..., where ck is
+	// chunk k folded left to right.
+	template<typename It, typename T, typename Op = std::plus<>, typename = typename std::iterator_traits<It>::iterator_category>
+	T reduce(It first, It last, T init, Op op = Op(), const options& opt = options()) {
+		const size_t n = static_cast<size_t>(last - first);
+		if (n == 0) return init;
+		const size_t chunk = detail::chunk_size(n, opt.grain);
+		const size_t chunks = (n + chunk - 1) / chunk;
+		std::unique_ptr<std::optional<T>[]> partial(new std::optional<T>[chunks]);
+		detail::for_chunks(n, opt, [&](size_t begin, size_t end) {
+			It it = first + begin;
+			T acc = *it;
+			for (++it; it != first + end; ++it) acc = op(std::move(acc), *it);
+			partial[begin / chunk].emplace(std::move(acc));
+		});
+		for (size_t c = 0; c < chunks; ++c) init = op(std::move(init), std::move(*partial[c]));
+		return init;
+	}
+
+	// The first element matching pred, as std::find_if; chunks past a match
+	// already found are skipped.
+	template<typename It, typename Pred, typename = typename std::iterator_traits<It>::iterator_category>
+	It find_if(It first, It last, Pred pred, const options& opt = options()) {
+		const size_t n = static_cast<size_t>(last - first);
+		std::atomic<size_t> found{n};
+		detail::for_chunks(n, opt, [&](size_t begin, size_t end) {
+			constexpr size_t STRIDE = 1024;
+			for (size_t i = begin; i < end;) {
+				if (found.load(std::memory_order_relaxed) < i) return;
+				for (const size_t stop = std::min(end, i + STRIDE); i < stop; ++i) {
+					if (!pred(first[i])) continue;
+					size_t best = found.load(std::memory_order_relaxed);
+					while (i < best && !found.compare_exchange_weak(best, i, std::memory_order_relaxed)) {}
+					return;
+				}
+			}
+		});
+		return first + found.load(std::memory_order_relaxed);
+	}
+
+	// Not stable. Chunks are sorted in parallel and then merged pairwise,
+	// alternating between the range and a buffer of n elements.
+	template<typename It, typename Compare = std::less<>, typename = typename std::iterator_traits<It>::iterator_category>
+	void sort(It first, It last, Compare comp = Compare(), const options& opt = options()) {
+		using T = typename std::iterator_traits<It>::value_type;
+		const size_t n = static_cast<size_t>(last - first);
+		const size_t chunk = detail::chunk_size(n, opt.grain);
+		thread_pool* pool = n > chunk ? &detail::pool_of(opt) : nullptr;
+		if (!pool || pool->concurrency() == 1) {
+			std::sort(first, last, comp);
+			return;
+		}
+
+		pool->run((n + chunk - 1) / chunk, [&](size_t c) {
+			std::sort(first + c * chunk, first + std::min(n, (c + 1) * chunk), comp);
+		});
+		// The sorted runs move into the buffer, leaving [first, last) as the
+		// target of the first merge pass.
+		std::vector<T> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+		bool in_buffer = true;
+		for (size_t width = chunk; width < n; width *= 2) {
+			if (in_buffer) detail::merge_runs(buffer.data(), first, n, width, chunk, *pool, comp);
+			else detail::merge_runs(first, buffer.data(), n, width, chunk, *pool, comp);
+			in_buffer = !in_buffer;
+		}
+		if (in_buffer) {
+			detail::for_chunks(n, opt, [&](size_t begin, size_t end) {
+				std::move(buffer.data() + begin, buffer.data() + end, first + begin);
+			});
+		}
+	}
+
+	template<typename T, size_t N, typename A, typename G, typename F>
+	void for_each(Vector<T, N, A, G>& v, F f, const options& opt = options()) {
+		for_each(v.begin(), v.end(), std::move(f), opt);
+	}
+
+	// Resizes out to in.size(); in and out may be the same Vector.
+	template<typename T, size_t N, typename A, typename G, typename U, size_t M, typename B, typename H, typename F>
+	void transform(const Vector<T, N, A, G>& in, Vector<U, M, B, H>& out, F f, const options& opt = options()) {
+		out.resize(in.size());
+		transform(in.begin(), in.end(), out.begin(), std::move(f), opt);
+	}
+
+	template<typename T, size_t N, typename A, typename G, typename R, typename Op = std::plus<>>
+	R reduce(const Vector<T, N, A, G>& v, R init, Op op = Op(), const options& opt = options()) {
+		return reduce(v.begin(), v.end(), std::move(init), std::move(op), opt);
+	}
+
+	template<typename T, size_t N, typename A, typename G, typename Pred>
+	T* find_if(Vector<T, N, A, G>& v, Pred pred, const options& opt = options()) {
+		return find_if(v.begin(), v.end(), std::move(pred), opt);
+	}
+
+	template<typename T, size_t N, typename A, typename G, typename Pred>
+	const T* find_if(const Vector<T, N, A, G>& v, Pred pred, const options& opt = options()) {
+		return find_if(v.begin(), v.end(), std::move(pred), opt);
+	}
+
+	template<typename T, size_t N, typename A, typename G, typename Compare = std::less<>>
+	void sort(Vector<T, N, A, G>& v, Compare comp = Compare(), const options& opt = options()) {
+		sort(v.begin(), v.end(), std::move(comp), opt);
+	}
+}
+}
@@ -0,0 +1,317 @@
+/**
+ * @file cnt/securealloc.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio),
+ * and according to the project license (MIT license) agreement,
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team.
+ * At the same time,
+ * project and documents can be used for commercial purposes under the condition of informing the development source,
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time,
+ * and any form of dispute event, CNT Development Team.
+ * and APlcexicesetrl shall not be liable for any damages,
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+/* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+#ifndef CNT_SECUREALLOC_H
+#define CNT_SECUREALLOC_H
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__) || defined(__unix__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace cnt {
+
+// Overwrite memory in a way the optimizer may not elide.
+inline void secure_zero(void* p, size_t n) noexcept {
+#if defined(_WIN32)
+    SecureZeroMemory(p, n);
+#else
+    std::memset(p, 0, n);
+    __asm__ __volatile__("" : : "r"(p) : "memory");
+#endif
+}
+
+/*
+ * Process-wide pool for key material.
+ *
+ * Requests up to MAX_BLOCK bytes are served from power-of-two size classes
+ * carved out of slabs; freed blocks are zeroized and pushed back on the class
+ * free list, so steady-state allocate/deallocate traffic never reaches malloc
+ * or the kernel.  Larger requests get a region of their own, rounded up to a
+ * power-of-two number of pages; freed regions are zeroized and kept for reuse
+ * (up to MAX_CACHED_BYTES in total), so repeatedly sealing large buffers does
+ * not map and lock memory on every call.  Each slab and each region is mapped
+ * separately, locked into RAM so it cannot be swapped out, and fenced by
+ * inaccessible guard pages on both sides.
+ *
+ * mlock() is best effort: when RLIMIT_MEMLOCK is exhausted the memory is
+ * still used and stats().locked_failures records it.
+ */
+class secure_pool {
+public:
+    static constexpr size_t MIN_BLOCK = 32;
+    static constexpr size_t MAX_BLOCK = 4096;
+    static constexpr size_t SLAB_SIZE = 64 * 1024;
+    static constexpr size_t MAX_CACHED_BYTES = 32 * 1024 * 1024;
+
+    struct stats {
+        uint64_t allocations;
+        uint64_t deallocations;
+        uint64_t system_maps;       // slabs and oversized blocks mapped from the OS
+        uint64_t mapped_bytes;
+        uint64_t locked_failures;
+        uint64_t region_reuses;     // oversized blocks served from freed regions
+        uint64_t cached_bytes;      // freed regions kept for reuse
+    };
+
+    static secure_pool& instance() {
+        static secure_pool* pool = new secure_pool();  // never destroyed; may outlive static users
+        return *pool;
+    }
+
+    void* allocate(size_t n) {
+        if (n == 0) n = 1;
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        if (n > MAX_BLOCK) return take_region(region_size(n));
+
+        size_class& sc = classes_[class_index(n)];
+        std::lock_guard<std::mutex> lock(sc.mutex);
+        if (!sc.free) refill(sc, class_size(class_index(n)));
+        free_block* block = sc.free;
+        sc.free = block->next;
+        block->next = nullptr;
+        return block;
+    }
+
+    void deallocate(void* p, size_t n) noexcept {
+        if (!p) return;
+        if (n == 0) n = 1;
+        deallocations_.fetch_add(1, std::memory_order_relaxed);
+        if (n > MAX_BLOCK) {
+            secure_zero(p, n);
+            keep_region(p, region_size(n));
+            return;
+        }
+
+        size_t index = class_index(n);
+        secure_zero(p, class_size(index));
+        size_class& sc = classes_[index];
+        std::lock_guard<std::mutex> lock(sc.mutex);
+        free_block* block = static_cast<free_block*>(p);
+        block->next = sc.free;
+        sc.free = block;
+    }
+
+    stats get_stats() const {
+        return {allocations_.load(std::memory_order_relaxed),
+                deallocations_.load(std::memory_order_relaxed),
+                system_maps_.load(std::memory_order_relaxed),
+                mapped_bytes_.load(std::memory_order_relaxed),
+                locked_failures_.load(std::memory_order_relaxed),
+                region_reuses_.load(std::memory_order_relaxed),
+                cached_bytes_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    static constexpr size_t CLASS_COUNT = 8;  // 32, 64, ..., 4096
+
+    struct free_block {
+        free_block* next;
+    };
+
+    struct size_class {
+        std::mutex mutex;
+        free_block* free = nullptr;
+    };
+
+    // Header written into a freed (otherwise zeroized) region.
+    struct free_region {
+        free_region* next;
+    };
+    static constexpr size_t REGION_CLASSES = 64;   // by log2 of the region size
+
+    secure_pool() = default;
+
+    static size_t class_index(size_t n) {
+        size_t index = 0;
+        size_t size = MIN_BLOCK;
+        while (size < n) {
+            size <<= 1;
+            ++index;
+        }
+        return index;
+    }
+
+    static size_t class_size(size_t index) { return MIN_BLOCK << index; }
+
+    void refill(size_class& sc, size_t block_size) {
+        char* slab = static_cast<char*>(map_region(SLAB_SIZE));
+        for (size_t off = SLAB_SIZE; off >= block_size; off -= block_size) {
+            free_block* block = reinterpret_cast<free_block*>(slab + off - block_size);
+            block->next = sc.free;
+            sc.free = block;
+        }
+    }
+
+    static size_t page_size() {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+#elif defined(__linux__) || defined(__unix__)
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+        return 4096;
+#endif
+    }
+
+    static size_t round_up(size_t n, size_t page) { return (n + page - 1) / page * page; }
+
+    static size_t region_size(size_t n) {
+        size_t size = page_size();
+        while (size < n) size <<= 1;
+        return size;
+    }
+
+    static size_t region_class(size_t size) {
+        size_t index = 0;
+        while ((size_t(1) << index) < size) ++index;
+        return index;
+    }
+
+    void* take_region(size_t size) {
+        {
+            std::lock_guard<std::mutex> lock(region_mutex_);
+            free_region*& head = regions_[region_class(size)];
+            if (head) {
+                free_region* region = head;
+                head = region->next;
+                region->next = nullptr;
+                cached_bytes_.fetch_sub(size, std::memory_order_relaxed);
+                region_reuses_.fetch_add(1, std::memory_order_relaxed);
+                return region;
+            }
+        }
+        return map_region(size);
+    }
+
+    // p has been zeroized.
+    void keep_region(void* p, size_t size) noexcept {
+        {
+            std::lock_guard<std::mutex> lock(region_mutex_);
+            if (cached_bytes_.load(std::memory_order_relaxed) + size <= MAX_CACHED_BYTES) {
+                free_region* region = static_cast<free_region*>(p);
+                free_region*& head = regions_[region_class(size)];
+                region->next = head;
+                head = region;
+                cached_bytes_.fetch_add(size, std::memory_order_relaxed);
+                return;
+            }
+        }
+        unmap_region(p, size);
+    }
+
+    // [guard page][usable pages][guard page]; returns the first usable byte.
+    void* map_region(size_t n) {
+        const size_t page = page_size();
+        const size_t usable = round_up(n, page);
+        const size_t total = usable + 2 * page;
+#if defined(_WIN32)
+        char* base = static_cast<char*>(VirtualAlloc(nullptr, total, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+        if (!base) throw std::bad_alloc();
+        DWORD old;
+        VirtualProtect(base, page, PAGE_NOACCESS, &old);
+        VirtualProtect(base + page + usable, page, PAGE_NOACCESS, &old);
+        if (!VirtualLock(base + page, usable)) locked_failures_.fetch_add(1, std::memory_order_relaxed);
+#elif defined(__linux__) || defined(__unix__)
+        void* p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+        char* base = static_cast<char*>(p);
+        mprotect(base, page, PROT_NONE);
+        mprotect(base + page + usable, page, PROT_NONE);
+        if (mlock(base + page, usable) != 0) locked_failures_.fetch_add(1, std::memory_order_relaxed);
+#if defined(MADV_DONTDUMP)
+        madvise(base + page, usable, MADV_DONTDUMP);
+#endif
+#else
+        char* base = static_cast<char*>(::operator new(total));
+#endif
+        system_maps_.fetch_add(1, std::memory_order_relaxed);
+        mapped_bytes_.fetch_add(total, std::memory_order_relaxed);
+        return base + page;
+    }
+
+    void unmap_region(void* p, size_t n) noexcept {
+        const size_t page = page_size();
+        const size_t usable = round_up(n, page);
+        const size_t total = usable + 2 * page;
+        char* base = static_cast<char*>(p) - page;
+#if defined(_WIN32)
+        VirtualUnlock(p, usable);
+        VirtualFree(base, 0, MEM_RELEASE);
+#elif defined(__linux__) || defined(__unix__)
+        munlock(p, usable);
+        munmap(base, total);
+#else
+        ::operator delete(base);
+#endif
+        mapped_bytes_.fetch_sub(total, std::memory_order_relaxed);
+    }
+
+    size_class classes_[CLASS_COUNT];
+    std::mutex region_mutex_;
+    free_region* regions_[REGION_CLASSES] = {};
+    std::atomic<uint64_t> allocations_{0};
+    std::atomic<uint64_t> deallocations_{0};
+    std::atomic<uint64_t> system_maps_{0};
+    std::atomic<uint64_t> mapped_bytes_{0};
+    std::atomic<uint64_t> locked_failures_{0};
+    std::atomic<uint64_t> region_reuses_{0};
+    std::atomic<uint64_t> cached_bytes_{0};
+};
+
+// Standard allocator over secure_pool.
+template <typename T>
+struct secure_allocator {
+    using value_type = T;
+
+    secure_allocator() noexcept = default;
+    template <typename U>
+    secure_allocator(const secure_allocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) throw std::bad_alloc();
+        return static_cast<T*>(secure_pool::instance().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        secure_pool::instance().deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const secure_allocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const secure_allocator<U>&) const noexcept { return false; }
+};
+
+using secure_bytes = std::vector<uint8_t, secure_allocator<uint8_t>>;
+
+} // namespace cnt
+
+#endif // CNT_SECUREALLOC_H
@@ -0,0 +1,168 @@
+/**
+ * @file cnt/sha256.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio), 
+ * and according to the project license (MIT license) agreement, 
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team. 
+ * At the same time, 
+ * project and documents can be used for commercial purposes under the condition of informing the development source, 
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time, 
+ * and any form of dispute event, CNT Development Team. 
+ * and APlcexicesetrl shall not be liable for any damages, 
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+ /* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * SHA-256 and HMAC-SHA-256 (FIPS 180-4, RFC 2104), the keyed primitives of the
+ * key vault.  Portable code: the vault hashes a few dozen bytes per key, so
+ * there is nothing for the SHA extensions to win.
+ *
+ * A hasher or hmac is a value; copying one after a common prefix has been
+ * absorbed lets several messages share that work, which is how the vault
+ * keeps one keyed HMAC and derives every keystream block from a copy.
+ */
+
+namespace cnt {
+namespace sha256 {
+	constexpr size_t DIGEST_SIZE = 32;
+	constexpr size_t BLOCK_SIZE = 64;
+	using digest = std::array<uint8_t, DIGEST_SIZE>;
+
+	namespace detail {
+		constexpr uint32_t K[64] = {
+			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+			0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+			0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+			0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+			0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+			0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+			0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+		};
+
+		inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+		inline uint32_t load_be(const uint8_t* p) {
+			return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+		}
+
+		inline void store_be(uint8_t* p, uint32_t v) {
+			p[0] = uint8_t(v >> 24);
+			p[1] = uint8_t(v >> 16);
+			p[2] = uint8_t(v >> 8);
+			p[3] = uint8_t(v);
+		}
+
+		inline void compress(uint32_t state[8], const uint8_t* block) {
+			uint32_t w[64];
+			for (int i = 0; i < 16; ++i) w[i] = load_be(block + 4 * i);
+			for (int i = 16; i < 64; ++i) {
+				uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+				uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+				w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+			}
+			uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+			uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+			for (int i = 0; i < 64; ++i) {
+				uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+				uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+				h = g; g = f; f = e; e = d + t1;
+				d = c; c = b; b = a; a = t1 + t2;
+			}
+			state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+			state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+		}
+	}
+
+	class hasher {
+	public:
+		hasher& update(const void* data, size_t size) {
+			const uint8_t* p = static_cast<const uint8_t*>(data);
+			length_ += size;
+			if (fill_) {
+				size_t n = size < BLOCK_SIZE - fill_ ? size : BLOCK_SIZE - fill_;
+				std::memcpy(buffer_ + fill_, p, n);
+				fill_ += n;
+				p += n;
+				size -= n;
+				if (fill_ < BLOCK_SIZE) return *this;
+				detail::compress(state_, buffer_);
+				fill_ = 0;
+			}
+			for (; size >= BLOCK_SIZE; p += BLOCK_SIZE, size -= BLOCK_SIZE) detail::compress(state_, p);
+			if (size) std::memcpy(buffer_, p, size);
+			fill_ = size;
+			return *this;
+		}
+
+		digest finish() {
+			uint64_t bits = length_ * 8;
+			uint8_t pad[BLOCK_SIZE + 8] = {0x80};
+			size_t pad_size = (fill_ < 56 ? 56 : 120) - fill_;
+			for (int i = 0; i < 8; ++i) pad[pad_size + i] = uint8_t(bits >> (56 - 8 * i));
+			update(pad, pad_size + 8);
+			digest out;
+			for (int i = 0; i < 8; ++i) detail::store_be(out.data() + 4 * i, state_[i]);
+			return out;
+		}
+
+	private:
+		uint32_t state_[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+		                      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+		uint8_t buffer_[BLOCK_SIZE];
+		size_t fill_ = 0;
+		uint64_t length_ = 0;
+	};
+
+	inline digest hash(const void* data, size_t size) { return hasher().update(data, size).finish(); }
+
+	class hmac {
+	public:
+		hmac(const void* key, size_t size) {
+			uint8_t pad[BLOCK_SIZE] = {};
+			if (size > BLOCK_SIZE) {
+				digest d = hash(key, size);
+				std::memcpy(pad, d.data(), d.size());
+			} else if (size) {
+				std::memcpy(pad, key, size);
+			}
+			for (auto& b : pad) b ^= 0x36;
+			inner_.update(pad, BLOCK_SIZE);
+			for (auto& b : pad) b ^= 0x36 ^ 0x5c;
+			outer_.update(pad, BLOCK_SIZE);
+		}
+
+		hmac& update(const void* data, size_t size) {
+			inner_.update(data, size);
+			return *this;
+		}
+
+		digest finish() {
+			digest d = inner_.finish();
+			return outer_.update(d.data(), d.size()).finish();
+		}
+
+	private:
+		hasher inner_;
+		hasher outer_;
+	};
+
+	// Compare two digests in time independent of where they differ.
+	inline bool equal(const uint8_t* a, const uint8_t* b, size_t size = DIGEST_SIZE) {
+		uint8_t diff = 0;
+		for (size_t i = 0; i < size; ++i) diff |= a[i] ^ b[i];
+		return diff == 0;
+	}
+}
+}
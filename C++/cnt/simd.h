@@ -0,0 +1,418 @@
+/**
+ * @file cnt/simd.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio),
+ * and according to the project license (MIT license) agreement,
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team.
+ * At the same time,
+ * project and documents can be used for commercial purposes under the condition of informing the development source,
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time,
+ * and any form of dispute event, CNT Development Team.
+ * and APlcexicesetrl shall not be liable for any damages,
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+ /* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*
+ * Bulk kernels over raw arrays of arithmetic values.
+ *
+ * Every kernel is compiled three times: a portable scalar loop, an AVX2 build
+ * and an AVX-512 (F/BW/DQ/VL) build. The first call picks the widest level the
+ * CPU supports; set_level() can force a lower one, e.g. for benchmarking.
+ * The vector builds use GCC/Clang vector extensions so one templated body
+ * serves every element type; other compilers get the scalar loops only.
+ *
+ * Floating-point sum() and dot() use several independent accumulators, so
+ * their rounding differs from a strict left-to-right loop.
+ */
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CNT_SIMD_X86 1
+#define CNT_SIMD_INLINE inline __attribute__((always_inline))
+#define CNT_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#define CNT_SIMD_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl")))
+#else
+#define CNT_SIMD_X86 0
+#endif
+
+namespace cnt {
+namespace simd {
+	enum class level { scalar = 0, avx2 = 1, avx512 = 2 };
+
+	// Element types with vector builds; other arithmetic types use the scalar loops.
+	template<typename T>
+	struct is_vectorizable : std::integral_constant<bool,
+		(std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+		std::is_same<T, float>::value || std::is_same<T, double>::value> {};
+
+	namespace detail {
+		inline level detect() {
+#if CNT_SIMD_X86
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+				__builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")) {
+				return level::avx512;
+			}
+			if (__builtin_cpu_supports("avx2")) return level::avx2;
+#endif
+			return level::scalar;
+		}
+
+		inline std::atomic<int>& current() {
+			static std::atomic<int> value{ static_cast<int>(detect()) };
+			return value;
+		}
+	}
+
+	inline level detected_level() {
+		static const level value = detail::detect();
+		return value;
+	}
+
+	inline level active_level() {
+		return static_cast<level>(detail::current().load(std::memory_order_relaxed));
+	}
+
+	// Force a kernel level; requests above what the CPU supports are clamped.
+	inline void set_level(level l) {
+		if (static_cast<int>(l) > static_cast<int>(detected_level())) l = detected_level();
+		detail::current().store(static_cast<int>(l), std::memory_order_relaxed);
+	}
+
+	inline const char* level_name(level l) {
+		switch (l) {
+		case level::avx512: return "avx512";
+		case level::avx2: return "avx2";
+		default: return "scalar";
+		}
+	}
+
+	namespace detail {
+		// ---- scalar kernels ----
+
+		template<typename T>
+		void scalar_fill(T* dst, size_t n, T value) {
+			for (size_t i = 0; i < n; ++i) dst[i] = value;
+		}
+
+		template<typename T>
+		void scalar_copy(T* dst, const T* src, size_t n) {
+			if (n) std::memcpy(dst, src, n * sizeof(T));
+		}
+
+		template<typename T>
+		T scalar_sum(const T* src, size_t n) {
+			T acc = T();
+			for (size_t i = 0; i < n; ++i) acc += src[i];
+			return acc;
+		}
+
+		template<typename T>
+		T scalar_min(const T* src, size_t n) {
+			T acc = src[0];
+			for (size_t i = 1; i < n; ++i) acc = src[i] < acc ? src[i] : acc;
+			return acc;
+		}
+
+		template<typename T>
+		T scalar_max(const T* src, size_t n) {
+			T acc = src[0];
+			for (size_t i = 1; i < n; ++i) acc = src[i] > acc ? src[i] : acc;
+			return acc;
+		}
+
+		template<typename T>
+		T scalar_dot(const T* a, const T* b, size_t n) {
+			T acc = T();
+			for (size_t i = 0; i < n; ++i) acc += a[i] * b[i];
+			return acc;
+		}
+
+		template<typename T>
+		void scalar_add(T* dst, const T* a, const T* b, size_t n) {
+			for (size_t i = 0; i < n; ++i) dst[i] = a[i] + b[i];
+		}
+
+		template<typename T>
+		void scalar_mul(T* dst, const T* a, const T* b, size_t n) {
+			for (size_t i = 0; i < n; ++i) dst[i] = a[i] * b[i];
+		}
+
+		template<typename T>
+		size_t scalar_find(const T* src, size_t n, T value) {
+			for (size_t i = 0; i < n; ++i) {
+				if (src[i] == value) return i;
+			}
+			return n;
+		}
+
+		template<typename T>
+		size_t scalar_count(const T* src, size_t n, T value) {
+			size_t count = 0;
+			for (size_t i = 0; i < n; ++i) count += src[i] == value;
+			return count;
+		}
+
+#if CNT_SIMD_X86
+		// ---- vector kernels, instantiated with W = 32 (AVX2) or W = 64 (AVX-512) ----
+
+		template<typename T, size_t W>
+		struct vec { typedef T type __attribute__((vector_size(W))); };
+
+		template<typename V, typename T>
+		CNT_SIMD_INLINE void load(V& v, const T* p) { std::memcpy(&v, p, sizeof(V)); }
+
+		template<typename V, typename T>
+		CNT_SIMD_INLINE void store(T* p, const V& v) { std::memcpy(p, &v, sizeof(V)); }
+
+		template<typename T, size_t W>
+		CNT_SIMD_INLINE void vec_fill(T* dst, size_t n, T value) {
+			using V = typename vec<T, W>::type;
+			constexpr size_t L = W / sizeof(T);
+			V s = V{} + value;
+			size_t i = 0;
+			for (; i + L <= n; i += L) store(dst + i, s);
+			for (; i < n; ++i) dst[i] = value;
+		}
+
+		template<typename T, size_t W>
+		CNT_SIMD_INLINE void vec_copy(T* dst, const T* src, size_t n) {
+			using V = typename vec<T, W>::type;
+			constexpr size_t L = W / sizeof(T);
+			size_t i = 0;
+			for (; i + 4 * L <= n; i += 4 * L) {
+				V a, b, c, d;
+				load(a, src + i); load(b, src + i + L); load(c, src + i + 2 * L); load(d, src + i + 3 * L);
+				store(dst + i, a); store(dst + i + L, b); store(dst + i + 2 * L, c); store(dst + i + 3 * L, d);
+			}
+			for (; i + L <= n; i += L) {
+				V a;
+				load(a, src + i);
+				store(dst + i, a);
+			}
+			for (; i < n; ++i) dst[i] = src[i];
+		}
+
+		template<typename T, size_t W>
+		CNT_SIMD_INLINE T vec_sum(const T* src, size_t n) {
+			using V = typename vec<T, W>::type;
+			constexpr size_t L = W / sizeof(T);
+			V a0{}, a1{}, a2{}, a3{};
+			size_t i = 0;
+			for (; i + 4 * L <= n; i += 4 * L) {
+				V x0, x1, x2, x3;
+				load(x0, src + i); load(x1, src + i + L); load(x2, src + i + 2 * L); load(x3, src + i + 3 * L);
+				a0 += x0; a1 += x1; a2 += x2; a3 += x3;
+			}
+			for (; i + L <= n; i += L) {
+				V x;
+				load(x, src + i);
+				a0 += x;
+			}
+			a0 += a1 + a2 + a3;
+			T acc = T();
+			for (size_t l = 0; l < L; ++l) acc += a0[l];
+			for (; i < n; ++i) acc += src[i];
+			return acc;
+		}
+
+		template<typename T, size_t W, bool MIN>
+		CNT_SIMD_INLINE T vec_minmax(const T* src, size_t n) {
+			using V = typename vec<T, W>::type;
+			constexpr size_t L = W / sizeof(T);
+			if (n < L) return MIN ? scalar_min(src, n) : scalar_max(src, n);
+			V acc;
+			load(acc, src);
+			size_t i = L;
+			for (; i + L <= n; i += L) {
+				V x;
+				load(x, src + i);
+				acc = MIN ? (x < acc ? x : acc) : (x > acc ? x : acc);
+			}
+			T r = acc[0];
+			for (size_t l = 1; l < L; ++l) r = MIN ? (acc[l] < r ? acc[l] : r) : (acc[l] > r ? acc[l] : r);
+			for (; i < n; ++i) r = MIN ? (src[i] < r ? src[i] : r) : (src[i] > r ? src[i] : r);
+			return r;
+		}
+
+		template<typename T, size_t W>
+		CNT_SIMD_INLINE T vec_min(const T* src, size_t n) { return vec_minmax<T, W, true>(src, n); }
+
+		template<typename T, size_t W>
+		CNT_SIMD_INLINE T vec_max(const T* src, size_t n) { return vec_minmax<T, W, false>(src, n); }
+
+		template<typename T, size_t W>
+		CNT_SIMD_INLINE T vec_dot(const T* a, const T* b, size_t n) {
+			using V = typename vec<T, W>::type;
+			constexpr size_t L = W / sizeof(T);
+			V a0{}, a1{};
+			size_t i = 0;
+			for (; i + 2 * L <= n; i += 2 * L) {
+				V x0, x1, y0, y1;
+				load(x0, a + i); load(x1, a + i + L);
+				load(y0, b + i); load(y1, b + i + L);
+				a0 += x0 * y0;
+				a1 += x1 * y1;
+			}
+			for (; i + L <= n; i += L) {
+				V x, y;
+				load(x, a + i);
+				load(y, b + i);
+				a0 += x * y;
+			}
+			a0 += a1;
+			T acc = T();
+			for (size_t l = 0; l < L; ++l) acc += a0[l];
+			for (; i < n; ++i) acc += a[i] * b[i];
+			return acc;
+		}
+
+		template<typename T, size_t W>
+		CNT_SIMD_INLINE void vec_add(T* dst, const T* a, const T* b, size_t n) {
+			using V = typename vec<T, W>::type;
+			constexpr size_t L = W / sizeof(T);
+			size_t i = 0;
+			for (; i + L <= n; i += L) {
+				V x, y;
+				load(x, a + i);
+				load(y, b + i);
+				store(dst + i, V(x + y));
+			}
+			for (; i < n; ++i) dst[i] = a[i] + b[i];
+		}
+
+		template<typename T, size_t W>
+		CNT_SIMD_INLINE void vec_mul(T* dst, const T* a, const T* b, size_t n) {
+			using V = typename vec<T, W>::type;
+			constexpr size_t L = W / sizeof(T);
+			size_t i = 0;
+			for (; i + L <= n; i += L) {
+				V x, y;
+				load(x, a + i);
+				load(y, b + i);
+				store(dst + i, V(x * y));
+			}
+			for (; i < n; ++i) dst[i] = a[i] * b[i];
+		}
+
+		template<typename T, size_t W>
+		CNT_SIMD_INLINE size_t vec_find(const T* src, size_t n, T value) {
+			using V = typename vec<T, W>::type;
+			using U = typename vec<uint64_t, W>::type;
+			constexpr size_t L = W / sizeof(T);
+			V s = V{} + value;
+			size_t i = 0;
+			for (; i + L <= n; i += L) {
+				V x;
+				load(x, src + i);
+				U hit = reinterpret_cast<U>(x == s);
+				uint64_t any = 0;
+				for (size_t l = 0; l < W / 8; ++l) any |= hit[l];
+				if (any) return i + scalar_find(src + i, L, value);
+			}
+			return i + scalar_find(src + i, n - i, value);
+		}
+
+		template<typename T, size_t W>
+		CNT_SIMD_INLINE size_t vec_count(const T* src, size_t n, T value) {
+			using V = typename vec<T, W>::type;
+			using M = decltype(V{} == V{});
+			constexpr size_t L = W / sizeof(T);
+			V s = V{} + value;
+			size_t total = 0;
+			size_t i = 0;
+			while (i + L <= n) {
+				// Lanes count up by one per match; flush before 8-bit lanes can wrap.
+				M acc{};
+				for (size_t k = 0; k < 127 && i + L <= n; ++k, i += L) {
+					V x;
+					load(x, src + i);
+					acc -= (x == s);
+				}
+				for (size_t l = 0; l < L; ++l) total += static_cast<size_t>(acc[l]);
+			}
+			return total + scalar_count(src + i, n - i, value);
+		}
+
+#define CNT_SIMD_KERNEL(name, ret, params, args) \
+		template<typename T> CNT_SIMD_TARGET_AVX2 ret name##_avx2 params { return vec_##name<T, 32> args; } \
+		template<typename T> CNT_SIMD_TARGET_AVX512 ret name##_avx512 params { return vec_##name<T, 64> args; }
+
+		CNT_SIMD_KERNEL(fill, void, (T* dst, size_t n, T value), (dst, n, value))
+		CNT_SIMD_KERNEL(copy, void, (T* dst, const T* src, size_t n), (dst, src, n))
+		CNT_SIMD_KERNEL(sum, T, (const T* src, size_t n), (src, n))
+		CNT_SIMD_KERNEL(min, T, (const T* src, size_t n), (src, n))
+		CNT_SIMD_KERNEL(max, T, (const T* src, size_t n), (src, n))
+		CNT_SIMD_KERNEL(dot, T, (const T* a, const T* b, size_t n), (a, b, n))
+		CNT_SIMD_KERNEL(add, void, (T* dst, const T* a, const T* b, size_t n), (dst, a, b, n))
+		CNT_SIMD_KERNEL(mul, void, (T* dst, const T* a, const T* b, size_t n), (dst, a, b, n))
+		CNT_SIMD_KERNEL(find, size_t, (const T* src, size_t n, T value), (src, n, value))
+		CNT_SIMD_KERNEL(count, size_t, (const T* src, size_t n, T value), (src, n, value))
+
+#undef CNT_SIMD_KERNEL
+#endif
+	}
+
+#if CNT_SIMD_X86
+#define CNT_SIMD_DISPATCH(name, args) \
+	if constexpr (is_vectorizable<T>::value) { \
+		switch (active_level()) { \
+		case level::avx512: return detail::name##_avx512<T> args; \
+		case level::avx2: return detail::name##_avx2<T> args; \
+		default: break; \
+		} \
+	} \
+	return detail::scalar_##name<T> args
+#else
+#define CNT_SIMD_DISPATCH(name, args) return detail::scalar_##name<T> args
+#endif
+
+	template<typename T>
+	void fill(T* dst, size_t n, T value) { CNT_SIMD_DISPATCH(fill, (dst, n, value)); }
+
+	template<typename T>
+	void copy(T* dst, const T* src, size_t n) { CNT_SIMD_DISPATCH(copy, (dst, src, n)); }
+
+	template<typename T>
+	T sum(const T* src, size_t n) { CNT_SIMD_DISPATCH(sum, (src, n)); }
+
+	// n must be non-zero.
+	template<typename T>
+	T min(const T* src, size_t n) { CNT_SIMD_DISPATCH(min, (src, n)); }
+
+	// n must be non-zero.
+	template<typename T>
+	T max(const T* src, size_t n) { CNT_SIMD_DISPATCH(max, (src, n)); }
+
+	template<typename T>
+	T dot(const T* a, const T* b, size_t n) { CNT_SIMD_DISPATCH(dot, (a, b, n)); }
+
+	// dst may alias a or b.
+	template<typename T>
+	void add(T* dst, const T* a, const T* b, size_t n) { CNT_SIMD_DISPATCH(add, (dst, a, b, n)); }
+
+	// dst may alias a or b.
+	template<typename T>
+	void mul(T* dst, const T* a, const T* b, size_t n) { CNT_SIMD_DISPATCH(mul, (dst, a, b, n)); }
+
+	// Index of the first element equal to value, or n.
+	template<typename T>
+	size_t find(const T* src, size_t n, T value) { CNT_SIMD_DISPATCH(find, (src, n, value)); }
+
+	template<typename T>
+	size_t count(const T* src, size_t n, T value) { CNT_SIMD_DISPATCH(count, (src, n, value)); }
+
+#undef CNT_SIMD_DISPATCH
+}
+}
@@ -0,0 +1,331 @@
+/**
+ * @file cnt/terminal.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio),
+ * and according to the project license (MIT license) agreement,
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team.
+ * At the same time,
+ * project and documents can be used for commercial purposes under the condition of informing the development source,
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time,
+ * and any form of dispute event, CNT Development Team.
+ * and APlcexicesetrl shall not be liable for any damages,
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+ /* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cerrno>
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__) || defined(__unix__)
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace cnt
+{
+    /*
+     * Double-buffered ANSI/VT screen renderer.
+     *
+     * Drawing calls only update the back buffer. present() compares it with the
+     * front buffer (what the terminal currently shows), encodes cursor moves,
+     * colour changes and characters for the cells that differ, and hands the
+     * whole frame to the terminal in a single write. Unchanged frames cost no
+     * output at all.
+     *
+     * Colours are 256-colour palette indices; DEFAULT_COLOR selects the
+     * terminal's default foreground/background.
+     */
+    class TerminalRenderer
+    {
+    public:
+        static constexpr uint8_t DEFAULT_COLOR = 0xFF;
+
+        struct Cell
+        {
+            char32_t ch = U' ';
+            uint8_t fg = DEFAULT_COLOR;
+            uint8_t bg = DEFAULT_COLOR;
+
+            bool operator==(const Cell& other) const { return ch == other.ch && fg == other.fg && bg == other.bg; }
+            bool operator!=(const Cell& other) const { return !(*this == other); }
+        };
+
+        struct FrameStats
+        {
+            size_t cellsChanged = 0;
+            size_t bytesWritten = 0;
+        };
+
+        TerminalRenderer()
+        {
+#if defined(_WIN32)
+            handle_ = GetStdHandle(STD_OUTPUT_HANDLE);
+            if (handle_ != INVALID_HANDLE_VALUE) {
+                DWORD mode = 0;
+                GetConsoleMode(handle_, &mode);
+                SetConsoleMode(handle_, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+            }
+#endif
+            int w = 80, h = 24;
+            querySize(w, h);
+            resize(w, h);
+        }
+
+#if !defined(_WIN32)
+        // Render to an arbitrary descriptor (a pipe or pty) with a fixed size.
+        TerminalRenderer(int fd, int width, int height) : fd_(fd)
+        {
+            resize(width, height);
+        }
+#endif
+
+        // Terminal size in cells; returns false when it cannot be determined.
+        bool querySize(int& width, int& height) const
+        {
+#if defined(_WIN32)
+            CONSOLE_SCREEN_BUFFER_INFO info;
+            if (!GetConsoleScreenBufferInfo(handle_, &info)) return false;
+            width = info.srWindow.Right - info.srWindow.Left + 1;
+            height = info.srWindow.Bottom - info.srWindow.Top + 1;
+            return true;
+#elif defined(__linux__) || defined(__unix__)
+            struct winsize ws;
+            if (ioctl(fd_, TIOCGWINSZ, &ws) != 0 || ws.ws_col == 0) return false;
+            width = ws.ws_col;
+            height = ws.ws_row;
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // Resizing forces the next present() to repaint everything.
+        void resize(int width, int height)
+        {
+            width_ = width > 0 ? width : 1;
+            height_ = height > 0 ? height : 1;
+            back_.assign(static_cast<size_t>(width_) * height_, Cell());
+            front_.assign(back_.size(), Cell());
+            invalidate();
+        }
+
+        int width() const { return width_; }
+        int height() const { return height_; }
+
+        // Repaint every cell on the next present(), e.g. after other output.
+        void invalidate() { fullRedraw_ = true; }
+
+        void clear(uint8_t fg = DEFAULT_COLOR, uint8_t bg = DEFAULT_COLOR)
+        {
+            Cell blank{U' ', fg, bg};
+            std::fill(back_.begin(), back_.end(), blank);
+        }
+
+        void put(int x, int y, char32_t ch, uint8_t fg = DEFAULT_COLOR, uint8_t bg = DEFAULT_COLOR)
+        {
+            if (x < 0 || y < 0 || x >= width_ || y >= height_) return;
+            back_[static_cast<size_t>(y) * width_ + x] = Cell{ch, fg, bg};
+        }
+
+        const Cell& at(int x, int y) const { return back_[static_cast<size_t>(y) * width_ + x]; }
+
+        // Draw UTF-8 text starting at (x, y), clipped at the right edge.
+        // Returns the column after the last character written.
+        int print(int x, int y, std::string_view utf8, uint8_t fg = DEFAULT_COLOR, uint8_t bg = DEFAULT_COLOR)
+        {
+            size_t i = 0;
+            while (i < utf8.size() && x < width_) {
+                put(x++, y, decodeUtf8(utf8, i), fg, bg);
+            }
+            return x;
+        }
+
+        void setCursor(int x, int y)
+        {
+            cursorX_ = x;
+            cursorY_ = y;
+        }
+
+        void showCursor(bool visible) { cursorVisible_ = visible; }
+
+        // Emit the difference between the back buffer and the screen as one write.
+        FrameStats present()
+        {
+            FrameStats stats;
+            out_.clear();
+            // The cursor is hidden while cells are rewritten so it does not sweep across the screen.
+            out_ += fullRedraw_ ? "\033[?25l\033[0m\033[2J" : "\033[?25l\033[0m";
+
+            int penX = -1, penY = -1;
+            uint8_t penFg = DEFAULT_COLOR, penBg = DEFAULT_COLOR;
+            for (int y = 0; y < height_; ++y) {
+                const size_t row = static_cast<size_t>(y) * width_;
+                for (int x = 0; x < width_; ++x) {
+                    const Cell& cell = back_[row + x];
+                    Cell& shown = front_[row + x];
+                    if (!fullRedraw_ && cell == shown) continue;
+
+                    if (penY != y || penX != x) moveTo(x, y);
+                    if (cell.fg != penFg || cell.bg != penBg) {
+                        setColors(cell.fg, cell.bg);
+                        penFg = cell.fg;
+                        penBg = cell.bg;
+                    }
+                    appendUtf8(out_, cell.ch);
+                    shown = cell;
+                    penX = x + 1;
+                    penY = y;
+                    ++stats.cellsChanged;
+                }
+            }
+
+            if (penFg != DEFAULT_COLOR || penBg != DEFAULT_COLOR) out_ += "\033[0m";
+            if (cursorVisible_) {
+                moveTo(cursorX_, cursorY_);
+                out_ += "\033[?25h";
+            }
+            fullRedraw_ = false;
+
+            const bool cursorChanged = cursorX_ != lastCursorX_ || cursorY_ != lastCursorY_ ||
+                                       cursorVisible_ != lastCursorVisible_;
+            if (stats.cellsChanged == 0 && !cursorChanged) return stats;
+            lastCursorX_ = cursorX_;
+            lastCursorY_ = cursorY_;
+            lastCursorVisible_ = cursorVisible_;
+
+            stats.bytesWritten = writeAll(out_.data(), out_.size());
+            return stats;
+        }
+
+        // Write raw control sequences (titles, modes) immediately.
+        size_t writeRaw(std::string_view bytes) { return writeAll(bytes.data(), bytes.size()); }
+
+        // Append ch as UTF-8. C0 and C1 controls (U+009B is a one-character
+        // CSI on many terminals), surrogates and values past U+10FFFF become
+        // '?' so that text can never smuggle escape sequences into the output.
+        static void appendUtf8(std::string& out, char32_t ch)
+        {
+            if ((ch >= 0x80 && ch < 0xA0) || (ch >= 0xD800 && ch < 0xE000) || ch > 0x10FFFF) {
+                out += '?';
+            }
+            else if (ch < 0x80) {
+                out += static_cast<char>(ch < 0x20 || ch == 0x7F ? U'?' : ch);
+            }
+            else if (ch < 0x800) {
+                out += static_cast<char>(0xC0 | (ch >> 6));
+                out += static_cast<char>(0x80 | (ch & 0x3F));
+            }
+            else if (ch < 0x10000) {
+                out += static_cast<char>(0xE0 | (ch >> 12));
+                out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (ch & 0x3F));
+            }
+            else {
+                out += static_cast<char>(0xF0 | (ch >> 18));
+                out += static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (ch & 0x3F));
+            }
+        }
+
+    private:
+        void moveTo(int x, int y)
+        {
+            out_ += "\033[";
+            out_ += std::to_string(y + 1);
+            out_ += ';';
+            out_ += std::to_string(x + 1);
+            out_ += 'H';
+        }
+
+        void appendColor(uint8_t color, bool background)
+        {
+            if (color == DEFAULT_COLOR) {
+                out_ += background ? "49" : "39";
+            }
+            else if (color < 8) {
+                out_ += std::to_string((background ? 40 : 30) + color);
+            }
+            else if (color < 16) {
+                out_ += std::to_string((background ? 100 : 90) + color - 8);
+            }
+            else {
+                out_ += background ? "48;5;" : "38;5;";
+                out_ += std::to_string(color);
+            }
+        }
+
+        void setColors(uint8_t fg, uint8_t bg)
+        {
+            out_ += "\033[";
+            appendColor(fg, false);
+            out_ += ';';
+            appendColor(bg, true);
+            out_ += 'm';
+        }
+
+        static char32_t decodeUtf8(std::string_view s, size_t& i)
+        {
+            unsigned char c = static_cast<unsigned char>(s[i++]);
+            if (c < 0x80) return c;
+            int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+            char32_t ch = c & (0x3F >> extra);
+            for (int k = 0; k < extra && i < s.size(); ++k) {
+                ch = (ch << 6) | (static_cast<unsigned char>(s[i++]) & 0x3F);
+            }
+            return extra ? ch : U'?';
+        }
+
+        size_t writeAll(const char* data, size_t size)
+        {
+            size_t written = 0;
+#if defined(_WIN32)
+            while (written < size) {
+                DWORD n = 0;
+                if (!WriteFile(handle_, data + written, static_cast<DWORD>(size - written), &n, nullptr)) break;
+                written += n;
+            }
+#elif defined(__linux__) || defined(__unix__)
+            while (written < size) {
+                ssize_t n = ::write(fd_, data + written, size - written);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    break;
+                }
+                written += static_cast<size_t>(n);
+            }
+#endif
+            return written;
+        }
+
+#if defined(_WIN32)
+        HANDLE handle_ = INVALID_HANDLE_VALUE;
+#else
+        int fd_ = 1;
+#endif
+        int width_ = 0;
+        int height_ = 0;
+        std::vector<Cell> front_;
+        std::vector<Cell> back_;
+        std::string out_;
+        bool fullRedraw_ = true;
+        bool cursorVisible_ = true;
+        int cursorX_ = 0;
+        int cursorY_ = 0;
+        int lastCursorX_ = -1;
+        int lastCursorY_ = -1;
+        bool lastCursorVisible_ = false;
+    };
+
+} // namespace cnt
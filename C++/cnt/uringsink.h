@@ -0,0 +1,691 @@
+/**
+ * @file cnt/uringsink.h
+ * Copyright 2025, aplcexenicesetrl project
+ * This project and document files are maintained by CNT Development Team (under the APlcexenicesetrl studio), 
+ * and according to the project license (MIT license) agreement, 
+ * the project and documents can be used, modified, merged, published, branched, etc.
+ * provided that the project is developed and open-source maintained by CNT Development Team. 
+ * At the same time, 
+ * project and documents can be used for commercial purposes under the condition of informing the development source, 
+ * but it is not allowed to be closed source, but it can be partially source.
+ *
+ * The project and documents will be updated and maintained from time to time, 
+ * and any form of dispute event, CNT Development Team. 
+ * and APlcexicesetrl shall not be liable for any damages, 
+ * and any compensation shall not be borne by the APlcexenicesetrl studio.
+ */
+/* Written by Anders Norlander <taim_way@aplcexenicesetrl.com> */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define CNT_URING_AVAILABLE 1
+#endif
+#endif
+#endif
+#endif
+
+#include "loggings.h"
+
+#ifdef ERROR
+#define _CNT_URINGSINK_SAVED_ERROR_DEFINE_ ERROR
+#undef ERROR
+#endif
+
+#if !defined(_WIN32)
+
+namespace cnt
+{
+    /*
+     * File sink whose flushing never waits for the disk.
+     *
+     * write() copies the line into one of a fixed set of large buffers. Full
+     * buffers, and partial ones after flushInterval or on flush(), are handed
+     * to a writer thread that keeps several of them in flight at once: on
+     * Linux through io_uring (raw syscalls, buffers registered for
+     * WRITE_FIXED), elsewhere or when the kernel refuses io_uring through
+     * pwritev() on that thread. The sink also drops to pwritev() for good if
+     * the ring later rejects a write (no IORING_OP_WRITE before Linux 5.6
+     * when buffers could not be registered) or io_uring_enter() fails. A
+     * logging thread only waits when every buffer is queued or in flight (or
+     * drops the line, with dropWhenFull).
+     *
+     * With `direct` the file is opened O_DIRECT. Buffers are page aligned; a
+     * partial block is written padded and rewritten by the next write, and
+     * the file is truncated to its real length on close.
+     */
+    class UringFileSink : public LogSink
+    {
+    public:
+        struct Options
+        {
+            size_t bufferSize = 256 * 1024;                 // bytes per buffer, rounded up to 4 KiB
+            size_t bufferCount = 8;                         // buffers; all but the one being filled may be in flight
+            std::chrono::milliseconds flushInterval{50};    // partial buffers are written after this long
+            bool direct = false;                            // O_DIRECT
+            bool useUring = true;                           // false forces the pwritev backend
+            bool truncate = false;                          // start with an empty file instead of appending
+            bool syncOnFlush = false;                       // fdatasync() in flush()
+            bool dropWhenFull = false;                      // drop lines instead of waiting for a buffer
+        };
+
+        struct Stats
+        {
+            uint64_t queuedBytes = 0;
+            uint64_t writtenBytes = 0;
+            uint64_t droppedBytes = 0;
+            uint64_t submissions = 0;   // write requests issued (SQEs or pwritev calls)
+            uint64_t stalls = 0;        // times a logging thread found no free buffer
+            uint64_t errors = 0;
+        };
+
+        explicit UringFileSink(const std::string& path) : UringFileSink(path, Options()) {}
+
+        UringFileSink(const std::string& path, const Options& options)
+            : options_(options)
+        {
+            options_.bufferSize = std::max<size_t>(BLOCK, (options_.bufferSize + BLOCK - 1) / BLOCK * BLOCK);
+            options_.bufferCount = std::max<size_t>(2, options_.bufferCount);
+
+            int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (options_.truncate ? O_TRUNC : 0);
+#if defined(O_DIRECT)
+            if (options_.direct) {
+                // Read access for the partial last block (see below).
+                fd_ = ::open(path.c_str(), (flags & ~O_WRONLY) | O_RDWR | O_DIRECT, 0644);
+                direct_ = fd_ >= 0;
+            }
+#endif
+            if (fd_ < 0) fd_ = ::open(path.c_str(), flags, 0644);
+            if (fd_ < 0) throw std::runtime_error("Failed to open log file: " + path);
+
+            void* memory = nullptr;
+            if (posix_memalign(&memory, BLOCK, options_.bufferSize * options_.bufferCount) != 0) {
+                ::close(fd_);
+                throw std::runtime_error("Failed to allocate log buffers");
+            }
+            memory_ = static_cast<char*>(memory);
+            flights_.resize(options_.bufferCount);
+            for (size_t i = options_.bufferCount; i-- > 0;) free_.push_back(static_cast<int>(i));
+
+            struct stat st;
+            uint64_t size = fstat(fd_, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+            start_ = size;
+            offset_ = size;
+            if (direct_ && size % BLOCK) {
+                // Carry the existing partial block so it is rewritten intact.
+                offset_ = size / BLOCK * BLOCK;
+                fill_ = takeFree();
+                carried_ = static_cast<size_t>(size - offset_);
+                if (::pread(fd_, buffer(fill_), BLOCK, static_cast<off_t>(offset_)) < static_cast<ssize_t>(carried_)) {
+                    std::free(memory_);
+                    ::close(fd_);
+                    throw std::runtime_error("Failed to read log file tail: " + path);
+                }
+                used_ = carried_;
+            }
+
+#if defined(CNT_URING_AVAILABLE)
+            if (options_.useUring && ring_.init(static_cast<unsigned>(options_.bufferCount))) {
+                std::vector<struct iovec> iov(options_.bufferCount);
+                for (size_t i = 0; i < iov.size(); ++i) iov[i] = {buffer(static_cast<int>(i)), options_.bufferSize};
+                ring_.registerBuffers(iov.data(), static_cast<unsigned>(iov.size()));
+                uring_ = true;
+            }
+#endif
+            writer_ = std::thread([this] { run(); });
+        }
+
+        ~UringFileSink() override
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            writer_.join();
+            if (direct_) {
+                // Drop the padding of the last block.
+                if (ftruncate(fd_, static_cast<off_t>(start_ + logical_)) != 0) ++stats_.errors;
+            }
+            if (options_.syncOnFlush) fdatasync(fd_);
+            ::close(fd_);
+            std::free(memory_);
+        }
+
+        UringFileSink(const UringFileSink&) = delete;
+        UringFileSink& operator=(const UringFileSink&) = delete;
+
+        void write(LogLevel, const std::string& message) override
+        {
+            const char* data = message.data();
+            size_t left = message.size();
+            bool wakeWriter = false;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                // Wait for every buffer the line will spill into, so that lines
+                // from other threads cannot land in the middle of it. Lines
+                // longer than all buffers together are written piecewise.
+                for (;;) {
+                    const size_t room = fill_ >= 0 ? options_.bufferSize - used_ : 0;
+                    const size_t needed = left > room ? (left - room + options_.bufferSize - 1) / options_.bufferSize : 0;
+                    if (needed <= free_.size() || needed >= options_.bufferCount) break;
+                    ++stats_.stalls;
+                    if (options_.dropWhenFull) {
+                        stats_.droppedBytes += left;
+                        return;
+                    }
+                    wake_.notify_one();
+                    space_.wait(lock);
+                }
+                while (left) {
+                    if (fill_ < 0) {
+                        if (free_.empty()) {
+                            ++stats_.stalls;
+                            if (options_.dropWhenFull) {
+                                stats_.droppedBytes += left;
+                                break;
+                            }
+                            wake_.notify_one();
+                            space_.wait(lock, [this] { return !free_.empty() || fill_ >= 0; });
+                            continue;
+                        }
+                        fill_ = takeFree();
+                        used_ = 0;
+                        carried_ = 0;
+                    }
+                    if (used_ == carried_) fillSince_ = std::chrono::steady_clock::now();
+                    const size_t n = std::min(left, options_.bufferSize - used_);
+                    std::memcpy(buffer(fill_) + used_, data, n);
+                    used_ += n;
+                    data += n;
+                    left -= n;
+                    stats_.queuedBytes += n;
+                    if (used_ == options_.bufferSize) {
+                        sealed_.push_back({fill_, used_, carried_});
+                        fill_ = -1;
+                        wakeWriter = true;
+                    }
+                }
+            }
+            if (wakeWriter) wake_.notify_one();
+        }
+
+        // Waits until everything written so far has reached the file.
+        void flush() override
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                const uint64_t target = stats_.queuedBytes;
+                flushRequested_ = true;
+                wake_.notify_one();
+                drained_.wait(lock, [&] { return stats_.writtenBytes + lostBytes_ >= target; });
+            }
+            if (options_.syncOnFlush) fdatasync(fd_);
+        }
+
+        Stats getStats() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return stats_;
+        }
+
+        // "io_uring" or "pwritev"
+        const char* backend() const { return uring_ ? "io_uring" : "pwritev"; }
+        bool isDirect() const { return direct_; }
+
+    private:
+        static constexpr size_t BLOCK = 4096;
+
+        struct Sealed
+        {
+            int index;
+            size_t used;        // bytes in the buffer
+            size_t carried;     // of those, bytes already counted by an earlier write (O_DIRECT tail)
+        };
+
+        struct Flight
+        {
+            uint64_t offset = 0;
+            size_t length = 0;  // bytes to write, including O_DIRECT padding
+            size_t done = 0;
+            size_t fresh = 0;   // logical bytes this write adds
+        };
+
+#if defined(CNT_URING_AVAILABLE)
+        // Minimal io_uring: one submission queue, one completion queue, raw syscalls.
+        class Ring
+        {
+        public:
+            Ring() = default;
+            Ring(const Ring&) = delete;
+            Ring& operator=(const Ring&) = delete;
+
+            ~Ring()
+            {
+                if (sqes_) munmap(sqes_, sqesSize_);
+                if (cqRing_ && cqRing_ != sqRing_) munmap(cqRing_, cqRingSize_);
+                if (sqRing_) munmap(sqRing_, sqRingSize_);
+                if (fd_ >= 0) ::close(fd_);
+            }
+
+            // False when the kernel lacks io_uring or forbids it.
+            bool init(unsigned entries)
+            {
+                struct io_uring_params params;
+                std::memset(&params, 0, sizeof(params));
+                fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+                if (fd_ < 0) return false;
+
+                sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+                const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (single) sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+                sqRing_ = map(sqRingSize_, IORING_OFF_SQ_RING);
+                if (!sqRing_) return fail();
+                cqRing_ = single ? sqRing_ : map(cqRingSize_, IORING_OFF_CQ_RING);
+                if (!cqRing_) return fail();
+                sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+                sqes_ = static_cast<struct io_uring_sqe*>(map(sqesSize_, IORING_OFF_SQES));
+                if (!sqes_) return fail();
+
+                char* sq = static_cast<char*>(sqRing_);
+                char* cq = static_cast<char*>(cqRing_);
+                sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+                sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+                sqEntries_ = params.sq_entries;
+                cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+                return true;
+            }
+
+            // Registered buffers turn each write into WRITE_FIXED (no per-I/O page pinning).
+            void registerBuffers(const struct iovec* iov, unsigned count)
+            {
+                fixed_ = syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, iov, count) == 0;
+            }
+
+            bool prepareWrite(int fd, const char* data, unsigned length, uint64_t offset, int bufferIndex, uint64_t userData)
+            {
+                const unsigned tail = *sqTail_;
+                if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_) return false;
+                const unsigned index = tail & sqMask_;
+                struct io_uring_sqe* sqe = &sqes_[index];
+                std::memset(sqe, 0, sizeof(*sqe));
+                sqe->opcode = fixed_ ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+                sqe->fd = fd;
+                sqe->addr = reinterpret_cast<uint64_t>(data);
+                sqe->len = length;
+                sqe->off = offset;
+                if (fixed_) sqe->buf_index = static_cast<uint16_t>(bufferIndex);
+                sqe->user_data = userData;
+                sqArray_[index] = index;
+                __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+                ++unsubmitted_;
+                return true;
+            }
+
+            // Submits what was prepared and optionally waits for waitFor completions.
+            // False when the ring cannot be used any more.
+            bool enter(unsigned waitFor)
+            {
+                for (;;) {
+                    const unsigned flags = waitFor ? IORING_ENTER_GETEVENTS : 0;
+                    long n = syscall(__NR_io_uring_enter, fd_, unsubmitted_, waitFor, flags, nullptr, 0);
+                    if (n >= 0) {
+                        unsubmitted_ -= std::min<unsigned>(unsubmitted_, static_cast<unsigned>(n));
+                        return true;
+                    }
+                    if (errno == EINTR) continue;
+                    return errno == EBUSY || errno == EAGAIN;   // completions must be reaped first
+                }
+            }
+
+            template <typename Fn>
+            void reap(Fn fn)
+            {
+                unsigned head = *cqHead_;
+                const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+                for (; head != tail; ++head) {
+                    const struct io_uring_cqe& cqe = cqes_[head & cqMask_];
+                    fn(cqe.user_data, cqe.res);
+                }
+                __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+            }
+
+            // Takes back the prepared entries the kernel has not seen yet.
+            template <typename Fn>
+            void unprepare(Fn fn)
+            {
+                unsigned tail = *sqTail_;
+                for (; unsubmitted_ > 0; --unsubmitted_) {
+                    --tail;
+                    fn(sqes_[tail & sqMask_].user_data);
+                }
+                __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+            }
+
+        private:
+            void* map(size_t size, off_t offset)
+            {
+                void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+                return p == MAP_FAILED ? nullptr : p;
+            }
+
+            bool fail()
+            {
+                ::close(fd_);
+                fd_ = -1;
+                return false;
+            }
+
+            int fd_ = -1;
+            void* sqRing_ = nullptr;
+            void* cqRing_ = nullptr;
+            size_t sqRingSize_ = 0;
+            size_t cqRingSize_ = 0;
+            struct io_uring_sqe* sqes_ = nullptr;
+            size_t sqesSize_ = 0;
+            unsigned* sqHead_ = nullptr;
+            unsigned* sqTail_ = nullptr;
+            unsigned sqMask_ = 0;
+            unsigned* sqArray_ = nullptr;
+            unsigned sqEntries_ = 0;
+            unsigned* cqHead_ = nullptr;
+            unsigned* cqTail_ = nullptr;
+            unsigned cqMask_ = 0;
+            struct io_uring_cqe* cqes_ = nullptr;
+            unsigned unsubmitted_ = 0;
+            bool fixed_ = false;
+        };
+#endif
+
+        char* buffer(int index) { return memory_ + static_cast<size_t>(index) * options_.bufferSize; }
+
+        int takeFree()
+        {
+            int index = free_.back();
+            free_.pop_back();
+            return index;
+        }
+
+        // Called with the lock held by the writer thread. Under O_DIRECT the
+        // unaligned tail moves to a fresh buffer, which needs a free one.
+        bool sealPartial()
+        {
+            if (fill_ < 0 || used_ == carried_) return true;
+            const size_t tail = direct_ ? used_ % BLOCK : 0;
+            if (tail && free_.empty()) return false;
+            sealed_.push_back({fill_, used_, carried_});
+            const int previous = fill_;
+            fill_ = -1;
+            if (tail) {
+                fill_ = takeFree();
+                std::memcpy(buffer(fill_), buffer(previous) + (used_ - tail), tail);
+                used_ = tail;
+                carried_ = tail;
+            }
+            return true;
+        }
+
+        void run()
+        {
+            std::vector<Sealed> work;
+            for (;;) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    if (inFlight_ == 0) {
+                        wake_.wait_for(lock, options_.flushInterval,
+                                       [this] { return stopping_ || flushRequested_ || !sealed_.empty(); });
+                    }
+                    const bool pending = fill_ >= 0 && used_ > carried_;
+                    const bool due = pending && (stopping_ || flushRequested_ ||
+                                                 std::chrono::steady_clock::now() - fillSince_ >= options_.flushInterval);
+                    if (!due || sealPartial()) flushRequested_ = false;
+                    work.assign(sealed_.begin(), sealed_.end());
+                    sealed_.clear();
+                    if (stopping_ && work.empty() && inFlight_ == 0 && !(fill_ >= 0 && used_ > carried_)) break;
+                }
+                submit(work);
+                if (!work.empty() || inFlight_ > 0) complete(work.empty());
+            }
+        }
+
+        void submit(const std::vector<Sealed>& work)
+        {
+            for (const Sealed& s : work) {
+                Flight& f = flights_[s.index];
+                f.offset = offset_;
+                f.length = s.used;
+                f.done = 0;
+                f.fresh = s.used - s.carried;
+                if (direct_) {
+                    // An earlier padded block overlaps this write: let it land first.
+                    if (barrier_) {
+                        while (inFlight_ > 0) complete(true);
+                    }
+                    f.length = (s.used + BLOCK - 1) / BLOCK * BLOCK;
+                    std::memset(buffer(s.index) + s.used, 0, f.length - s.used);
+                    offset_ += s.used / BLOCK * BLOCK;
+                    barrier_ = s.used % BLOCK != 0;
+                }
+                else {
+                    offset_ += s.used;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    ++inFlight_;
+                    logical_ += f.fresh;
+                }
+                issue(s.index);
+            }
+#if defined(CNT_URING_AVAILABLE)
+            if (uring_ && !work.empty() && !ring_.enter(0)) leaveRing(false);
+#endif
+        }
+
+        // Starts (or continues, after a short write) the write of one buffer.
+        void issue(int index)
+        {
+            Flight& f = flights_[index];
+#if defined(CNT_URING_AVAILABLE)
+            while (uring_) {
+                if (ring_.prepareWrite(fd_, buffer(index) + f.done, static_cast<unsigned>(f.length - f.done),
+                                       f.offset + f.done, index, static_cast<uint64_t>(index))) {
+                    ++inRing_;
+                    countSubmission();
+                    return;
+                }
+                if (!ring_.enter(1)) leaveRing(false);
+                else reapRing();
+            }
+#endif
+            writeBlocking(index);
+        }
+
+        void writeBlocking(int index)
+        {
+            Flight& f = flights_[index];
+            while (f.done < f.length) {
+                struct iovec iov = {buffer(index) + f.done, f.length - f.done};
+                ssize_t n = ::pwritev(fd_, &iov, 1, static_cast<off_t>(f.offset + f.done));
+                countSubmission();
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {
+                    finish(index, false);
+                    return;
+                }
+                f.done += static_cast<size_t>(n);
+            }
+            finish(index, true);
+        }
+
+        // Collects completions; wait blocks until at least one arrives.
+        void complete(bool wait)
+        {
+#if defined(CNT_URING_AVAILABLE)
+            if (uring_) {
+                if (inFlight_ == 0) return;
+                if (!ring_.enter(wait ? 1 : 0)) leaveRing(false);
+                else reapRing();
+            }
+#endif
+            (void)wait;
+        }
+
+#if defined(CNT_URING_AVAILABLE)
+        void reapRing()
+        {
+            std::vector<int> retry;
+            bool unsupported = false;
+            ring_.reap([&](uint64_t userData, int res) {
+                const int index = static_cast<int>(userData);
+                Flight& f = flights_[index];
+                --inRing_;
+                if (res == -EINTR || res == -EAGAIN) {
+                    retry.push_back(index);
+                }
+                else if (res == -EINVAL || res == -EOPNOTSUPP) {
+                    // IORING_OP_WRITE needs Linux 5.6; older kernels only know
+                    // WRITE_FIXED, which buffer registration may have refused.
+                    unsupported = true;
+                    retry.push_back(index);
+                }
+                else if (res <= 0) {
+                    finish(index, false);
+                }
+                else {
+                    f.done += static_cast<size_t>(res);
+                    if (f.done < f.length) retry.push_back(index);
+                    else finish(index, true);
+                }
+            });
+            if (leaving_ || unsupported) {
+                parked_.insert(parked_.end(), retry.begin(), retry.end());
+                if (!leaving_) leaveRing(true);
+                return;
+            }
+            for (int index : retry) issue(index);
+            if (uring_ && !retry.empty() && !ring_.enter(0)) leaveRing(false);
+        }
+
+        // Switches to pwritev for good: takes back what the kernel has not
+        // seen, waits for what it has (polling the completion queue when
+        // io_uring_enter() itself fails) and rewrites the unfinished buffers.
+        void leaveRing(bool canEnter)
+        {
+            leaving_ = true;
+            ring_.unprepare([&](uint64_t userData) {
+                parked_.push_back(static_cast<int>(userData));
+                --inRing_;
+            });
+            while (inRing_ > 0) {
+                if (canEnter && !ring_.enter(1)) canEnter = false;
+                if (!canEnter) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                reapRing();
+            }
+            uring_ = false;
+            leaving_ = false;
+            std::vector<int> parked;
+            parked.swap(parked_);
+            for (int index : parked) writeBlocking(index);
+        }
+#endif
+
+        void countSubmission()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.submissions;
+        }
+
+        void finish(int index, bool ok)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                const Flight& f = flights_[index];
+                if (ok) stats_.writtenBytes += f.fresh;
+                else {
+                    ++stats_.errors;
+                    lostBytes_ += f.fresh;
+                }
+                free_.push_back(index);
+                --inFlight_;
+            }
+            space_.notify_all();
+            drained_.notify_all();
+        }
+
+        Options options_;
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;      // writer thread: work queued
+        std::condition_variable space_;     // logging threads: a buffer was freed
+        std::condition_variable drained_;   // flush(): a write completed
+        std::vector<int> free_;
+        std::deque<Sealed> sealed_;
+        int fill_ = -1;
+        size_t used_ = 0;
+        size_t carried_ = 0;
+        std::chrono::steady_clock::time_point fillSince_{};
+        bool flushRequested_ = false;
+        bool stopping_ = false;
+        size_t inFlight_ = 0;
+        uint64_t lostBytes_ = 0;
+        uint64_t logical_ = 0;      // bytes appended since open
+        Stats stats_;
+
+        // Writer thread only.
+        std::vector<Flight> flights_;
+        uint64_t start_ = 0;        // file size at open
+        uint64_t offset_ = 0;       // where the next buffer starts
+        bool barrier_ = false;
+        size_t inRing_ = 0;         // writes prepared on the ring and not reaped yet
+        bool leaving_ = false;      // inside leaveRing()
+        std::vector<int> parked_;   // unfinished writes waiting for pwritev
+
+        int fd_ = -1;
+        bool direct_ = false;
+        bool uring_ = false;
+        char* memory_ = nullptr;
+#if defined(CNT_URING_AVAILABLE)
+        Ring ring_;
+#endif
+        std::thread writer_;
+    };
+
+} // namespace cnt
+
+#endif // !_WIN32
+
+#ifdef _CNT_URINGSINK_SAVED_ERROR_DEFINE_
+#define ERROR _CNT_URINGSINK_SAVED_ERROR_DEFINE_
+#undef _CNT_URINGSINK_SAVED_ERROR_DEFINE_
+#endif
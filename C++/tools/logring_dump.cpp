@@ -0,0 +1,128 @@
+/**
+ * @file tools/logring_dump.cpp
+ * Copyright 2025, aplcexenicesetrl project
+ * MIT License
+ *
+ * Print the records held in a cnt::MappedLogRing file, oldest first.
+ *
+ *   logring_dump <ring-file> [--level DEBUG|INFO|WARNING|ERROR|CRITICAL] [--tail N]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <string>
+
+#include "../cnt/logring.h"
+
+namespace
+{
+    const char* levelName(cnt::LogLevel level)
+    {
+        static const char* names[] = {"DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL"};
+        int index = static_cast<int>(level);
+        return index >= 0 && index < 5 ? names[index] : "?";
+    }
+
+    bool parseLevel(const char* text, cnt::LogLevel& level)
+    {
+        for (int i = 0; i < 5; ++i)
+        {
+            if (std::strcmp(text, levelName(static_cast<cnt::LogLevel>(i))) == 0)
+            {
+                level = static_cast<cnt::LogLevel>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string render(const cnt::LogRingReader::Entry& entry)
+    {
+        if (entry.type == cnt::logring::TEXT)
+        {
+            std::string line(entry.payload);
+            if (line.empty() || line.back() != '\n') line += '\n';
+            return line;
+        }
+
+        // Binary records carry no formatting of their own.
+        std::time_t seconds = static_cast<std::time_t>(entry.timestamp / 1000000000);
+        std::tm tm;
+#if defined(_MSC_VER) || defined(__MINGW32__)
+        localtime_s(&tm, &seconds);
+#else
+        localtime_r(&seconds, &tm);
+#endif
+        char stamp[64];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+        char prefix[128];
+        std::snprintf(prefix, sizeof(prefix), "[%s.%09lld] %s binary(%u):", stamp,
+                      static_cast<long long>(entry.timestamp % 1000000000), levelName(entry.level),
+                      static_cast<unsigned>(entry.type));
+        std::string line = prefix;
+        char hex[4];
+        for (unsigned char c : entry.payload)
+        {
+            std::snprintf(hex, sizeof(hex), " %02x", c);
+            line += hex;
+        }
+        line += '\n';
+        return line;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s <ring-file> [--level LEVEL] [--tail N]\n", argv[0]);
+        return 2;
+    }
+
+    cnt::LogLevel minLevel = cnt::LogLevel::DEBUG;
+    size_t tail = 0;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+        {
+            if (!parseLevel(argv[++i], minLevel))
+            {
+                std::fprintf(stderr, "unknown level: %s\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--tail") == 0 && i + 1 < argc)
+        {
+            tail = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    try
+    {
+        cnt::LogRingReader reader(argv[1]);
+        std::deque<std::string> lines;
+        reader.forEach([&](const cnt::LogRingReader::Entry& entry) {
+            if (entry.level < minLevel) return;
+            lines.push_back(render(entry));
+            if (tail && lines.size() > tail) lines.pop_front();
+        });
+        for (const auto& line : lines) std::fputs(line.c_str(), stdout);
+        std::fprintf(stderr, "%zu records, ring %llu bytes, %llu bytes written, last writer pid %u\n",
+                     lines.size(), static_cast<unsigned long long>(reader.capacity()),
+                     static_cast<unsigned long long>(reader.head()), reader.writerPid());
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}